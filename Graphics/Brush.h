@@ -3,6 +3,12 @@
 
 #include "../Math/Vector.h"
 #include "../Math/Volume.h"
+#include "../Math/SparseVolume.h"
+#include "../Math/Kernel.h"
+
+#include <vector>
+#include <memory>
+#include <cmath>
 
 namespace Crystal {
 	namespace Graphics {
@@ -33,7 +39,7 @@ public:
 	}
 
 	void scale(const Math::Vector3d <GeomType> &s) {
-		this->size.scale(x);
+		this->size.scale(s.getX(), s.getY(), s.getZ());
 	}
 
 	void addSize(const Math::Vector3d<GeomType>& s) {
@@ -46,21 +52,137 @@ public:
 
 	//Space3d<T> getSpace() const { return Space3d<T>( ) }
 
-	virtual void add(Math::Volume3d<GeomType, ValueType>& grid) const = 0;
+	// only the voxels inside the brush bounds are visited.
+	virtual void add(Math::Volume3d<GeomType, ValueType>& grid) const {
+		Math::Index3d start;
+		Math::Index3d end;
+		if (!getIndexRange(grid, start, end)) {
+			return;
+		}
+		const auto& xs = getCenterXs(grid, start[0], end[0]);
+		grid.forEachRow(start, end, [&](const unsigned int y, const unsigned int z, ValueType* values) {
+			const auto& p = grid.toCenterPosition(start[0], y, z);
+			addRow(xs.data(), p.getY(), p.getZ(), values, xs.size());
+		});
+	}
 
+	// the voxels of the brush bounds are written back, so the blocks they cover become active as with add().
+	virtual void add(Math::SparseVolume3d<GeomType, ValueType>& grid) const {
+		Math::Index3d start;
+		Math::Index3d end;
+		if (!getIndexRange(grid, start, end)) {
+			return;
+		}
+		const auto& xs = getCenterXs(grid, start[0], end[0]);
+		std::vector< ValueType > values(xs.size());
+		for (unsigned int z = start[2]; z < end[2]; ++z) {
+			for (unsigned int y = start[1]; y < end[1]; ++y) {
+				for (size_t i = 0; i < values.size(); ++i) {
+					values[i] = grid.getValue(start[0] + i, y, z);
+				}
+				const auto& p = grid.toCenterPosition(start[0], y, z);
+				addRow(xs.data(), p.getY(), p.getZ(), values.data(), values.size());
+				for (size_t i = 0; i < values.size(); ++i) {
+					grid.setValue(start[0] + i, y, z, values[i]);
+				}
+			}
+		}
+	}
+
+	// Applies the brush to count voxels of one row. xs are the voxel center x coordinates, y and z the row's.
+	virtual void addRow(const GeomType* xs, const GeomType y, const GeomType z, ValueType* values, const size_t count) const = 0;
 
 	Math::Space3d<GeomType> getSpace() const {
 		const auto& start = getMinPosition();
 		return Math::Space3d<GeomType>(start, size);
 	}
 
+	// voxel index range [start, end) covered by the brush bounds. false if the brush misses the grid.
+	bool getIndexRange(const Math::GridSpaceBase<GeomType>& grid, Math::Index3d& start, Math::Index3d& end) const {
+		return toIndexRange(grid, getMinPosition(), getMaxPosition(), start, end);
+	}
+
+	static bool toIndexRange(const Math::GridSpaceBase<GeomType>& grid, const Math::Vector3d<GeomType>& min, const Math::Vector3d<GeomType>& max, Math::Index3d& start, Math::Index3d& end) {
+		const auto& gridStart = grid.getStart();
+		const auto& gridEnd = grid.getEnd();
+		if (max.getX() < gridStart.getX() || max.getY() < gridStart.getY() || max.getZ() < gridStart.getZ() ||
+			min.getX() > gridEnd.getX() || min.getY() > gridEnd.getY() || min.getZ() > gridEnd.getZ()) {
+			return false;
+		}
+		const Math::Vector3d<GeomType> clampedMin(
+			std::max<GeomType>(min.getX(), gridStart.getX()),
+			std::max<GeomType>(min.getY(), gridStart.getY()),
+			std::max<GeomType>(min.getZ(), gridStart.getZ()));
+		const Math::Vector3d<GeomType> clampedMax(
+			std::min<GeomType>(max.getX(), gridEnd.getX()),
+			std::min<GeomType>(max.getY(), gridEnd.getY()),
+			std::min<GeomType>(max.getZ(), gridEnd.getZ()));
+		const auto& res = grid.getResolutions();
+		start = grid.toIndex(clampedMin);
+		end = grid.toIndex(clampedMax);
+		for (int i = 0; i < 3; ++i) {
+			end[i] = std::min<unsigned int>(end[i] + 1, res[i]);
+		}
+		return start[0] < end[0] && start[1] < end[1] && start[2] < end[2];
+	}
+
+protected:
+	static std::vector< GeomType > getCenterXs(const Math::GridSpaceBase<GeomType>& grid, const unsigned int startx, const unsigned int endx) {
+		std::vector< GeomType > xs(endx - startx);
+		for (size_t i = 0; i < xs.size(); ++i) {
+			xs[i] = grid.toCenterPosition(startx + i, 0, 0).getX();
+		}
+		return xs;
+	}
 
 private:
 	Math::Vector3d<GeomType> center;
 	Math::Vector3d<GeomType> size;
 };
 
-template<typename GeomType, typename ValueType>
+// Falloff profiles take the normalized distance t = distance / radius in [0, 1] and return the weight.
+template<typename T>
+struct LinearFalloff
+{
+	T operator()(const T t) const { return T(1) - t; }
+};
+
+// the original BlendBrush weight, 1 - distance / diameter; it still holds half its weight at the radius.
+template<typename T>
+struct BlendFalloff
+{
+	T operator()(const T t) const { return T(1) - t * T(0.5); }
+};
+
+template<typename T>
+struct SmoothStepFalloff
+{
+	T operator()(const T t) const {
+		const T s = T(1) - t;
+		return s * s * (T(3) - T(2) * s);
+	}
+};
+
+// shifted and scaled so the weight is 1 at the center and reaches 0 at the radius, with no step at the dab edge.
+template<typename T>
+class GaussianFalloff
+{
+public:
+	explicit GaussianFalloff(const T distribution = T(0.1)) :
+		gaussian(0, distribution),
+		edge(gaussian.get(1)),
+		peak(gaussian.get(0))
+	{}
+
+	T operator()(const T t) const { return (gaussian.get(t) - edge) / (peak - edge); }
+
+private:
+	Math::Gaussian<T> gaussian;
+	T edge;
+	T peak;
+};
+
+template<typename GeomType, typename ValueType, typename Falloff = BlendFalloff<GeomType> >
 class BlendBrush final : public Brush<GeomType, ValueType>
 {
 public:
@@ -74,9 +196,10 @@ public:
 		density(1)
 	{}
 
-	BlendBrush(const Math::Vector3d<GeomType>& pos, const Math::Vector3d<GeomType>& size) :
+	BlendBrush(const Math::Vector3d<GeomType>& pos, const Math::Vector3d<GeomType>& size, const Falloff& falloff = Falloff()) :
 		Brush(pos,size),
-		density(1)
+		density(1),
+		falloff(falloff)
 	{}
 
 	~BlendBrush() = default;
@@ -85,34 +208,37 @@ public:
 
 	ValueType getDensity() const { return density; }
 
-	virtual void add(Math::Volume3d<GeomType,ValueType>& grid) const override {
+	const Falloff& getFalloff() const { return falloff; }
+
+	virtual void addRow(const GeomType* xs, const GeomType y, const GeomType z, ValueType* values, const size_t count) const override {
 		const GeomType radius = getSize().getX() * GeomType(0.5);
-		for (size_t x = 0; x < grid.getResolutions()[0]; ++x) {
-			for (size_t y = 0; y < grid.getResolutions()[1]; ++y) {
-				for (size_t z = 0; z < grid.getResolutions()[2]; ++z) {
-					const auto& pos = grid.toCenterPosition(x, y, z);
-					if ( getCenter().getDistanceSquared(pos) < radius * radius) {
-						const auto v = getValue(pos);
-						grid.add(x, y, z, v);
-					}
-					/*
-					metaball.getSpace();
-					const auto& pos = toCenterPosition(x, y, z);
-					*/
-				}
+		const GeomType dy = y - getCenter().getY();
+		const GeomType dz = z - getCenter().getZ();
+		const GeomType dyz2 = dy * dy + dz * dz;
+		const GeomType cx = getCenter().getX();
+		for (size_t i = 0; i < count; ++i) {
+			const GeomType dx = xs[i] - cx;
+			const GeomType dist2 = dx * dx + dyz2;
+			if (dist2 < radius * radius) {
+				values[i] += getValueByDistance(std::sqrt(dist2));
 			}
 		}
 	}
 
 	ValueType getValue(const Math::Vector3d<GeomType>& pos) const
 	{
-		const auto dist = pos.getDistance(getCenter());
-		const auto v = 1 - dist / getSize().getX();//radius;
-		return v * density;
+		return getValueByDistance(pos.getDistance(getCenter()));
+	}
+
+	ValueType getValueByDistance(const GeomType dist) const
+	{
+		const GeomType radius = getSize().getX() * GeomType(0.5);
+		return static_cast<ValueType>(falloff(dist / radius) * density);
 	}
 
 private:
 	ValueType density;
+	Falloff falloff;
 };
 
 template<typename GeomType, typename ValueType>
@@ -130,29 +256,28 @@ public:
 	{}
 
 	FillBrush(const Math::Vector3d<GeomType>& pos, const GeomType fillValue) :
-		Brush(pos, Math::Vector3d<GeomType>(1, 1, 1), fillValue)
+		Brush(pos, Math::Vector3d<GeomType>(1, 1, 1)),
+		fillValue(fillValue)
 	{}
 
 	FillBrush(const Math::Vector3d<GeomType>& pos, const Math::Vector3d<GeomType>& size, const GeomType fillValue) :
-		Brush(pos, size, fillValue)
+		Brush(pos, size),
+		fillValue(fillValue)
 	{}
 
 	GeomType getFillValue() const { return fillValue; }
 
-	virtual void add(Math::Volume3d<GeomType,ValueType>& grid) const override {
-		const GeomType radius = getSize().getX() * 0.5;
-		for (size_t x = 0; x < grid.getResolutions()[0]; ++x) {
-			for (size_t y = 0; y < grid.getResolutions()[1]; ++y) {
-				for (size_t z = 0; z < grid.getResolutions()[2]; ++z) {
-					const auto& pos = grid.toCenterPosition(x, y, z);
-					if (getCenter().getDistanceSquared(pos) < radius * radius) {
-						grid.setValue(x, y, z, fillValue);
-					}
-					/*
-					metaball.getSpace();
-					const auto& pos = toCenterPosition(x, y, z);
-					*/
-				}
+	virtual void addRow(const GeomType* xs, const GeomType y, const GeomType z, ValueType* values, const size_t count) const override {
+		const GeomType radius = getSize().getX() * GeomType(0.5);
+		const GeomType dy = y - getCenter().getY();
+		const GeomType dz = z - getCenter().getZ();
+		const GeomType dyz2 = dy * dy + dz * dz;
+		const GeomType cx = getCenter().getX();
+		const ValueType v = static_cast<ValueType>(fillValue);
+		for (size_t i = 0; i < count; ++i) {
+			const GeomType dx = xs[i] - cx;
+			if (dx * dx + dyz2 < radius * radius) {
+				values[i] = v;
 			}
 		}
 	}
@@ -167,7 +292,37 @@ using BrushSPtr = std::shared_ptr < Brush<GeomType, ValueType> > ;
 template<typename GeomType, typename ValueType>
 using BrushSPtrVector = std::vector < BrushSPtr<GeomType, ValueType> > ;
 
+// Applies brushes in order in a single pass over their own index ranges. Each voxel sees the brushes in the same
+// order as separate add() calls would apply them, and far-apart brushes do not touch the voxels between them.
+template<typename GeomType, typename ValueType>
+void addBrushes(const BrushSPtrVector<GeomType, ValueType>& brushes, Math::Volume3d<GeomType, ValueType>& grid)
+{
+	std::vector< const Brush<GeomType, ValueType>* > targets;
+	std::vector< Math::Index3d > starts;
+	std::vector< Math::Index3d > ends;
+	for (const auto& b : brushes) {
+		Math::Index3d s;
+		Math::Index3d e;
+		if (!b->getIndexRange(grid, s, e)) {
+			continue;
+		}
+		targets.push_back(b.get());
+		starts.push_back(s);
+		ends.push_back(e);
+	}
+
+	std::vector< GeomType > xs(grid.getResolutions()[0]);
+	for (size_t i = 0; i < xs.size(); ++i) {
+		xs[i] = grid.toCenterPosition(i, 0, 0).getX();
+	}
+	grid.forEachBoxRow(starts, ends, [&](const size_t i, const unsigned int y, const unsigned int z, ValueType* values) {
+		const auto& s = starts[i];
+		const auto& p = grid.toCenterPosition(s[0], y, z);
+		targets[i]->addRow(xs.data() + s[0], p.getY(), p.getZ(), values, ends[i][0] - s[0]);
+	});
+}
+
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
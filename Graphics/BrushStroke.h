@@ -0,0 +1,99 @@
+#ifndef __CRYSTAL_GRAPHICS_BRUSH_STROKE_H__
+#define __CRYSTAL_GRAPHICS_BRUSH_STROKE_H__
+
+#include "Brush.h"
+
+#include <vector>
+#include <cmath>
+
+namespace Crystal {
+	namespace Graphics {
+
+// Collects spherical dabs along a stroke and applies them together in one pass over the rows of their own bounds,
+// instead of one volume pass per dab. Each voxel receives the dabs in stroke order, and only the dab bounds are
+// marked dirty, so a long stroke re-meshes only the blocks it actually crosses.
+template<typename GeomType, typename ValueType, typename Falloff = LinearFalloff<GeomType> >
+class BrushStroke
+{
+public:
+	struct Dab
+	{
+		Math::Vector3d<GeomType> center;
+		GeomType radius;
+		GeomType strength;
+	};
+
+	explicit BrushStroke(const Falloff& falloff = Falloff()) :
+		falloff(falloff)
+	{}
+
+	~BrushStroke() = default;
+
+	void add(const Math::Vector3d<GeomType>& center, const GeomType radius, const GeomType strength) {
+		const Dab d = { center, radius, strength };
+		dabs.push_back(d);
+	}
+
+	void clear() { dabs.clear(); }
+
+	size_t getDabCount() const { return dabs.size(); }
+
+	const std::vector< Dab >& getDabs() const { return dabs; }
+
+	const Falloff& getFalloff() const { return falloff; }
+
+	// weight of a dab at the given distance from its center.
+	GeomType getValue(const Dab& d, const GeomType distance) const {
+		return (distance < d.radius) ? d.strength * falloff(distance / d.radius) : GeomType(0);
+	}
+
+	void apply(Math::Volume3d<GeomType, ValueType>& grid) const {
+		std::vector< const Dab* > targets;
+		std::vector< Math::Index3d > starts;
+		std::vector< Math::Index3d > ends;
+		for (const auto& d : dabs) {
+			const Math::Vector3d<GeomType> r(d.radius, d.radius, d.radius);
+			Math::Index3d s;
+			Math::Index3d e;
+			if (!Brush<GeomType, ValueType>::toIndexRange(grid, d.center - r, d.center + r, s, e)) {
+				continue;
+			}
+			targets.push_back(&d);
+			starts.push_back(s);
+			ends.push_back(e);
+		}
+
+		std::vector< GeomType > xs(grid.getResolutions()[0]);
+		for (size_t i = 0; i < xs.size(); ++i) {
+			xs[i] = grid.toCenterPosition(i, 0, 0).getX();
+		}
+		grid.forEachBoxRow(starts, ends, [&](const size_t i, const unsigned int y, const unsigned int z, ValueType* values) {
+			const auto& d = *targets[i];
+			const auto& p = grid.toCenterPosition(0, y, z);
+			const GeomType dy = p.getY() - d.center.getY();
+			const GeomType dz = p.getZ() - d.center.getZ();
+			const GeomType dyz2 = dy * dy + dz * dz;
+			const GeomType r2 = d.radius * d.radius;
+			if (dyz2 >= r2) {
+				return;
+			}
+			const unsigned int startx = starts[i][0];
+			for (unsigned int x = startx; x < ends[i][0]; ++x) {
+				const GeomType dx = xs[x] - d.center.getX();
+				const GeomType dist2 = dx * dx + dyz2;
+				if (dist2 < r2) {
+					values[x - startx] += static_cast<ValueType>(d.strength * falloff(std::sqrt(dist2) / d.radius));
+				}
+			}
+		});
+	}
+
+private:
+	std::vector< Dab > dabs;
+	Falloff falloff;
+};
+
+	}
+}
+
+#endif
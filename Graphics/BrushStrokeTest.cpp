@@ -0,0 +1,100 @@
+#include "gtest/gtest.h"
+
+#include "../Graphics/BrushStroke.h"
+
+using namespace Crystal::Math;
+using namespace Crystal::Graphics;
+
+TEST(BrushFalloffTest, TestLinear)
+{
+	LinearFalloff<float> f;
+	EXPECT_FLOAT_EQ(1.0f, f(0.0f));
+	EXPECT_FLOAT_EQ(0.5f, f(0.5f));
+}
+
+TEST(BrushFalloffTest, TestSmoothStep)
+{
+	SmoothStepFalloff<float> f;
+	EXPECT_FLOAT_EQ(1.0f, f(0.0f));
+	EXPECT_FLOAT_EQ(0.5f, f(0.5f));
+	EXPECT_FLOAT_EQ(0.0f, f(1.0f));
+}
+
+TEST(BrushFalloffTest, TestGaussian)
+{
+	GaussianFalloff<float> f;
+	EXPECT_FLOAT_EQ(1.0f, f(0.0f));
+	EXPECT_GT(f(0.2f), f(0.5f));
+	EXPECT_FLOAT_EQ(0.0f, f(1.0f));
+	EXPECT_GT(f(0.99f), 0.0f);
+}
+
+TEST(BrushFalloffTest, TestBlendBrush)
+{
+	// the default keeps the original weight, the profile can be swapped.
+	BlendBrush<float, float> blend(Vector3d<float>(0, 0, 0), Vector3d<float>(4, 4, 4));
+	EXPECT_FLOAT_EQ(0.75f, blend.getValueByDistance(1.0f));
+	BlendBrush<float, float, SmoothStepFalloff<float> > smooth(Vector3d<float>(0, 0, 0), Vector3d<float>(4, 4, 4));
+	EXPECT_FLOAT_EQ(0.5f, smooth.getValueByDistance(1.0f));
+	EXPECT_FLOAT_EQ(0.0f, smooth.getValueByDistance(2.0f));
+}
+
+template<class T>
+class BrushStrokeTest : public testing::Test {
+};
+
+using TestTypes = ::testing::Types <
+	std::tuple< float, float >,
+	std::tuple< float, unsigned char >
+>;
+
+TYPED_TEST_CASE(BrushStrokeTest, TestTypes);
+
+TYPED_TEST(BrushStrokeTest, TestApply)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	BrushStroke<GeomType, ValueType, SmoothStepFalloff<GeomType> > stroke;
+	stroke.add(Vector3d<GeomType>(5, 5, 5), 3, 2);
+	stroke.add(Vector3d<GeomType>(7, 5, 5), 3, 2);
+	stroke.add(Vector3d<GeomType>(15, 15, 15), 2, 4);
+	EXPECT_EQ(3, stroke.getDabCount());
+
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(20, 20, 20)), Grid3d<ValueType>(20, 20, 20));
+	stroke.apply(volume);
+
+	for (unsigned int x = 0; x < 20; ++x) {
+		for (unsigned int y = 0; y < 20; ++y) {
+			for (unsigned int z = 0; z < 20; ++z) {
+				ValueType expected = 0;
+				for (const auto& d : stroke.getDabs()) {
+					const auto dist = volume.toCenterPosition(x, y, z).getDistance(d.center);
+					if (dist < d.radius) {
+						expected += static_cast<ValueType>(stroke.getValue(d, dist));
+					}
+				}
+				EXPECT_EQ(expected, volume.getValue(x, y, z));
+			}
+		}
+	}
+}
+
+TEST(BrushStrokeTest, TestApplyDiagonalDirty)
+{
+	BrushStroke<float, float> stroke;
+	for (int i = 0; i <= 60; ++i) {
+		stroke.add(Vector3d<float>(2.0f + i, 2.0f + i, 2.0f + i), 1.5f, 1.0f);
+	}
+	Volume3d<float, float> volume(Space3d<float>(Vector3d<float>(0, 0, 0), Vector3d<float>(64, 64, 64)), Grid3d<float>(64, 64, 64));
+	volume.clearDirty();
+	stroke.apply(volume);
+	EXPECT_GT(volume.getValue(32, 32, 32), 0.0f);
+	EXPECT_EQ(0.0f, volume.getValue(40, 20, 32));
+
+	// the blocks along the diagonal, not the whole bounding box of the stroke.
+	const auto& dirty = volume.getDirtyBlocks();
+	EXPECT_TRUE(dirty.get(4, 4, 4));
+	EXPECT_FALSE(dirty.get(7, 0, 0));
+	EXPECT_LT(dirty.getCount(), 8 * 8 * 8 / 4);
+}
@@ -33,4 +33,98 @@ TYPED_TEST(BrushTest, TestMove)
 	BlendBrush<GeomType, ValueType> brush( Vector3d<GeomType>(1,2,3));
 	brush.move(Vector3d<GeomType>(3, 2, 1));
 	EXPECT_EQ(Vector3d<GeomType>(4, 4, 4), brush.getCenter());
-}
\ No newline at end of file
+}
+
+TYPED_TEST(BrushTest, TestScale)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	BlendBrush<GeomType, ValueType> brush(Vector3d<GeomType>(1, 2, 3), Vector3d<GeomType>(2, 2, 2));
+	brush.scale(Vector3d<GeomType>(1, 2, 3));
+	EXPECT_EQ(Vector3d<GeomType>(2, 4, 6), brush.getSize());
+}
+
+TYPED_TEST(BrushTest, TestAddSparse)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	SparseVolume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(64, 64, 64)), { 64, 64, 64 }, 0);
+	BlendBrush<GeomType, ValueType> brush(Vector3d<GeomType>(4, 4, 4), Vector3d<GeomType>(4, 4, 4));
+	brush.add(volume);
+	EXPECT_EQ(1, volume.getBlockCount());
+}
+
+TYPED_TEST(BrushTest, TestAddSparseFill)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	SparseVolume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(64, 64, 64)), { 64, 64, 64 }, 0);
+	FillBrush<GeomType, ValueType> brush(Vector3d<GeomType>(4, 4, 4), Vector3d<GeomType>(4, 4, 4), 1);
+	brush.add(volume);
+	EXPECT_EQ(1, volume.getValue(4, 4, 4));
+	EXPECT_EQ(1, volume.getBlockCount());
+}
+
+TYPED_TEST(BrushTest, TestAddBounded)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(20, 20, 20)), Grid3d<ValueType>(20, 20, 20));
+	FillBrush<GeomType, ValueType> brush(Vector3d<GeomType>(18, 5, 5), Vector3d<GeomType>(6, 6, 6), 1);
+	brush.add(volume);
+
+	for (unsigned int x = 0; x < 20; ++x) {
+		for (unsigned int y = 0; y < 20; ++y) {
+			for (unsigned int z = 0; z < 20; ++z) {
+				const bool isInside = volume.toCenterPosition(x, y, z).getDistanceSquared(brush.getCenter()) < 9;
+				EXPECT_EQ(isInside ? 1 : 0, volume.getValue(x, y, z));
+			}
+		}
+	}
+}
+
+TYPED_TEST(BrushTest, TestAddBrushes)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	const Space3d<GeomType> space(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(20, 20, 20));
+	Volume3d<GeomType, ValueType> expected(space, Grid3d<ValueType>(20, 20, 20));
+	Volume3d<GeomType, ValueType> actual(space, Grid3d<ValueType>(20, 20, 20));
+
+	BrushSPtrVector<GeomType, ValueType> brushes;
+	brushes.push_back(std::make_shared< FillBrush<GeomType, ValueType> >(Vector3d<GeomType>(5, 5, 5), Vector3d<GeomType>(6, 6, 6), 3));
+	brushes.push_back(std::make_shared< BlendBrush<GeomType, ValueType> >(Vector3d<GeomType>(8, 6, 5), Vector3d<GeomType>(8, 8, 8)));
+	brushes.push_back(std::make_shared< FillBrush<GeomType, ValueType> >(Vector3d<GeomType>(30, 5, 5), Vector3d<GeomType>(2, 2, 2), 5));
+	for (const auto& b : brushes) {
+		b->add(expected);
+	}
+	addBrushes(brushes, actual);
+	EXPECT_EQ(expected.getGrid(), actual.getGrid());
+}
+
+TYPED_TEST(BrushTest, TestAddBrushesFarApart)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	const Space3d<GeomType> space(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(64, 64, 64));
+	Volume3d<GeomType, ValueType> volume(space, Grid3d<ValueType>(64, 64, 64));
+	volume.clearDirty();
+	BrushSPtrVector<GeomType, ValueType> brushes;
+	brushes.push_back(std::make_shared< FillBrush<GeomType, ValueType> >(Vector3d<GeomType>(4, 4, 4), Vector3d<GeomType>(4, 4, 4), 1));
+	brushes.push_back(std::make_shared< FillBrush<GeomType, ValueType> >(Vector3d<GeomType>(60, 60, 60), Vector3d<GeomType>(4, 4, 4), 2));
+	addBrushes(brushes, volume);
+	EXPECT_EQ(1, volume.getValue(4, 4, 4));
+	EXPECT_EQ(2, volume.getValue(60, 60, 60));
+
+	// only the blocks of the two brushes are dirty, not the diagonal between them.
+	const auto& dirty = volume.getDirtyBlocks();
+	EXPECT_EQ(2, dirty.getCount());
+	EXPECT_TRUE(dirty.get(0, 0, 0));
+	EXPECT_TRUE(dirty.get(7, 7, 7));
+}
@@ -0,0 +1,174 @@
+#ifndef __CRYSTAL_GRAPHICS_MESH_WELDER_H__
+#define __CRYSTAL_GRAPHICS_MESH_WELDER_H__
+
+#include "../Math/IndexedMesh.h"
+#include "../Util/Parallel.h"
+
+#include <vector>
+#include <unordered_set>
+#include <functional>
+#include <algorithm>
+
+namespace Crystal {
+	namespace Graphics {
+
+// Collects triangle corners and merges the ones whose position, normal and texcoord are bitwise equal (-0 and 0
+// are the same). Corners are hashed in parallel and sharded by hash, each shard is welded on its own thread, and
+// vertices are numbered in order of first use, so the mesh is the same for any thread count.
+template<typename T>
+class MeshWelder final
+{
+public:
+	MeshWelder() = default;
+
+	~MeshWelder() = default;
+
+	void clear() {
+		positions.clear();
+		normals.clear();
+		texCoords.clear();
+	}
+
+	void reserve(const size_t cornerCount) {
+		positions.reserve(cornerCount);
+		normals.reserve(cornerCount);
+		texCoords.reserve(cornerCount);
+	}
+
+	// sizes for filling corners with set(), e.g. from several threads.
+	void resize(const size_t cornerCount) {
+		positions.resize(cornerCount);
+		normals.resize(cornerCount);
+		texCoords.resize(cornerCount);
+	}
+
+	void add(const Math::Vector3d<T>& position, const Math::Vector3d<T>& normal, const Math::Vector3d<T>& texCoord) {
+		positions.push_back(position);
+		normals.push_back(normal);
+		texCoords.push_back(texCoord);
+	}
+
+	void set(const size_t corner, const Math::Vector3d<T>& position, const Math::Vector3d<T>& normal, const Math::Vector3d<T>& texCoord) {
+		positions[corner] = position;
+		normals[corner] = normal;
+		texCoords[corner] = texCoord;
+	}
+
+	// three corners per triangle.
+	size_t getCornerCount() const { return positions.size(); }
+
+	Math::IndexedMesh<T> weld(const unsigned int threadCount = 0) const {
+		const size_t count = positions.size();
+		std::vector<size_t> hashes(count);
+		Util::parallelForBlocks(count, 4096, [&](const size_t first, const size_t last) {
+			for (size_t i = first; i < last; ++i) {
+				hashes[i] = toHash(i);
+			}
+		}, threadCount);
+
+		// counting sort of corners by shard keeps each shard in corner order.
+		const size_t shardCount = std::max<size_t>(1, ((threadCount == 0) ? Util::getThreadCount() : threadCount) * 4);
+		std::vector<size_t> shardStarts(shardCount + 1, 0);
+		for (const auto h : hashes) {
+			++shardStarts[toShard(h, shardCount) + 1];
+		}
+		for (size_t s = 0; s < shardCount; ++s) {
+			shardStarts[s + 1] += shardStarts[s];
+		}
+		std::vector<unsigned int> order(count);
+		{
+			std::vector<size_t> cursors(shardStarts.begin(), shardStarts.end() - 1);
+			for (size_t i = 0; i < count; ++i) {
+				order[cursors[toShard(hashes[i], shardCount)]++] = static_cast<unsigned int>(i);
+			}
+		}
+
+		// the representative of a corner is the first corner equal to it.
+		std::vector<unsigned int> representatives(count);
+		const CornerHash hasher = { &hashes };
+		const CornerEqual equals = { this };
+		Util::parallelFor(shardCount, [&](const size_t s) {
+			std::unordered_set<unsigned int, CornerHash, CornerEqual> firsts(shardStarts[s + 1] - shardStarts[s], hasher, equals);
+			for (size_t k = shardStarts[s]; k < shardStarts[s + 1]; ++k) {
+				const unsigned int i = order[k];
+				representatives[i] = *firsts.insert(i).first;
+			}
+		}, threadCount);
+
+		Math::Vector3dVector<T> ps;
+		Math::Vector3dVector<T> ns;
+		Math::Vector3dVector<T> ts;
+		std::vector<unsigned int> indices(count);
+		for (size_t i = 0; i < count; ++i) {
+			const unsigned int r = representatives[i];
+			if (r == i) {
+				indices[i] = static_cast<unsigned int>(ps.size());
+				ps.push_back(positions[i]);
+				ns.push_back(normals[i]);
+				ts.push_back(texCoords[i]);
+			}
+			else {
+				indices[i] = indices[r];
+			}
+		}
+		return Math::IndexedMesh<T>(ps, ns, ts, indices);
+	}
+
+private:
+	Math::Vector3dVector<T> positions;
+	Math::Vector3dVector<T> normals;
+	Math::Vector3dVector<T> texCoords;
+
+	struct CornerHash
+	{
+		const std::vector<size_t>* hashes;
+
+		size_t operator()(const unsigned int i) const { return (*hashes)[i]; }
+	};
+
+	struct CornerEqual
+	{
+		const MeshWelder* welder;
+
+		bool operator()(const unsigned int i, const unsigned int j) const { return welder->isSameCorner(i, j); }
+	};
+
+	// the upper bits, so shards and the buckets inside them do not split on the same bits.
+	static size_t toShard(const size_t hash, const size_t shardCount) { return (hash >> (sizeof(size_t) * 4)) % shardCount; }
+
+	static void combine(size_t& seed, const T v) {
+		// adding zero turns -0 into 0.
+		seed ^= std::hash<T>()(v + T(0)) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+	}
+
+	static void combine(size_t& seed, const Math::Vector3d<T>& v) {
+		combine(seed, v.getX());
+		combine(seed, v.getY());
+		combine(seed, v.getZ());
+	}
+
+	size_t toHash(const size_t i) const {
+		size_t seed = 0;
+		combine(seed, positions[i]);
+		combine(seed, normals[i]);
+		combine(seed, texCoords[i]);
+		return seed;
+	}
+
+	// exact comparison; Vector3d::operator== is tolerant and would not agree with the hash.
+	static bool isEqual(const Math::Vector3d<T>& lhs, const Math::Vector3d<T>& rhs) {
+		return lhs.getX() == rhs.getX() && lhs.getY() == rhs.getY() && lhs.getZ() == rhs.getZ();
+	}
+
+	bool isSameCorner(const size_t i, const size_t j) const {
+		return
+			isEqual(positions[i], positions[j]) &&
+			isEqual(normals[i], normals[j]) &&
+			isEqual(texCoords[i], texCoords[j]);
+	}
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,57 @@
+#include "gtest/gtest.h"
+
+#include "../Graphics/MeshWelder.h"
+
+using namespace Crystal::Math;
+using namespace Crystal::Graphics;
+
+namespace {
+	// a grid of quads, two triangles each, with every shared corner repeated.
+	MeshWelder<float> toQuadGrid(const unsigned int size)
+	{
+		MeshWelder<float> welder;
+		const Vector3d<float> normal(0, 0, 1);
+		for (unsigned int y = 0; y < size; ++y) {
+			for (unsigned int x = 0; x < size; ++x) {
+				const Vector3d<float> p00(float(x), float(y), 0);
+				const Vector3d<float> p10(float(x + 1), float(y), 0);
+				const Vector3d<float> p11(float(x + 1), float(y + 1), 0);
+				const Vector3d<float> p01(float(x), float(y + 1), 0);
+				welder.add(p00, normal, Vector3d<float>());
+				welder.add(p10, normal, Vector3d<float>());
+				welder.add(p11, normal, Vector3d<float>());
+				welder.add(p00, normal, Vector3d<float>());
+				welder.add(p11, normal, Vector3d<float>());
+				welder.add(p01, normal, Vector3d<float>());
+			}
+		}
+		return welder;
+	}
+}
+
+TEST(MeshWelderTest, TestWeld)
+{
+	MeshWelder<float> welder;
+	welder.add(Vector3d<float>(0, 0, 0), Vector3d<float>(0, 0, 1), Vector3d<float>());
+	welder.add(Vector3d<float>(1, 0, 0), Vector3d<float>(0, 0, 1), Vector3d<float>());
+	welder.add(Vector3d<float>(0, 1, 0), Vector3d<float>(0, 0, 1), Vector3d<float>());
+	welder.add(Vector3d<float>(-0.0f, 1, 0), Vector3d<float>(0, 0, 1), Vector3d<float>());
+	welder.add(Vector3d<float>(1, 0, 0), Vector3d<float>(0, 0, 1), Vector3d<float>());
+	welder.add(Vector3d<float>(1, 0, 0), Vector3d<float>(0, 0, -1), Vector3d<float>());
+	const auto& mesh = welder.weld();
+	EXPECT_EQ(4, mesh.getVertexCount());
+	EXPECT_EQ(2, mesh.getTriangleCount());
+	const std::vector<unsigned int> expected = { 0, 1, 2, 2, 1, 3 };
+	EXPECT_EQ(expected, mesh.getIndices());
+	EXPECT_EQ(Vector3d<float>(0, 0, -1), mesh.getNormals()[3]);
+}
+
+TEST(MeshWelderTest, TestWeldIsDeterministic)
+{
+	const auto& welder = toQuadGrid(40);
+	const auto& expected = welder.weld(1);
+	EXPECT_EQ(41 * 41, expected.getVertexCount());
+	EXPECT_EQ(40 * 40 * 2, expected.getTriangleCount());
+	EXPECT_EQ(expected, welder.weld(3));
+	EXPECT_EQ(expected, welder.weld(8));
+}
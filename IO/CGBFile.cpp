@@ -1,6 +1,12 @@
 #include "CGBFile.h"
 
 #include "VolumeFile.h"
+#include "PNGFile.h"
+#include "../Util/Parallel.h"
+
+#include <atomic>
+#include <algorithm>
+#include <new>
 
 using namespace Crystal::Math;
 using namespace Crystal::IO;
@@ -55,7 +61,7 @@ bool CGBFile<GeomType, ValueType>::save(const std::string& directoryname, const
 	{
 		XMLElement* e = xml.NewElement("volume");
 
-		e->SetAttribute("type", "unsigned char");
+		e->SetAttribute("type", (bitDepth == 16) ? "unsigned short" : "unsigned char");
 		e->SetAttribute("format", "png");
 
 		VolumeFile vFile(directoryname);
@@ -71,48 +77,148 @@ bool CGBFile<GeomType, ValueType>::save(const std::string& directoryname, const
 		root->InsertEndChild(e);
 	}
 
-	//for (size_t i = 0; i < )
-	
-	xml.SaveFile(filename.c_str());
-	return true;
-}
+	const auto& res = volume.getResolutions();
+	const auto& grid = volume.getGrid();
+	std::atomic<bool> isOk(true);
+	Crystal::Util::parallelFor(imageFileNames.size(), [&](const size_t z) {
+		PNGFile image(res[0], res[1], bitDepth);
+		const double max = image.getMaxValue();
+		for (unsigned int y = 0; y < res[1]; ++y) {
+			for (unsigned int x = 0; x < res[0]; ++x) {
+				const double v = std::max(0.0, std::min(1.0, static_cast<double>(grid.get(x, y, z))));
+				image.set(x, y, static_cast<unsigned short>(v * max + 0.5));
+			}
+		}
+		if (!image.write(imageFileNames[z])) {
+			isOk = false;
+		}
+	}, getSliceThreadCount(res[0], res[1]));
 
+	return (xml.SaveFile(filename.c_str()) == XML_SUCCESS) && isOk;
+}
 
-Volume3d<float, float>::Attribute CGBFile<float, float>::load(const std::string& filename)
+template<typename GeomType, typename ValueType>
+bool CGBFile<GeomType, ValueType>::load(const std::string& filename, Volume3d<GeomType, ValueType>& volume)
 {
 	tinyxml2::XMLDocument xml;
-	xml.LoadFile(filename.c_str());
-
-	XMLElement* root = xml.FirstChildElement("root");
-
 	Volume3d<float, float>::Attribute attr;
-
-	{
-		XMLElement* res = root->FirstChildElement(resStr.c_str());
-		attr.resx = res->IntAttribute("x");
-		attr.resy = res->IntAttribute("y");
-		attr.resz = res->IntAttribute("z");
+	if (xml.LoadFile(filename.c_str()) != XML_SUCCESS || !read(xml, attr)) {
+		return false;
+	}
+	if (imageFileNames.size() != attr.resz || attr.resx == 0 || attr.resy == 0 ||
+		attr.resx > PNGFile::MaxDimension || attr.resy > PNGFile::MaxDimension || static_cast<size_t>(attr.resx) * attr.resy > PNGFile::MaxPixelCount) {
+		return false;
 	}
 
-	XMLElement* res = root->FirstChildElement("origin");
-	Vector3d<float> origin = XMLHelper::parse(*res);
+	Grid3d<ValueType> grid(attr.resx, attr.resy, attr.resz);
+	std::atomic<bool> isOk(true);
+	Crystal::Util::parallelFor(imageFileNames.size(), [&](const size_t z) {
+		// a throw would end the worker thread and the process with it.
+		PNGFile image;
+		bool isRead = false;
+		try {
+			isRead = image.read(imageFileNames[z]);
+		}
+		catch (const std::bad_alloc&) {
+		}
+		if (!isRead || image.getWidth() != attr.resx || image.getHeight() != attr.resy) {
+			isOk = false;
+			return;
+		}
+		const double max = image.getMaxValue();
+		const auto& pixels = image.getPixels();
+		ValueType* slice = grid.getSlice(z);
+		for (size_t i = 0; i < pixels.size(); ++i) {
+			slice[i] = static_cast<ValueType>(pixels[i] / max);
+		}
+	}, getSliceThreadCount(attr.resx, attr.resy));
+	if (!isOk) {
+		return false;
+	}
 
-	XMLElement* lengthElem = root->FirstChildElement("length");
-	Vector3d<float> length = XMLHelper::parse(*lengthElem);
+	const Vector3d<GeomType> start(attr.space.getStart().getX(), attr.space.getStart().getY(), attr.space.getStart().getZ());
+	const Vector3d<GeomType> length(attr.space.getLengths().getX(), attr.space.getLengths().getY(), attr.space.getLengths().getZ());
+	volume = Volume3d<GeomType, ValueType>(Space3d<GeomType>(start, length), std::move(grid));
+	return true;
+}
 
-	Space3d<float> space(origin, length);
-	attr.space = space;
+// a slice in flight holds its pixels, the raw scanlines and the deflate stream. no more threads than cores.
+template<typename GeomType, typename ValueType>
+size_t CGBFile<GeomType, ValueType>::getSliceThreadCount(const size_t width, const size_t height) const
+{
+	const size_t sliceBytes = std::max<size_t>(1, width * height * 8);
+	return std::max<size_t>(1, std::min<size_t>(Crystal::Util::getThreadCount(), memoryBudget / sliceBytes));
+}
 
-	XMLElement* volumeElem = root->FirstChildElement("volume");
-	XMLElement* imageElem = volumeElem->FirstChildElement("image");
+static bool toVector(const XMLElement* elem, Vector3d<float>& v)
+{
+	float x = 0;
+	float y = 0;
+	float z = 0;
+	if (elem == nullptr ||
+		elem->QueryFloatAttribute("x", &x) != XML_SUCCESS ||
+		elem->QueryFloatAttribute("y", &y) != XML_SUCCESS ||
+		elem->QueryFloatAttribute("z", &z) != XML_SUCCESS) {
+		return false;
+	}
+	v = Vector3d<float>(x, y, z);
+	return true;
+}
 
+// every element and attribute of the header must be present.
+template<typename GeomType, typename ValueType>
+bool CGBFile<GeomType, ValueType>::read(const tinyxml2::XMLDocument& xml, Volume3d<float, float>::Attribute& attr)
+{
 	imageFileNames.clear();
-	while (imageElem != nullptr) {
-		imageFileNames.push_back(imageElem->Attribute("path"));
-		imageElem = imageElem->NextSiblingElement("image");
+	const XMLElement* root = xml.FirstChildElement("root");
+	if (root == nullptr) {
+		return false;
+	}
+
+	const XMLElement* res = root->FirstChildElement(resStr.c_str());
+	unsigned int resx = 0;
+	unsigned int resy = 0;
+	unsigned int resz = 0;
+	if (res == nullptr ||
+		res->QueryUnsignedAttribute("x", &resx) != XML_SUCCESS ||
+		res->QueryUnsignedAttribute("y", &resy) != XML_SUCCESS ||
+		res->QueryUnsignedAttribute("z", &resz) != XML_SUCCESS) {
+		return false;
+	}
+
+	Vector3d<float> origin;
+	Vector3d<float> length;
+	const XMLElement* volumeElem = root->FirstChildElement("volume");
+	if (!toVector(root->FirstChildElement(originStr.c_str()), origin) || !toVector(root->FirstChildElement("length"), length) || volumeElem == nullptr) {
+		return false;
 	}
 
+	std::vector<std::string> names;
+	for (const XMLElement* imageElem = volumeElem->FirstChildElement("image"); imageElem != nullptr; imageElem = imageElem->NextSiblingElement("image")) {
+		const char* path = imageElem->Attribute("path");
+		if (path == nullptr) {
+			return false;
+		}
+		names.push_back(path);
+	}
+
+	attr.resx = resx;
+	attr.resy = resy;
+	attr.resz = resz;
+	attr.space = Space3d<float>(origin, length);
+	imageFileNames = names;
+	return true;
+}
 
+// the default attribute and no image names when the header is broken.
+Volume3d<float, float>::Attribute CGBFile<float, float>::load(const std::string& filename)
+{
+	tinyxml2::XMLDocument xml;
+	Volume3d<float, float>::Attribute attr;
+	if (xml.LoadFile(filename.c_str()) != XML_SUCCESS || !read(xml, attr)) {
+		imageFileNames.clear();
+		return Volume3d<float, float>::Attribute();
+	}
 	return attr;
 }
 
@@ -121,3 +227,5 @@ Volume3d<float, float>::Attribute CGBFile<float, float>::load(const std::string&
 template bool CGBFile<float, float>::save(const std::string&, const std::string& filename, const Volume3d<float, float>& volume);
 
 template Volume3d<float, float>::Attribute CGBFile<float, float>::load(const std::string& str);
+
+template bool CGBFile<float, float>::load(const std::string& filename, Volume3d<float, float>& volume);
@@ -21,19 +21,44 @@ public:
 	static Math::Vector3d<float> parse(tinyxml2::XMLElement& elem);
 };
 
+// XML header plus one grayscale PNG per z slice. Values in [0, 1] map to the full gray range of the bit depth.
+// Slices are encoded and decoded in parallel; the memory budget bounds how many slices are in flight at once.
 template< typename GeomType, typename ValueType>
 class CGBFile final{
 public:
+	CGBFile() :
+		bitDepth(8),
+		memoryBudget(256 * 1024 * 1024)
+	{}
+
 	bool save(const std::string& directoryname, const std::string& filename, const Math::Volume3d<GeomType, ValueType>& volume);
 
+	// reads only the header.
 	Math::Volume3d<float, float>::Attribute load(const std::string& filename);
 
+	// reads the header and every slice image.
+	bool load(const std::string& filename, Math::Volume3d<GeomType, ValueType>& volume);
+
 	std::vector< std::string > getImageFileNames() const { return imageFileNames; }
 
+	// 8 or 16 bits per pixel for saved slices.
+	void setBitDepth(const unsigned int bitDepth) { this->bitDepth = bitDepth; }
+
+	unsigned int getBitDepth() const { return bitDepth; }
+
+	void setMemoryBudget(const size_t bytes) { this->memoryBudget = bytes; }
+
+	size_t getMemoryBudget() const { return memoryBudget; }
+
 private:
 	std::vector< std::string > imageFileNames;
+	unsigned int bitDepth;
+	size_t memoryBudget;
+
+	size_t getSliceThreadCount(const size_t width, const size_t height) const;
 
+	bool read(const tinyxml2::XMLDocument& xml, Math::Volume3d<float, float>::Attribute& attr);
 };
 	}
 }
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include <vector>
 #include <string>
 #include <fstream>
+#include <cstdio>
 
 
 using namespace tinyxml2;
@@ -35,4 +36,70 @@ TEST(CGBFileTest, TestLoad)
 	file.load("../IO/CGBTestFile.cgb");
 	EXPECT_EQ(2, file.getImageFileNames().size());
 
-}
\ No newline at end of file
+}
+
+TEST(CGBFileTest, TestSaveAndLoadSlices)
+{
+	Grid3d<float> grid(4, 3, 5);
+	for (size_t z = 0; z < 5; ++z) {
+		for (size_t y = 0; y < 3; ++y) {
+			for (size_t x = 0; x < 4; ++x) {
+				grid.set(x, y, z, (x + y * 4 + z * 12) / 59.0f);
+			}
+		}
+	}
+	const Volume3d<float, float> expected(Space3d<float>(Vector3d<float>(1, 2, 3), Vector3d<float>(4, 3, 5)), grid);
+
+	for (const unsigned int bitDepth : { 8u, 16u }) {
+		CGBFile<float, float> file;
+		file.setBitDepth(bitDepth);
+		file.setMemoryBudget(0);
+		EXPECT_TRUE(file.save(".", "CGBSliceTest.cgb", expected));
+		EXPECT_EQ(5, file.getImageFileNames().size());
+
+		Volume3d<float, float> actual;
+		EXPECT_TRUE(file.load("./CGBSliceTest.cgb", actual));
+		EXPECT_EQ(expected.getResolutions(), actual.getResolutions());
+		EXPECT_EQ(expected.getStart(), actual.getStart());
+		const float tolerance = (bitDepth == 8) ? 0.5f / 255 : 0.5f / 65535;
+		for (size_t z = 0; z < 5; ++z) {
+			for (size_t y = 0; y < 3; ++y) {
+				for (size_t x = 0; x < 4; ++x) {
+					EXPECT_NEAR(expected.getValue(x, y, z), actual.getValue(x, y, z), tolerance);
+				}
+			}
+		}
+		for (const auto& name : file.getImageFileNames()) {
+			std::remove(name.c_str());
+		}
+		std::remove("./CGBSliceTest.cgb");
+	}
+}
+
+TEST(CGBFileTest, TestLoadBrokenHeader)
+{
+	const std::string header = "<root><resolution x=\"1\" y=\"1\" z=\"1\"/><origin x=\"0\" y=\"0\" z=\"0\"/><length x=\"1\" y=\"1\" z=\"1\"/>";
+	const std::vector<std::string> texts = {
+		"not xml",
+		"<other/>",
+		"<root><origin x=\"0\" y=\"0\" z=\"0\"/><length x=\"1\" y=\"1\" z=\"1\"/><volume/></root>",
+		"<root><resolution x=\"1\" y=\"1\"/><origin x=\"0\" y=\"0\" z=\"0\"/><length x=\"1\" y=\"1\" z=\"1\"/><volume/></root>",
+		"<root><resolution x=\"1\" y=\"1\" z=\"1\"/><length x=\"1\" y=\"1\" z=\"1\"/><volume/></root>",
+		"<root><resolution x=\"1\" y=\"1\" z=\"1\"/><origin x=\"0\" y=\"0\" z=\"0\"/><volume/></root>",
+		header + "</root>",
+		header + "<volume><image/></volume></root>",
+	};
+	const std::string filename = "CGBBrokenTest.cgb";
+	for (const auto& text : texts) {
+		{
+			std::ofstream stream(filename.c_str());
+			stream << text;
+		}
+		CGBFile<float, float> file;
+		Volume3d<float, float> volume;
+		EXPECT_FALSE(file.load(filename, volume)) << text;
+		file.load(filename);
+		EXPECT_TRUE(file.getImageFileNames().empty());
+	}
+	std::remove(filename.c_str());
+}
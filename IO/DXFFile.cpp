@@ -1,57 +1,21 @@
 #include "DXFFile.h"
 
+#include "DXFReader.h"
+
 #include <iostream>
 #include <string>
 
 using namespace Crystal::Math;
 using namespace Crystal::IO;
 
-void DXFFile::read(std::istream& stream)
+bool DXFFile::read(std::istream& stream)
 {
-	std::string str;
-	std::getline(stream, str);
-	const int is0 = std::stoi(str);
-	assert(is0 == 0);
-
-	std::getline( stream, str);
-	assert( str == "SECTION" );
-
-	std::getline(stream, str);
-	const int is2 = std::stoi(str);
-	assert(is2 == 2);
-
-	std::getline(stream, str);
-	assert(str == "ENTITIES");
-
-	while (str != "EOF") {
-		DXFFace f;
-		std::getline(stream, str);
-		Vector3dVector<float> positions;
-		Vector3d<float> pos;
-		if (str == "0") {
-			std::getline(stream, str);
-			if (str == "3DFACE") {
-				;
-			}
-		}
-		else if (str == "8") {
-			std::getline(stream, str);
-			f.setLayerName( str );
-		}
-		else if (str == "10") {
-			std::getline(stream, str);
-			pos.setX( std::stof(str) );
-		}
-		else if (str == "20") {
-			std::getline(stream, str);
-			pos.setY( std::stof(str) );
-		}
-		else if (str == "30") {
-			std::getline(stream, str);
-			pos.setZ(std::stof(str));
-			positions.push_back(pos);
-		}
+	DXFReader reader;
+	if (!reader.read(stream)) {
+		return false;
 	}
+	faces = reader.toFaces();
+	return true;
 }
 
 void DXFFile::write(std::ostream& stream)
@@ -94,12 +58,12 @@ void DXFFile::write(std::ostream& stream)
 		strs.push_back( std::to_string(v2.getZ()));
 
 		const Vector3d<float>& v3 = f.getPositions()[3];
-		strs.push_back(" 13");
-		strs.push_back( std::to_string(v2.getX()));
-		strs.push_back(" 23");
-		strs.push_back( std::to_string(v2.getY()));
+		strs.push_back( "13");
+		strs.push_back( std::to_string(v3.getX()));
+		strs.push_back( "23");
+		strs.push_back( std::to_string(v3.getY()));
 		strs.push_back( "33");
-		strs.push_back( std::to_string(v2.getZ()));
+		strs.push_back( std::to_string(v3.getZ()));
 	}
 
 
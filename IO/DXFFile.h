@@ -19,7 +19,7 @@ struct DXFFace{
 		this->positions = positions;
 	}
 
-	Math::Vector3dVector<float> getPositions() const { return positions; }
+	const Math::Vector3dVector<float>& getPositions() const { return positions; }
 
 	void setLayerName(const std::string& layerName) { this->layerName = layerName; }
 
@@ -37,11 +37,12 @@ class DXFFile{
 public:
 	DXFFile(){};
 
-	void read(std::istream& stream);
+	// 3DFACEs and polyface/polygon meshes of the ENTITIES section as triangle faces, via DXFReader.
+	bool read(std::istream& stream);
 
 	void write(std::ostream& stream);
 
-	void setFaces(const DXFFaceVector& face) { this->faces = faces; }
+	void setFaces(const DXFFaceVector& faces) { this->faces = faces; }
 
 	DXFFaceVector getFaces() const { return faces; }
 
@@ -2,6 +2,7 @@
 
 #include "../IO/DXFFile.h"
 
+using namespace Crystal::Math;
 using namespace Crystal::IO;
 
 TEST(DXFFileTest, TestRead)
@@ -53,4 +54,22 @@ TEST(DXFFileTest, TestWrite)
 
 	EXPECT_EQ( "0", strs[strs.size()-2] );
 	EXPECT_EQ( "EOF", strs.back());
-}
\ No newline at end of file
+}
+
+TEST(DXFFileTest, TestReadWritten)
+{
+	DXFFace face;
+	face.setLayerName("wall");
+	face.setPositions({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) });
+	DXFFile file;
+	file.setFaces({ face });
+	std::stringstream stream;
+	file.write(stream);
+
+	DXFFile actual;
+	EXPECT_TRUE(actual.read(stream));
+	const auto& faces = actual.getFaces();
+	EXPECT_EQ(2, faces.size());
+	EXPECT_EQ("wall", faces[1].getLayerName());
+	EXPECT_EQ(Vector3d<float>(0, 1, 0), faces[1].getPositions()[2]);
+}
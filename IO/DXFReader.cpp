@@ -0,0 +1,389 @@
+#include "DXFReader.h"
+
+#include "MappedFile.h"
+#include "TextScanner.h"
+
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	enum class EntityType
+	{
+		None,
+		Face,
+		Line,
+		Polyline,
+		Vertex,
+		SeqEnd,
+		Other,
+	};
+
+	// group values of the entity being read; pointers refer into the input.
+	struct Entity
+	{
+		EntityType type;
+		const char* layerBegin;
+		const char* layerEnd;
+		int color;
+		int flags;
+		int ints[4];
+		float corners[4][3];
+		unsigned int cornerMask;
+
+		void reset(const EntityType type) {
+			this->type = type;
+			layerBegin = nullptr;
+			layerEnd = nullptr;
+			color = 256;
+			flags = 0;
+			std::fill(ints, ints + 4, 0);
+			std::fill(&corners[0][0], &corners[0][0] + 12, 0.0f);
+			cornerMask = 0;
+		}
+
+		Vector3d<float> getCorner(const int i) const { return Vector3d<float>(corners[i][0], corners[i][1], corners[i][2]); }
+	};
+
+	// vertices and face records collected between POLYLINE and SEQEND.
+	struct Polyline
+	{
+		bool isOpen;
+		int flags;
+		int m;
+		int n;
+		unsigned int layer;
+		int color;
+		Vector3dVector<float> vertices;
+		std::vector<int> faces;
+	};
+
+	bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	bool equals(const char* begin, const char* end, const char* s)
+	{
+		const size_t length = std::strlen(s);
+		return static_cast<size_t>(end - begin) == length && std::memcmp(begin, s, length) == 0;
+	}
+
+	EntityType toEntityType(const char* begin, const char* end)
+	{
+		if (equals(begin, end, "3DFACE")) {
+			return EntityType::Face;
+		}
+		if (equals(begin, end, "LINE")) {
+			return EntityType::Line;
+		}
+		if (equals(begin, end, "POLYLINE")) {
+			return EntityType::Polyline;
+		}
+		if (equals(begin, end, "VERTEX")) {
+			return EntityType::Vertex;
+		}
+		if (equals(begin, end, "SEQEND")) {
+			return EntityType::SeqEnd;
+		}
+		return EntityType::Other;
+	}
+}
+
+bool DXFReader::read(const std::string& filename)
+{
+	MappedFile file;
+	if (!file.open(filename)) {
+		clear();
+		error = "cannot open " + filename;
+		return false;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.getData());
+	return read(begin, begin + file.getSize());
+}
+
+bool DXFReader::read(std::istream& stream)
+{
+	const std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return read(buffer.data(), buffer.data() + buffer.size());
+}
+
+bool DXFReader::read(const char* begin, const char* end)
+{
+	clear();
+	const char* p = begin;
+	unsigned int line = 0;
+	const auto fail = [&](const std::string& message) {
+		const std::string e = std::to_string(line) + ": " + message;
+		clear();
+		errorLine = line;
+		error = e;
+		return false;
+	};
+	// the next line without its break and surrounding blanks.
+	const auto readLine = [&](const char*& b, const char*& e) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		b = p;
+		e = lineEnd;
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+		++line;
+		while (b < e && isSpace(*b)) {
+			++b;
+		}
+		while (e > b && isSpace(e[-1])) {
+			--e;
+		}
+	};
+
+	Entity entity;
+	entity.reset(EntityType::None);
+	Polyline polyline;
+	polyline.isOpen = false;
+	bool isInEntities = false;
+	bool isSectionName = false;
+
+	const auto closePolyline = [&]() {
+		polyline.isOpen = false;
+		const int count = static_cast<int>(polyline.vertices.size());
+		const auto& vs = polyline.vertices;
+		if (polyline.flags & 64) {
+			for (size_t f = 0; f < polyline.faces.size(); f += 4) {
+				// negative indices only hide the following edge.
+				int is[4];
+				for (int k = 0; k < 4; ++k) {
+					is[k] = std::abs(polyline.faces[f + k]);
+					if (is[k] > count || (k < 3 && is[k] == 0)) {
+						return false;
+					}
+				}
+				addTriangle(vs[is[0] - 1], vs[is[1] - 1], vs[is[2] - 1], polyline.layer, polyline.color);
+				if (is[3] != 0 && is[3] != is[2]) {
+					addTriangle(vs[is[0] - 1], vs[is[2] - 1], vs[is[3] - 1], polyline.layer, polyline.color);
+				}
+			}
+		}
+		else if (polyline.flags & 16) {
+			const int m = polyline.m;
+			const int n = polyline.n;
+			if (m < 2 || n < 2 || m > count / n || m * n != count) {
+				return false;
+			}
+			const int rows = (polyline.flags & 1) ? m : m - 1;
+			const int columns = (polyline.flags & 32) ? n : n - 1;
+			for (int i = 0; i < rows; ++i) {
+				for (int j = 0; j < columns; ++j) {
+					const auto& v00 = vs[i * n + j];
+					const auto& v10 = vs[((i + 1) % m) * n + j];
+					const auto& v01 = vs[i * n + (j + 1) % n];
+					const auto& v11 = vs[((i + 1) % m) * n + (j + 1) % n];
+					addTriangle(v00, v10, v11, polyline.layer, polyline.color);
+					addTriangle(v00, v11, v01, polyline.layer, polyline.color);
+				}
+			}
+		}
+		else {
+			for (int i = 0; i + 1 < count; ++i) {
+				addLine(vs[i], vs[i + 1], polyline.layer);
+			}
+			if ((polyline.flags & 1) && count > 2) {
+				addLine(vs[count - 1], vs[0], polyline.layer);
+			}
+		}
+		return true;
+	};
+
+	const auto finishEntity = [&]() {
+		// vertices belong to the layer of their polyline.
+		const bool hasLayer = (entity.type == EntityType::Face || entity.type == EntityType::Line || entity.type == EntityType::Polyline);
+		const unsigned int layer = !hasLayer ? 0 :
+			((entity.layerBegin == nullptr) ? toLayer("0", "0" + 1) : toLayer(entity.layerBegin, entity.layerEnd));
+		switch (entity.type) {
+		case EntityType::Face:
+			if (!(entity.cornerMask & 8)) {
+				std::copy(entity.corners[2], entity.corners[2] + 3, entity.corners[3]);
+			}
+			addTriangle(entity.getCorner(0), entity.getCorner(1), entity.getCorner(2), layer, entity.color);
+			if (entity.getCorner(3) != entity.getCorner(2)) {
+				addTriangle(entity.getCorner(0), entity.getCorner(2), entity.getCorner(3), layer, entity.color);
+			}
+			return true;
+		case EntityType::Line:
+			addLine(entity.getCorner(0), entity.getCorner(1), layer);
+			return true;
+		case EntityType::Polyline:
+			if (polyline.isOpen && !closePolyline()) {
+				return false;
+			}
+			polyline.isOpen = true;
+			polyline.flags = entity.flags;
+			polyline.m = entity.ints[0];
+			polyline.n = entity.ints[1];
+			polyline.layer = layer;
+			polyline.color = entity.color;
+			polyline.vertices.clear();
+			polyline.faces.clear();
+			return true;
+		case EntityType::Vertex:
+			if (!polyline.isOpen) {
+				return true;
+			}
+			if ((entity.flags & 128) && !(entity.flags & 64)) {
+				polyline.faces.insert(polyline.faces.end(), entity.ints, entity.ints + 4);
+			}
+			else {
+				polyline.vertices.push_back(entity.getCorner(0));
+			}
+			return true;
+		case EntityType::SeqEnd:
+			return !polyline.isOpen || closePolyline();
+		default:
+			return true;
+		}
+	};
+
+	while (p < end) {
+		const char* b = nullptr;
+		const char* e = nullptr;
+		readLine(b, e);
+		if (b == e && p >= end) {
+			break;
+		}
+		int code = 0;
+		const char* q = b;
+		if (!TextScanner::parseInt(q, e, code) || q != e) {
+			return fail("expected a group code");
+		}
+		if (p >= end) {
+			return fail("expected a value for group code " + std::to_string(code));
+		}
+		readLine(b, e);
+
+		if (code == 0) {
+			if (!finishEntity()) {
+				return fail("invalid polyline vertices");
+			}
+			entity.reset(EntityType::None);
+			if (equals(b, e, "SECTION")) {
+				isSectionName = true;
+			}
+			else if (equals(b, e, "ENDSEC")) {
+				isInEntities = false;
+			}
+			else if (equals(b, e, "EOF")) {
+				break;
+			}
+			else if (isInEntities) {
+				entity.reset(toEntityType(b, e));
+			}
+			continue;
+		}
+		if (code == 2 && isSectionName) {
+			isInEntities = equals(b, e, "ENTITIES");
+			isSectionName = false;
+			continue;
+		}
+		if (entity.type == EntityType::None || entity.type == EntityType::Other) {
+			continue;
+		}
+		if (code == 8) {
+			entity.layerBegin = b;
+			entity.layerEnd = e;
+		}
+		else if (code == 62 || code == 70 || (code >= 71 && code <= 74)) {
+			int v = 0;
+			q = b;
+			if (!TextScanner::parseInt(q, e, v) || q != e) {
+				return fail("expected an integer");
+			}
+			if (code == 62) {
+				entity.color = v;
+			}
+			else if (code == 70) {
+				entity.flags = v;
+			}
+			else {
+				entity.ints[code - 71] = v;
+			}
+		}
+		else if (code >= 10 && code <= 33 && code % 10 <= 3) {
+			float v = 0.0f;
+			q = b;
+			if (!TextScanner::parseFloat(q, e, v) || q != e) {
+				return fail("expected a number");
+			}
+			const int corner = code % 10;
+			entity.corners[corner][code / 10 - 1] = v;
+			entity.cornerMask |= (1u << corner);
+		}
+	}
+	if (!finishEntity() || (polyline.isOpen && !closePolyline())) {
+		return fail("invalid polyline vertices");
+	}
+	return true;
+}
+
+void DXFReader::clear()
+{
+	trianglePositions.clear();
+	triangleLayers.clear();
+	triangleColors.clear();
+	linePositions.clear();
+	lineLayers.clear();
+	layers.clear();
+	lastLayer = 0;
+	error.clear();
+	errorLine = 0;
+}
+
+DXFFaceVector DXFReader::toFaces() const
+{
+	DXFFaceVector faces(getTriangleCount());
+	for (size_t i = 0; i < faces.size(); ++i) {
+		const auto& v2 = trianglePositions[i * 3 + 2];
+		faces[i].setPositions({ trianglePositions[i * 3], trianglePositions[i * 3 + 1], v2, v2 });
+		faces[i].setLayerName(layers[triangleLayers[i]]);
+		faces[i].setColorNumber(triangleColors[i]);
+	}
+	return faces;
+}
+
+void DXFReader::addTriangle(const Vector3d<float>& v0, const Vector3d<float>& v1, const Vector3d<float>& v2, const unsigned int layer, const int color)
+{
+	trianglePositions.push_back(v0);
+	trianglePositions.push_back(v1);
+	trianglePositions.push_back(v2);
+	triangleLayers.push_back(layer);
+	triangleColors.push_back(color);
+}
+
+void DXFReader::addLine(const Vector3d<float>& v0, const Vector3d<float>& v1, const unsigned int layer)
+{
+	linePositions.push_back(v0);
+	linePositions.push_back(v1);
+	lineLayers.push_back(layer);
+}
+
+// entities mostly repeat the previous layer, so that one is checked before the list.
+unsigned int DXFReader::toLayer(const char* begin, const char* end)
+{
+	const size_t length = end - begin;
+	const auto matches = [&](const std::string& name) {
+		return name.size() == length && std::memcmp(name.data(), begin, length) == 0;
+	};
+	if (lastLayer < layers.size() && matches(layers[lastLayer])) {
+		return lastLayer;
+	}
+	for (size_t i = 0; i < layers.size(); ++i) {
+		if (matches(layers[i])) {
+			lastLayer = static_cast<unsigned int>(i);
+			return lastLayer;
+		}
+	}
+	layers.push_back(std::string(begin, end));
+	lastLayer = static_cast<unsigned int>(layers.size() - 1);
+	return lastLayer;
+}
@@ -0,0 +1,88 @@
+#ifndef __CRYSTAL_IO_DXF_READER_H__
+#define __CRYSTAL_IO_DXF_READER_H__
+
+#include "DXFFile.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+
+namespace Crystal {
+	namespace IO {
+
+// Reads the geometry of the ENTITIES section of an ASCII DXF. Group-code pairs are scanned in place from a
+// character range (memory-mapped for files); values are compared and parsed where they lie, so no string is built
+// per line.
+//
+// 3DFACE becomes one triangle, or two when its fourth corner differs from the third. POLYLINE/VERTEX/SEQEND
+// becomes triangles for polyface meshes (flag 64) and M x N polygon meshes (flag 16), and segments otherwise,
+// closing the loop when flag 1 is set. LINE becomes one segment. Other entities are skipped.
+class DXFReader final
+{
+public:
+	DXFReader() :
+		lastLayer(0),
+		errorLine(0)
+	{}
+
+	~DXFReader() = default;
+
+	bool read(const std::string& filename);
+
+	bool read(std::istream& stream);
+
+	bool read(const char* begin, const char* end);
+
+	void clear();
+
+	size_t getTriangleCount() const { return triangleColors.size(); }
+
+	// three per triangle.
+	const Math::Vector3dVector<float>& getTrianglePositions() const { return trianglePositions; }
+
+	// one per triangle, indexing getLayers().
+	const std::vector<unsigned int>& getTriangleLayers() const { return triangleLayers; }
+
+	// one per triangle; 256 is BYLAYER.
+	const std::vector<int>& getTriangleColors() const { return triangleColors; }
+
+	size_t getLineCount() const { return lineLayers.size(); }
+
+	// two per segment.
+	const Math::Vector3dVector<float>& getLinePositions() const { return linePositions; }
+
+	const std::vector<unsigned int>& getLineLayers() const { return lineLayers; }
+
+	// layer names in order of first use.
+	const std::vector<std::string>& getLayers() const { return layers; }
+
+	// one face per triangle, with the third corner repeated as DXF writes triangles.
+	DXFFaceVector toFaces() const;
+
+	// "line: message" for the last failed read, empty otherwise.
+	std::string getError() const { return error; }
+
+	unsigned int getErrorLine() const { return errorLine; }
+
+private:
+	Math::Vector3dVector<float> trianglePositions;
+	std::vector<unsigned int> triangleLayers;
+	std::vector<int> triangleColors;
+	Math::Vector3dVector<float> linePositions;
+	std::vector<unsigned int> lineLayers;
+	std::vector<std::string> layers;
+	unsigned int lastLayer;
+	std::string error;
+	unsigned int errorLine;
+
+	void addTriangle(const Math::Vector3d<float>& v0, const Math::Vector3d<float>& v1, const Math::Vector3d<float>& v2, const unsigned int layer, const int color);
+
+	void addLine(const Math::Vector3d<float>& v0, const Math::Vector3d<float>& v1, const unsigned int layer);
+
+	unsigned int toLayer(const char* begin, const char* end);
+};
+
+	}
+}
+
+#endif
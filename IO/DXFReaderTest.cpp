@@ -0,0 +1,182 @@
+#include "gtest/gtest.h"
+
+#include "DXFReader.h"
+
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class DXFReaderTest : public testing::Test {
+protected:
+	// group-code pairs as AutoCAD writes them, with right-aligned codes.
+	class DXFText
+	{
+	public:
+		DXFText& add(const int code, const std::string& value) {
+			char buffer[16];
+			sprintf(buffer, "%3d", code);
+			stream << buffer << "\r\n" << value << "\r\n";
+			return *this;
+		}
+
+		DXFText& add(const int code, const float value) {
+			return add(code, std::to_string(value));
+		}
+
+		DXFText& addPoint(const int code, const Vector3d<float>& v) {
+			return add(code, v.getX()).add(code + 10, v.getY()).add(code + 20, v.getZ());
+		}
+
+		DXFText& addVertex(const Vector3d<float>& v, const int flags) {
+			return add(0, "VERTEX").add(8, "mesh").addPoint(10, v).add(70, std::to_string(flags));
+		}
+
+		DXFText& addFaceRecord(const int a, const int b, const int c, const int d) {
+			add(0, "VERTEX").add(8, "mesh").addPoint(10, Vector3d<float>()).add(70, "128");
+			return add(71, std::to_string(a)).add(72, std::to_string(b)).add(73, std::to_string(c)).add(74, std::to_string(d));
+		}
+
+		std::string str() const { return stream.str(); }
+
+	private:
+		std::stringstream stream;
+	};
+
+	static DXFText toHeader()
+	{
+		DXFText text;
+		text.add(0, "SECTION").add(2, "HEADER").add(9, "$EXTMIN").addPoint(10, Vector3d<float>(-1, -1, -1)).add(0, "ENDSEC");
+		text.add(0, "SECTION").add(2, "ENTITIES");
+		return text;
+	}
+
+	static bool read(DXFReader& reader, const std::string& text)
+	{
+		return reader.read(text.data(), text.data() + text.size());
+	}
+};
+
+TEST_F(DXFReaderTest, TestRead3DFace)
+{
+	DXFText text = toHeader();
+	text.add(0, "3DFACE").add(8, "wall").add(62, "1")
+		.addPoint(10, Vector3d<float>(0, 0, 0)).addPoint(11, Vector3d<float>(1, 0, 0)).addPoint(12, Vector3d<float>(1, 1, 0)).addPoint(13, Vector3d<float>(1, 1, 0));
+	text.add(0, "3DFACE").add(8, "floor")
+		.addPoint(10, Vector3d<float>(0, 0, 1)).addPoint(11, Vector3d<float>(1, 0, 1)).addPoint(12, Vector3d<float>(1, 1, 1)).addPoint(13, Vector3d<float>(0, 1, 1));
+	text.add(0, "CIRCLE").add(8, "ignored").addPoint(10, Vector3d<float>(5, 5, 5)).add(40, 1.0f);
+	text.add(0, "LINE").add(8, "wall").addPoint(10, Vector3d<float>(0, 0, 0)).addPoint(11, Vector3d<float>(0, 0, 2));
+	text.add(0, "ENDSEC").add(0, "EOF");
+
+	DXFReader reader;
+	EXPECT_TRUE(read(reader, text.str()));
+	EXPECT_EQ(3, reader.getTriangleCount());
+	const Vector3dVector<float> expected = {
+		Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0),
+		Vector3d<float>(0, 0, 1), Vector3d<float>(1, 0, 1), Vector3d<float>(1, 1, 1),
+		Vector3d<float>(0, 0, 1), Vector3d<float>(1, 1, 1), Vector3d<float>(0, 1, 1)
+	};
+	EXPECT_EQ(expected, reader.getTrianglePositions());
+	EXPECT_EQ(std::vector<std::string>({ "wall", "floor" }), reader.getLayers());
+	EXPECT_EQ(std::vector<unsigned int>({ 0, 1, 1 }), reader.getTriangleLayers());
+	EXPECT_EQ(std::vector<int>({ 1, 256, 256 }), reader.getTriangleColors());
+	EXPECT_EQ(1, reader.getLineCount());
+	EXPECT_EQ(Vector3d<float>(0, 0, 2), reader.getLinePositions()[1]);
+	EXPECT_EQ(std::vector<unsigned int>({ 0 }), reader.getLineLayers());
+
+	const auto& faces = reader.toFaces();
+	EXPECT_EQ(3, faces.size());
+	EXPECT_EQ("floor", faces[1].getLayerName());
+	EXPECT_EQ(Vector3d<float>(1, 1, 1), faces[1].getPositions()[3]);
+}
+
+TEST_F(DXFReaderTest, TestReadPolylines)
+{
+	DXFText text = toHeader();
+	// a closed 3D polyline.
+	text.add(0, "POLYLINE").add(8, "path").add(66, "1").add(70, "9");
+	text.addVertex(Vector3d<float>(0, 0, 0), 32).addVertex(Vector3d<float>(1, 0, 0), 32).addVertex(Vector3d<float>(1, 1, 0), 32);
+	text.add(0, "SEQEND");
+	// a polyface mesh: a quad and a triangle with a hidden edge.
+	text.add(0, "POLYLINE").add(8, "mesh").add(66, "1").add(70, "64").add(71, "5").add(72, "2");
+	text.addVertex(Vector3d<float>(0, 0, 0), 192).addVertex(Vector3d<float>(1, 0, 0), 192).addVertex(Vector3d<float>(1, 1, 0), 192).addVertex(Vector3d<float>(0, 1, 0), 192).addVertex(Vector3d<float>(0, 0, 1), 192);
+	text.addFaceRecord(1, 2, 3, 4).addFaceRecord(1, -2, 5, 0);
+	text.add(0, "SEQEND");
+	// a 2 x 3 polygon mesh.
+	text.add(0, "POLYLINE").add(8, "grid").add(66, "1").add(70, "16").add(71, "2").add(72, "3");
+	for (int i = 0; i < 2; ++i) {
+		for (int j = 0; j < 3; ++j) {
+			text.addVertex(Vector3d<float>(static_cast<float>(i), static_cast<float>(j), 0), 64);
+		}
+	}
+	text.add(0, "SEQEND");
+	text.add(0, "ENDSEC").add(0, "EOF");
+
+	DXFReader reader;
+	EXPECT_TRUE(read(reader, text.str())) << reader.getError();
+	EXPECT_EQ(3, reader.getLineCount());
+	EXPECT_EQ(Vector3d<float>(0, 0, 0), reader.getLinePositions()[5]);
+	EXPECT_EQ(3 + 4, reader.getTriangleCount());
+	const auto& ps = reader.getTrianglePositions();
+	EXPECT_EQ(Vector3d<float>(0, 1, 0), ps[5]);
+	EXPECT_EQ(Vector3d<float>(0, 0, 1), ps[8]);
+	EXPECT_EQ(Vector3d<float>(1, 1, 0), ps[11]);
+	EXPECT_EQ(std::vector<std::string>({ "path", "mesh", "grid" }), reader.getLayers());
+	EXPECT_EQ(2, reader.getTriangleLayers()[5]);
+}
+
+TEST_F(DXFReaderTest, TestReadInvalid)
+{
+	DXFReader reader;
+	{
+		const std::string text = "  0\nSECTION\n  2\nENTITIES\nx\n3DFACE\n";
+		EXPECT_FALSE(read(reader, text));
+		EXPECT_EQ(5, reader.getErrorLine());
+		EXPECT_EQ("5: expected a group code", reader.getError());
+	}
+	{
+		const std::string text = "  0\nSECTION\n  2\nENTITIES\n  0\n3DFACE\n 10\n1.0.0\n";
+		EXPECT_FALSE(read(reader, text));
+		EXPECT_EQ(8, reader.getErrorLine());
+		EXPECT_EQ(0, reader.getTriangleCount());
+	}
+	{
+		DXFText text = toHeader();
+		text.add(0, "POLYLINE").add(70, "64");
+		text.addVertex(Vector3d<float>(0, 0, 0), 192).addFaceRecord(1, 2, 3, 0);
+		text.add(0, "SEQEND").add(0, "ENDSEC").add(0, "EOF");
+		EXPECT_FALSE(read(reader, text.str()));
+	}
+	{
+		// 65536 * 65536 wraps to the vertex count 0.
+		DXFText text = toHeader();
+		text.add(0, "POLYLINE").add(70, "16").add(71, "65536").add(72, "65536");
+		text.add(0, "SEQEND").add(0, "ENDSEC").add(0, "EOF");
+		EXPECT_FALSE(read(reader, text.str()));
+	}
+	{
+		const std::string text = "  0\nSECTION\n  2\nENTITIES\n  0\n";
+		EXPECT_FALSE(read(reader, text));
+	}
+	EXPECT_TRUE(read(reader, ""));
+}
+
+TEST_F(DXFReaderTest, TestReadFile)
+{
+	const std::string filename = "DXFReaderTest.dxf";
+	DXFText text = toHeader();
+	text.add(0, "3DFACE").addPoint(10, Vector3d<float>(0, 0, 0)).addPoint(11, Vector3d<float>(1, 0, 0)).addPoint(12, Vector3d<float>(0, 1, 0));
+	text.add(0, "ENDSEC").add(0, "EOF");
+	{
+		std::ofstream stream(filename.c_str(), std::ios::binary);
+		stream << text.str();
+	}
+	DXFReader reader;
+	EXPECT_TRUE(reader.read(filename));
+	EXPECT_EQ(1, reader.getTriangleCount());
+	EXPECT_EQ(std::vector<std::string>({ "0" }), reader.getLayers());
+	std::remove(filename.c_str());
+	EXPECT_FALSE(reader.read(filename));
+}
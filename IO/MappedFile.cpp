@@ -0,0 +1,122 @@
+#include "MappedFile.h"
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace Crystal::IO;
+
+#ifdef _WIN32
+
+MappedFile::MappedFile() :
+	data(nullptr),
+	size(0),
+	file(INVALID_HANDLE_VALUE),
+	mapping(nullptr)
+{}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+	file = ::CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		return false;
+	}
+	LARGE_INTEGER fileSize;
+	if (!::GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0) {
+		close();
+		return false;
+	}
+	mapping = ::CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		close();
+		return false;
+	}
+	data = static_cast<const unsigned char*>(::MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (data == nullptr) {
+		close();
+		return false;
+	}
+	size = static_cast<size_t>(fileSize.QuadPart);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data != nullptr) {
+		::UnmapViewOfFile(data);
+		data = nullptr;
+	}
+	if (mapping != nullptr) {
+		::CloseHandle(mapping);
+		mapping = nullptr;
+	}
+	if (file != INVALID_HANDLE_VALUE) {
+		::CloseHandle(file);
+		file = INVALID_HANDLE_VALUE;
+	}
+	size = 0;
+}
+
+#else
+
+MappedFile::MappedFile() :
+	data(nullptr),
+	size(0),
+	file(-1)
+{}
+
+bool MappedFile::open(const std::string& filename)
+{
+	close();
+	file = ::open(filename.c_str(), O_RDONLY);
+	if (file < 0) {
+		return false;
+	}
+	struct stat status;
+	if (::fstat(file, &status) != 0 || status.st_size == 0) {
+		close();
+		return false;
+	}
+	void* p = ::mmap(nullptr, static_cast<size_t>(status.st_size), PROT_READ, MAP_PRIVATE, file, 0);
+	if (p == MAP_FAILED) {
+		close();
+		return false;
+	}
+	data = static_cast<const unsigned char*>(p);
+	size = static_cast<size_t>(status.st_size);
+	return true;
+}
+
+void MappedFile::close()
+{
+	if (data != nullptr) {
+		::munmap(const_cast<unsigned char*>(data), size);
+		data = nullptr;
+	}
+	if (file >= 0) {
+		::close(file);
+		file = -1;
+	}
+	size = 0;
+}
+
+#endif
+
+MappedFile::MappedFile(const std::string& filename) :
+	MappedFile()
+{
+	open(filename);
+}
+
+MappedFile::~MappedFile()
+{
+	close();
+}
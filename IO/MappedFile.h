@@ -0,0 +1,47 @@
+#ifndef __CRYSTAL_IO_MAPPED_FILE_H__
+#define __CRYSTAL_IO_MAPPED_FILE_H__
+
+#include "../Util/UnCopyable.h"
+
+#include <string>
+#include <cstddef>
+
+namespace Crystal {
+	namespace IO {
+
+// Read-only memory mapping of a whole file. Pages are loaded by the OS on first touch, so opening a large file is
+// cheap and readers only pay for the ranges they read.
+class MappedFile final : UnCopyable
+{
+public:
+	MappedFile();
+
+	explicit MappedFile(const std::string& filename);
+
+	~MappedFile();
+
+	bool open(const std::string& filename);
+
+	void close();
+
+	bool isOpen() const { return data != nullptr; }
+
+	const unsigned char* getData() const { return data; }
+
+	size_t getSize() const { return size; }
+
+private:
+	const unsigned char* data;
+	size_t size;
+#ifdef _WIN32
+	void* file;
+	void* mapping;
+#else
+	int file;
+#endif
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,127 @@
+#include "MeshBatchConverter.h"
+
+#include "../Util/Parallel.h"
+
+#include <algorithm>
+#include <exception>
+#include <map>
+#include <set>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <dirent.h>
+#endif
+
+using namespace Crystal::IO;
+
+namespace {
+	// the same spelling for the same path: forward slashes and no "." directories.
+	std::string toKey(const std::string& filename)
+	{
+		std::string key = filename;
+		std::replace(key.begin(), key.end(), '\\', '/');
+		for (size_t dot = key.find("/./"); dot != std::string::npos; dot = key.find("/./")) {
+			key.erase(dot, 2);
+		}
+		while (key.compare(0, 2, "./") == 0) {
+			key.erase(0, 2);
+		}
+		return key;
+	}
+}
+
+// outputs shared by several inputs or naming an input are refused before anything is written.
+std::vector<MeshBatchConverter::Result> MeshBatchConverter::convert(const std::vector<std::string>& filenames) const
+{
+	std::vector<Result> results(filenames.size());
+	std::set<std::string> inputs;
+	std::map<std::string, size_t> outputCounts;
+	for (size_t i = 0; i < filenames.size(); ++i) {
+		results[i].input = filenames[i];
+		results[i].output = toOutputName(filenames[i]);
+		results[i].isSucceeded = false;
+		inputs.insert(toKey(filenames[i]));
+		++outputCounts[toKey(results[i].output)];
+	}
+	for (auto& result : results) {
+		const std::string& key = toKey(result.output);
+		if (outputCounts[key] > 1) {
+			result.error = result.output + ": written by more than one input";
+		}
+		else if (inputs.count(key) > 0) {
+			result.error = result.output + ": is an input";
+		}
+	}
+
+	Crystal::Util::parallelFor(filenames.size(), [&](const size_t i) {
+		Result& result = results[i];
+		if (!result.error.empty()) {
+			return;
+		}
+		// a throw would end the worker thread and the process with it, so it only fails this file.
+		try {
+			MeshIO io;
+			io.setThreadCount(1);
+			if (!io.read(result.input)) {
+				result.error = io.getError();
+				return;
+			}
+			if (!io.write(result.output, io.getMesh(), outputFormat)) {
+				result.error = result.output + ": cannot write";
+				return;
+			}
+			result.isSucceeded = true;
+		}
+		catch (const std::exception& e) {
+			result.error = result.input + ": " + e.what();
+		}
+	}, threadCount);
+	return results;
+}
+
+std::vector<std::string> MeshBatchConverter::listFiles(const std::string& directory)
+{
+	std::vector<std::string> names;
+#ifdef _WIN32
+	WIN32_FIND_DATAA data;
+	const HANDLE handle = FindFirstFileA((directory + "\\*").c_str(), &data);
+	if (handle == INVALID_HANDLE_VALUE) {
+		return names;
+	}
+	do {
+		if (!(data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)) {
+			names.push_back(data.cFileName);
+		}
+	} while (FindNextFileA(handle, &data));
+	FindClose(handle);
+#else
+	DIR* dir = opendir(directory.c_str());
+	if (dir == nullptr) {
+		return names;
+	}
+	while (const dirent* entry = readdir(dir)) {
+		names.push_back(entry->d_name);
+	}
+	closedir(dir);
+#endif
+	std::vector<std::string> filenames;
+	for (const auto& name : names) {
+		if (MeshIO::toFormat(name) != MeshFormat::Unknown) {
+			filenames.push_back(directory + "/" + name);
+		}
+	}
+	std::sort(filenames.begin(), filenames.end());
+	return filenames;
+}
+
+std::string MeshBatchConverter::toOutputName(const std::string& filename) const
+{
+	const size_t slash = filename.find_last_of("/\\");
+	std::string stem = (slash == std::string::npos) ? filename : filename.substr(slash + 1);
+	const size_t dot = stem.find_last_of('.');
+	if (dot != std::string::npos) {
+		stem.erase(dot);
+	}
+	return outputDirectory + "/" + stem + MeshIO::toExtension(outputFormat);
+}
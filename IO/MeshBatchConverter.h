@@ -0,0 +1,67 @@
+#ifndef __CRYSTAL_IO_MESH_BATCH_CONVERTER_H__
+#define __CRYSTAL_IO_MESH_BATCH_CONVERTER_H__
+
+#include "MeshIO.h"
+
+#include <string>
+#include <vector>
+
+namespace Crystal {
+	namespace IO {
+
+// Converts mesh files to one format, several files at a time. Each file is read and written on a single thread, so
+// at most getThreadCount() meshes are held at once whatever the number of files.
+class MeshBatchConverter final
+{
+public:
+	struct Result
+	{
+		std::string input;
+		std::string output;
+		bool isSucceeded;
+		std::string error;
+	};
+
+	MeshBatchConverter() :
+		outputFormat(MeshFormat::PLY),
+		outputDirectory("."),
+		threadCount(0)
+	{}
+
+	~MeshBatchConverter() = default;
+
+	void setOutputFormat(const MeshFormat format) { this->outputFormat = format; }
+
+	MeshFormat getOutputFormat() const { return outputFormat; }
+
+	void setOutputDirectory(const std::string& directory) { this->outputDirectory = directory; }
+
+	std::string getOutputDirectory() const { return outputDirectory; }
+
+	// files in flight; 0: one per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	// one result per file, in the same order. Files whose output name collides with another file's output or with
+	// an input fail without being read.
+	std::vector<Result> convert(const std::vector<std::string>& filenames) const;
+
+	std::vector<Result> convertDirectory(const std::string& directory) const { return convert(listFiles(directory)); }
+
+	// files of the directory with a known mesh extension, sorted.
+	static std::vector<std::string> listFiles(const std::string& directory);
+
+	// outputDirectory/stem with the extension of the output format.
+	std::string toOutputName(const std::string& filename) const;
+
+private:
+	MeshFormat outputFormat;
+	std::string outputDirectory;
+	unsigned int threadCount;
+};
+
+	}
+}
+
+#endif
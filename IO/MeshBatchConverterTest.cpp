@@ -0,0 +1,107 @@
+#include "gtest/gtest.h"
+
+#include "MeshBatchConverter.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+TEST(MeshBatchConverterTest, TestToOutputName)
+{
+	MeshBatchConverter converter;
+	converter.setOutputDirectory("out");
+	converter.setOutputFormat(MeshFormat::STL);
+	EXPECT_EQ("out/b.stl", converter.toOutputName("a/b.obj"));
+	EXPECT_EQ("out/b.c.stl", converter.toOutputName("a\\b.c.ply"));
+	EXPECT_EQ("out/d.stl", converter.toOutputName("d"));
+}
+
+TEST(MeshBatchConverterTest, TestConvert)
+{
+	const std::vector<std::string> inputs = { "MeshBatchConverterTest0.obj", "MeshBatchConverterTest1.obj", "MeshBatchConverterTest2.obj" };
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		std::ofstream stream(inputs[i].c_str());
+		stream << "v 0 0 0" << std::endl << "v 1 0 0" << std::endl << "v 0 1 0" << std::endl << "v 1 1 0" << std::endl;
+		for (size_t f = 0; f <= i; ++f) {
+			stream << ((f % 2 == 0) ? "f 1 2 3" : "f 2 4 3") << std::endl;
+		}
+	}
+	const std::string broken = "MeshBatchConverterTest3.obj";
+	{
+		std::ofstream stream(broken.c_str());
+		stream << "f 1 2 3" << std::endl;
+	}
+	// read as PLY by its content.
+	const std::string huge = "MeshBatchConverterTest4.obj";
+	{
+		std::ofstream stream(huge.c_str());
+		stream << "ply\nformat ascii 1.0\nelement vertex 2000000000000000000\nproperty float x\nend_header\n0\n";
+	}
+
+	const auto& listed = MeshBatchConverter::listFiles(".");
+	for (const auto& input : inputs) {
+		EXPECT_NE(listed.end(), std::find(listed.begin(), listed.end(), "./" + input));
+	}
+
+	std::vector<std::string> all = inputs;
+	all.push_back(broken);
+	all.push_back(huge);
+	MeshBatchConverter converter;
+	converter.setThreadCount(2);
+	const auto& results = converter.convert(all);
+	ASSERT_EQ(5, results.size());
+	for (size_t i = 0; i < inputs.size(); ++i) {
+		EXPECT_TRUE(results[i].isSucceeded);
+		EXPECT_EQ(inputs[i], results[i].input);
+		EXPECT_EQ("./MeshBatchConverterTest" + std::to_string(i) + ".ply", results[i].output);
+		PLYFile file;
+		EXPECT_TRUE(file.read(results[i].output));
+		std::vector<size_t> offsets;
+		std::vector<unsigned int> indices;
+		EXPECT_TRUE(file.getFaces(offsets, indices));
+		EXPECT_EQ(i + 2, offsets.size());
+		std::remove(results[i].output.c_str());
+	}
+	for (size_t i = 3; i < results.size(); ++i) {
+		EXPECT_FALSE(results[i].isSucceeded);
+		EXPECT_FALSE(results[i].error.empty());
+	}
+
+	for (const auto& input : all) {
+		std::remove(input.c_str());
+	}
+}
+
+TEST(MeshBatchConverterTest, TestConvertCollisions)
+{
+	const std::vector<std::string> inputs = { "MeshBatchConverterTest.obj", "MeshBatchConverterTest.stl", "./MeshBatchConverterTest.ply", "MeshBatchConverterTest5.obj" };
+	for (const auto& input : inputs) {
+		std::ofstream stream(input.c_str());
+		stream << "v 0 0 0" << std::endl << "v 1 0 0" << std::endl << "v 0 1 0" << std::endl << "f 1 2 3" << std::endl;
+	}
+
+	MeshBatchConverter converter;
+	converter.setOutputFormat(MeshFormat::PLY);
+	const auto& results = converter.convert(inputs);
+	ASSERT_EQ(4, results.size());
+	for (size_t i = 0; i < 3; ++i) {
+		EXPECT_FALSE(results[i].isSucceeded);
+		EXPECT_FALSE(results[i].error.empty());
+	}
+	EXPECT_TRUE(results[3].isSucceeded);
+
+	// the input is left as it was.
+	std::ifstream stream(inputs[2].c_str());
+	std::string line;
+	std::getline(stream, line);
+	EXPECT_EQ("v 0 0 0", line);
+	stream.close();
+
+	for (const auto& input : inputs) {
+		std::remove(input.c_str());
+	}
+	std::remove(results[3].output.c_str());
+}
@@ -0,0 +1,231 @@
+#include "MeshConverter.h"
+
+#include "../Util/Parallel.h"
+
+#include <atomic>
+#include <algorithm>
+
+using namespace Crystal::Math;
+using namespace Crystal::Graphics;
+using namespace Crystal::IO;
+
+namespace {
+	// faces or triangles handed to a thread at a time.
+	const size_t BlockSize = 4096;
+
+	// 0 is missing and resolves to the default value; anything else must land inside the array.
+	bool toVector(const int index, const Vector3dVector<float>& values, Vector3d<float>& result)
+	{
+		const int count = static_cast<int>(values.size());
+		const int i = (index > 0) ? index - 1 : count + index;
+		if (index == 0) {
+			result = Vector3d<float>();
+			return true;
+		}
+		if (i < 0 || i >= count) {
+			return false;
+		}
+		result = values[i];
+		return true;
+	}
+
+	bool addFace(const OBJFace& face, const Vector3dVector<float>& positions, const Vector3dVector<float>& texCoords, const Vector3dVector<float>& normals, MeshWelder<float>& welder)
+	{
+		const auto& vs = face.getVertexIndices();
+		const auto& ts = face.getTexIndices();
+		const auto& ns = face.getNormalIndices();
+		for (size_t i = 1; i + 1 < vs.size(); ++i) {
+			const size_t corners[] = { 0, i, i + 1 };
+			for (const auto c : corners) {
+				Vector3d<float> p;
+				Vector3d<float> t;
+				Vector3d<float> n;
+				if (vs[c] == 0 ||
+					!toVector(vs[c], positions, p) ||
+					!toVector(c < ts.size() ? ts[c] : 0, texCoords, t) ||
+					!toVector(c < ns.size() ? ns[c] : 0, normals, n)) {
+					return false;
+				}
+				welder.add(p, n, t);
+			}
+		}
+		return true;
+	}
+}
+
+bool MeshConverter::convert(const OBJFile& file)
+{
+	mesh.clear();
+	MeshWelder<float> welder;
+	for (const auto& g : file.getGroups()) {
+		const auto& faces = g->getFaces();
+		const auto& positions = g->getPositions();
+		const auto& texCoords = g->getTexCoords();
+		const auto& normals = g->getNormals();
+		for (const auto& f : faces) {
+			if (!addFace(f, positions, texCoords, normals, welder)) {
+				return false;
+			}
+		}
+	}
+	mesh = welder.weld(threadCount);
+	return true;
+}
+
+// faces are triangulated in parallel into corner slots found by a prefix sum over their triangle counts.
+// a negative index left by the reader counts back from what was read before its face, which is unknown here, so it fails.
+bool MeshConverter::convert(const OBJFastReader& reader)
+{
+	mesh.clear();
+	const auto& offsets = reader.getFaceOffsets();
+	const size_t faceCount = reader.getFaceCount();
+	std::vector<size_t> firstCorners(faceCount + 1, 0);
+	for (size_t f = 0; f < faceCount; ++f) {
+		const size_t cornerCount = offsets[f + 1] - offsets[f];
+		firstCorners[f + 1] = firstCorners[f] + ((cornerCount < 3) ? 0 : (cornerCount - 2) * 3);
+	}
+
+	MeshWelder<float> welder;
+	welder.resize(firstCorners.back());
+	std::atomic<bool> isValid(true);
+	Util::parallelForBlocks(faceCount, BlockSize, [&](const size_t first, const size_t last) {
+		for (size_t f = first; f < last; ++f) {
+			size_t corner = firstCorners[f];
+			for (size_t i = offsets[f] + 1; i + 1 < offsets[f + 1]; ++i) {
+				const size_t cs[] = { offsets[f], i, i + 1 };
+				for (const auto c : cs) {
+					Vector3d<float> p;
+					Vector3d<float> t;
+					Vector3d<float> n;
+					if (reader.getVertexIndices()[c] <= 0 || reader.getTexIndices()[c] < 0 || reader.getNormalIndices()[c] < 0 ||
+						!toVector(reader.getVertexIndices()[c], reader.getPositions(), p) ||
+						!toVector(reader.getTexIndices()[c], reader.getTexCoords(), t) ||
+						!toVector(reader.getNormalIndices()[c], reader.getNormals(), n)) {
+						isValid = false;
+						return;
+					}
+					welder.set(corner++, p, n, t);
+				}
+			}
+		}
+	}, threadCount);
+	if (!isValid) {
+		return false;
+	}
+	mesh = welder.weld(threadCount);
+	return true;
+}
+
+bool MeshConverter::convert(const STLFile& file)
+{
+	mesh.clear();
+	MeshWelder<float> welder;
+	const auto& cells = file.getCells();
+	welder.reserve(cells.size() * 3);
+	for (const auto& c : cells) {
+		const auto& positions = c.getPositions();
+		for (size_t i = 1; i + 1 < positions.size(); ++i) {
+			welder.add(positions[0], c.getNormal(), Vector3d<float>());
+			welder.add(positions[i], c.getNormal(), Vector3d<float>());
+			welder.add(positions[i + 1], c.getNormal(), Vector3d<float>());
+		}
+	}
+	mesh = welder.weld(threadCount);
+	return true;
+}
+
+bool MeshConverter::convert(const STLBinaryFile& file)
+{
+	mesh.clear();
+	const auto& normals = file.getNormals();
+	const auto& positions = file.getPositions();
+	MeshWelder<float> welder;
+	welder.resize(positions.size());
+	Util::parallelForBlocks(normals.size(), BlockSize, [&](const size_t first, const size_t last) {
+		for (size_t i = first; i < last; ++i) {
+			for (size_t c = i * 3; c < i * 3 + 3; ++c) {
+				welder.set(c, positions[c], normals[i], Vector3d<float>());
+			}
+		}
+	}, threadCount);
+	mesh = welder.weld(threadCount);
+	return true;
+}
+
+bool MeshConverter::convert(const PLYFile& file)
+{
+	mesh.clear();
+	std::vector<size_t> offsets;
+	std::vector<unsigned int> indices;
+	if (!file.getFaces(offsets, indices)) {
+		return false;
+	}
+	const auto& positions = file.getPositions();
+	const auto& normals = file.getNormals();
+	std::vector<float> us;
+	std::vector<float> vs;
+	if (!file.getProperty("vertex", "u", us) || !file.getProperty("vertex", "v", vs)) {
+		if (!file.getProperty("vertex", "s", us) || !file.getProperty("vertex", "t", vs)) {
+			us.clear();
+			vs.clear();
+		}
+	}
+
+	const size_t faceCount = offsets.size() - 1;
+	std::vector<size_t> firstCorners(faceCount + 1, 0);
+	for (size_t f = 0; f < faceCount; ++f) {
+		const size_t cornerCount = offsets[f + 1] - offsets[f];
+		firstCorners[f + 1] = firstCorners[f] + ((cornerCount < 3) ? 0 : (cornerCount - 2) * 3);
+	}
+
+	MeshWelder<float> welder;
+	welder.resize(firstCorners.back());
+	std::atomic<bool> isValid(true);
+	Util::parallelForBlocks(faceCount, BlockSize, [&](const size_t first, const size_t last) {
+		for (size_t f = first; f < last; ++f) {
+			size_t corner = firstCorners[f];
+			for (size_t i = offsets[f] + 1; i + 1 < offsets[f + 1]; ++i) {
+				const size_t cs[] = { offsets[f], i, i + 1 };
+				for (const auto c : cs) {
+					const unsigned int v = indices[c];
+					if (v >= positions.size()) {
+						isValid = false;
+						return;
+					}
+					const Vector3d<float>& n = normals.empty() ? Vector3d<float>() : normals[v];
+					const Vector3d<float>& t = us.empty() ? Vector3d<float>() : Vector3d<float>(us[v], vs[v], 0.0f);
+					welder.set(corner++, positions[v], n, t);
+				}
+			}
+		}
+	}, threadCount);
+	if (!isValid) {
+		return false;
+	}
+	mesh = welder.weld(threadCount);
+	return true;
+}
+
+bool MeshConverter::convert(const DXFReader& reader)
+{
+	mesh.clear();
+	const auto& positions = reader.getTrianglePositions();
+	MeshWelder<float> welder;
+	welder.resize(positions.size());
+	Util::parallelForBlocks(reader.getTriangleCount(), BlockSize, [&](const size_t first, const size_t last) {
+		for (size_t i = first; i < last; ++i) {
+			const auto& v0 = positions[i * 3];
+			const auto& v1 = positions[i * 3 + 1];
+			const auto& v2 = positions[i * 3 + 2];
+			Vector3d<float> normal = (v1 - v0).getOuterProduct(v2 - v0);
+			if (normal.getLengthSquared() > 0.0f) {
+				normal.normalize();
+			}
+			for (size_t c = i * 3; c < i * 3 + 3; ++c) {
+				welder.set(c, positions[c], normal, Vector3d<float>());
+			}
+		}
+	}, threadCount);
+	mesh = welder.weld(threadCount);
+	return true;
+}
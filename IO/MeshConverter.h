@@ -0,0 +1,60 @@
+#ifndef __CRYSTAL_IO_MESH_CONVERTER_H__
+#define __CRYSTAL_IO_MESH_CONVERTER_H__
+
+#include "OBJFile.h"
+#include "OBJFastReader.h"
+#include "STLFile.h"
+#include "STLBinaryFile.h"
+#include "PLYFile.h"
+#include "DXFReader.h"
+#include "../Math/IndexedMesh.h"
+#include "../Graphics/MeshWelder.h"
+
+namespace Crystal {
+	namespace IO {
+
+// Turns file contents into an indexed triangle mesh. Polygons are fan-triangulated and corners with the same
+// position, normal and texcoord are welded into one vertex; missing normals and texcoords are zero.
+// OBJ indices are 1-based. Negative ones in an OBJFile count back from the end of the group's arrays; an OBJFastReader
+// must resolve them while reading (setResolvesRelativeIndices(true)).
+class MeshConverter final
+{
+public:
+	MeshConverter() :
+		threadCount(0)
+	{}
+
+	~MeshConverter() = default;
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	// false on an index out of range.
+	bool convert(const OBJFile& file);
+
+	bool convert(const OBJFastReader& reader);
+
+	// uses the facet normal for every corner.
+	bool convert(const STLFile& file);
+
+	bool convert(const STLBinaryFile& file);
+
+	// "face" lists index the "vertex" element, which gives x, y, z and optionally nx, ny, nz and u, v (or s, t).
+	bool convert(const PLYFile& file);
+
+	// uses the face normal of each triangle for its corners; segments are not part of the mesh.
+	bool convert(const DXFReader& reader);
+
+	const Math::IndexedMesh<float>& getMesh() const { return mesh; }
+
+private:
+	unsigned int threadCount;
+	Math::IndexedMesh<float> mesh;
+};
+
+	}
+}
+
+#endif
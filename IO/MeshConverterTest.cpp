@@ -0,0 +1,175 @@
+#include "gtest/gtest.h"
+
+#include "MeshConverter.h"
+
+#include <sstream>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class MeshConverterTest : public testing::Test {
+protected:
+	MeshConverterTest()
+	{
+		std::stringstream stream;
+		stream
+			<< "v 0 0 0" << std::endl
+			<< "v 1 0 0" << std::endl
+			<< "v 1 1 0" << std::endl
+			<< "v 0 1 0" << std::endl
+			<< "v 0 0 1" << std::endl
+			<< "vt 0 0" << std::endl
+			<< "vt 1 1" << std::endl
+			<< "vn 0 0 -1" << std::endl
+			<< "f 1/1/1 2/1/1 3/2/1 4/2/1" << std::endl
+			<< "f 1 2 -1" << std::endl
+			<< "f 1 5 2" << std::endl;
+		cubeFaceText = stream.str();
+	}
+
+	std::string cubeFaceText;
+};
+
+TEST_F(MeshConverterTest, TestConvertOBJFile)
+{
+	std::stringstream stream(cubeFaceText);
+	const OBJFile& file = OBJFileReader().read(stream);
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(file));
+	const auto& mesh = converter.getMesh();
+	EXPECT_EQ(4, mesh.getTriangleCount());
+	// the quad's 4 corners, then 1, 2 and 5 without normals or texcoords.
+	EXPECT_EQ(7, mesh.getVertexCount());
+	const std::vector<unsigned int> expected = { 0, 1, 2, 0, 2, 3, 4, 5, 6, 4, 6, 5 };
+	EXPECT_EQ(expected, mesh.getIndices());
+	EXPECT_EQ(Vector3d<float>(0, 0, -1), mesh.getNormals()[0]);
+	EXPECT_EQ(Vector3d<float>(1, 1, 0), mesh.getTexCoords()[2]);
+	EXPECT_EQ(Vector3d<float>(0, 0, 1), mesh.getPositions()[6]);
+}
+
+TEST_F(MeshConverterTest, TestConvertOBJFastReader)
+{
+	std::stringstream stream(cubeFaceText);
+	const OBJFile& file = OBJFileReader().read(stream);
+	MeshConverter expected;
+	EXPECT_TRUE(expected.convert(file));
+
+	const std::string& str = cubeFaceText;
+	OBJFastReader reader;
+	reader.setResolvesRelativeIndices(true);
+	EXPECT_TRUE(reader.read(str.data(), str.data() + str.size()));
+	MeshConverter converter;
+	converter.setThreadCount(4);
+	EXPECT_TRUE(converter.convert(reader));
+	EXPECT_EQ(expected.getMesh(), converter.getMesh());
+}
+
+TEST_F(MeshConverterTest, TestConvertRelativeIndices)
+{
+	// -1 is the vertex just read, not the last one of the file.
+	const std::string str = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 0 0 1\nv 1 0 1\nv 0 1 1\nf -3 -2 -1\n";
+	OBJFastReader reader;
+	reader.setResolvesRelativeIndices(true);
+	reader.setChunkSize(8);
+	EXPECT_TRUE(reader.read(str.data(), str.data() + str.size()));
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(reader));
+	const auto& mesh = converter.getMesh();
+	ASSERT_EQ(6, mesh.getVertexCount());
+	const auto& positions = mesh.getPositions();
+	const auto& indices = mesh.getIndices();
+	EXPECT_EQ(Vector3d<float>(0, 0, 0), positions[indices[0]]);
+	EXPECT_EQ(Vector3d<float>(0, 1, 0), positions[indices[2]]);
+	EXPECT_EQ(Vector3d<float>(0, 0, 1), positions[indices[3]]);
+	EXPECT_EQ(Vector3d<float>(0, 1, 1), positions[indices[5]]);
+
+	OBJFastReader unresolved;
+	EXPECT_TRUE(unresolved.read(str.data(), str.data() + str.size()));
+	EXPECT_FALSE(converter.convert(unresolved));
+}
+
+TEST_F(MeshConverterTest, TestConvertInvalid)
+{
+	const std::string str = "v 0 0 0\nf 1 1 2\n";
+	OBJFastReader reader;
+	EXPECT_TRUE(reader.read(str.data(), str.data() + str.size()));
+	MeshConverter converter;
+	EXPECT_FALSE(converter.convert(reader));
+
+	std::stringstream stream(str);
+	EXPECT_FALSE(converter.convert(OBJFileReader().read(stream)));
+}
+
+TEST_F(MeshConverterTest, TestConvertSTLFile)
+{
+	const Vector3d<float> normal(0, 0, 1);
+	const STLCellVector cells = {
+		STLCell({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0) }, normal),
+		STLCell({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) }, normal)
+	};
+	STLFile file;
+	file.setCells(cells);
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(file));
+	EXPECT_EQ(4, converter.getMesh().getVertexCount());
+	EXPECT_EQ(2, converter.getMesh().getTriangleCount());
+	const std::vector<unsigned int> expected = { 0, 1, 2, 0, 2, 3 };
+	EXPECT_EQ(expected, converter.getMesh().getIndices());
+}
+
+TEST_F(MeshConverterTest, TestConvertSTLBinaryFile)
+{
+	const Vector3d<float> normal(0, 0, 1);
+	const STLCellVector cells = {
+		STLCell({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0) }, normal),
+		STLCell({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) }, normal)
+	};
+	STLFile legacy;
+	legacy.setCells(cells);
+	MeshConverter expected;
+	EXPECT_TRUE(expected.convert(legacy));
+
+	STLBinaryFile file;
+	file.setCells(cells);
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(file));
+	EXPECT_EQ(expected.getMesh(), converter.getMesh());
+}
+
+TEST_F(MeshConverterTest, TestConvertPLYFile)
+{
+	PLYFile file;
+	file.setPositions({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) });
+	file.setNormals(Vector3dVector<float>(4, Vector3d<float>(0, 0, 1)));
+	file.setProperty("vertex", "u", std::vector<float>{ 0, 1, 1, 0 });
+	file.setProperty("vertex", "v", std::vector<float>{ 0, 0, 1, 1 });
+	file.setFaces({ 0, 4 }, { 0, 1, 2, 3 });
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(file));
+	const auto& mesh = converter.getMesh();
+	EXPECT_EQ(4, mesh.getVertexCount());
+	EXPECT_EQ(std::vector<unsigned int>({ 0, 1, 2, 0, 2, 3 }), mesh.getIndices());
+	EXPECT_EQ(Vector3d<float>(0, 0, 1), mesh.getNormals()[2]);
+	EXPECT_EQ(Vector3d<float>(1, 1, 0), mesh.getTexCoords()[2]);
+
+	file.setFaces({ 0, 3 }, { 0, 1, 4 });
+	EXPECT_FALSE(converter.convert(file));
+	EXPECT_FALSE(converter.convert(PLYFile()));
+}
+
+TEST_F(MeshConverterTest, TestConvertDXFReader)
+{
+	std::stringstream stream;
+	stream
+		<< "0\nSECTION\n2\nENTITIES\n0\n3DFACE\n"
+		<< "10\n0\n20\n0\n30\n0\n11\n1\n21\n0\n31\n0\n12\n1\n22\n1\n32\n0\n13\n0\n23\n1\n33\n0\n"
+		<< "0\nENDSEC\n0\nEOF\n";
+	DXFReader reader;
+	EXPECT_TRUE(reader.read(stream));
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(reader));
+	const auto& mesh = converter.getMesh();
+	EXPECT_EQ(4, mesh.getVertexCount());
+	EXPECT_EQ(2, mesh.getTriangleCount());
+	EXPECT_EQ(Vector3d<float>(0, 0, 1), mesh.getNormals()[0]);
+}
@@ -0,0 +1,301 @@
+#include "MeshIO.h"
+
+#include "OBJFastReader.h"
+#include "OBJFastWriter.h"
+#include "STLASCIIReader.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	const size_t HeadSize = 512;
+
+	bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+	// the next line of [p, end) without its break and surrounding blanks.
+	std::string toTrimmedLine(const char*& p, const char* end)
+	{
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		const char* b = p;
+		const char* e = lineEnd;
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+		while (b < e && isSpace(*b)) {
+			++b;
+		}
+		while (e > b && isSpace(e[-1])) {
+			--e;
+		}
+		return std::string(b, e);
+	}
+
+	bool startsWith(const std::string& s, const char* prefix)
+	{
+		return s.compare(0, std::strlen(prefix), prefix) == 0;
+	}
+
+	Vector3d<float> toNormal(const Vector3d<float>& v0, const Vector3d<float>& v1, const Vector3d<float>& v2)
+	{
+		Vector3d<float> normal = (v1 - v0).getOuterProduct(v2 - v0);
+		if (normal.getLengthSquared() > 0.0f) {
+			normal.normalize();
+		}
+		return normal;
+	}
+
+	bool writeOBJ(const std::string& filename, const IndexedMesh<float>& mesh, const unsigned int threadCount)
+	{
+		const auto& indices = mesh.getIndices();
+		const bool hasTexCoords = mesh.getTexCoords().size() == mesh.getVertexCount();
+		const bool hasNormals = mesh.getNormals().size() == mesh.getVertexCount();
+		std::vector<OBJFace> faces(mesh.getTriangleCount());
+		for (size_t i = 0; i < faces.size(); ++i) {
+			const OBJIndices is = {
+				static_cast<int>(indices[i * 3] + 1),
+				static_cast<int>(indices[i * 3 + 1] + 1),
+				static_cast<int>(indices[i * 3 + 2] + 1)
+			};
+			faces[i] = OBJFace(is, hasTexCoords ? is : OBJIndices(), hasNormals ? is : OBJIndices());
+		}
+		const auto group = std::make_shared<OBJGroup>("mesh", faces);
+		group->setPositions(mesh.getPositions());
+		group->setTexCoords(mesh.getTexCoords());
+		group->setNormals(mesh.getNormals());
+		OBJFile file;
+		file.setGroups({ group });
+		OBJFastWriter writer;
+		writer.setThreadCount(threadCount);
+		return writer.write(filename, file);
+	}
+
+	bool writeSTL(const std::string& filename, const IndexedMesh<float>& mesh, const unsigned int threadCount)
+	{
+		const auto& positions = mesh.getPositions();
+		const auto& indices = mesh.getIndices();
+		Vector3dVector<float> normals(mesh.getTriangleCount());
+		Vector3dVector<float> corners(indices.size());
+		for (size_t i = 0; i < normals.size(); ++i) {
+			for (size_t c = i * 3; c < i * 3 + 3; ++c) {
+				corners[c] = positions[indices[c]];
+			}
+			normals[i] = toNormal(corners[i * 3], corners[i * 3 + 1], corners[i * 3 + 2]);
+		}
+		STLBinaryFile file;
+		file.setThreadCount(threadCount);
+		file.setTriangles(normals, corners);
+		return file.write(filename);
+	}
+
+	bool writePLY(const std::string& filename, const IndexedMesh<float>& mesh, const unsigned int threadCount)
+	{
+		PLYFile file;
+		file.setThreadCount(threadCount);
+		file.setPositions(mesh.getPositions());
+		if (mesh.getNormals().size() == mesh.getVertexCount()) {
+			file.setNormals(mesh.getNormals());
+		}
+		if (mesh.getTexCoords().size() == mesh.getVertexCount()) {
+			std::vector<float> us(mesh.getVertexCount());
+			std::vector<float> vs(mesh.getVertexCount());
+			for (size_t i = 0; i < us.size(); ++i) {
+				us[i] = mesh.getTexCoords()[i].getX();
+				vs[i] = mesh.getTexCoords()[i].getY();
+			}
+			file.setProperty("vertex", "u", us);
+			file.setProperty("vertex", "v", vs);
+		}
+		std::vector<size_t> offsets(mesh.getTriangleCount() + 1);
+		for (size_t i = 0; i < offsets.size(); ++i) {
+			offsets[i] = i * 3;
+		}
+		file.setFaces(offsets, mesh.getIndices());
+		return file.write(filename);
+	}
+
+	bool writeDXF(const std::string& filename, const IndexedMesh<float>& mesh)
+	{
+		const auto& positions = mesh.getPositions();
+		const auto& indices = mesh.getIndices();
+		DXFFaceVector faces(mesh.getTriangleCount());
+		for (size_t i = 0; i < faces.size(); ++i) {
+			const auto& v2 = positions[indices[i * 3 + 2]];
+			faces[i].setPositions({ positions[indices[i * 3]], positions[indices[i * 3 + 1]], v2, v2 });
+			faces[i].setLayerName("0");
+			faces[i].setColorNumber(256);
+		}
+		std::ofstream stream(filename.c_str());
+		if (!stream.is_open()) {
+			return false;
+		}
+		DXFFile file;
+		file.setFaces(faces);
+		file.write(stream);
+		return stream.good();
+	}
+}
+
+bool MeshIO::read(const std::string& filename, const MeshFormat format)
+{
+	error.clear();
+	this->format = (format == MeshFormat::Unknown) ? detect(filename) : format;
+	converter.setThreadCount(threadCount);
+	bool isRead = false;
+	switch (this->format) {
+	case MeshFormat::OBJ: {
+		OBJFastReader reader;
+		reader.setThreadCount(threadCount);
+		reader.setResolvesRelativeIndices(true);
+		isRead = reader.read(filename) && converter.convert(reader);
+		break;
+	}
+	case MeshFormat::STL: {
+		STLBinaryFile file;
+		file.setThreadCount(threadCount);
+		if (!file.read(filename)) {
+			STLASCIIReader reader;
+			if (!reader.read(filename)) {
+				error = filename + ": " + reader.getError();
+				return false;
+			}
+			file.setTriangles(reader.getNormals(), reader.getPositions());
+		}
+		isRead = converter.convert(file);
+		break;
+	}
+	case MeshFormat::PLY: {
+		PLYFile file;
+		file.setThreadCount(threadCount);
+		isRead = file.read(filename) && converter.convert(file);
+		break;
+	}
+	case MeshFormat::DXF: {
+		DXFReader reader;
+		if (!reader.read(filename)) {
+			error = filename + ": " + reader.getError();
+			return false;
+		}
+		isRead = converter.convert(reader);
+		break;
+	}
+	default:
+		error = filename + ": unknown format";
+		return false;
+	}
+	if (!isRead) {
+		error = filename + ": cannot read";
+		return false;
+	}
+	if (getMesh().getTriangleCount() == 0) {
+		error = filename + ": no triangles";
+		return false;
+	}
+	return true;
+}
+
+bool MeshIO::write(const std::string& filename, const IndexedMesh<float>& mesh, const MeshFormat format) const
+{
+	switch ((format == MeshFormat::Unknown) ? toFormat(filename) : format) {
+	case MeshFormat::OBJ:
+		return writeOBJ(filename, mesh, threadCount);
+	case MeshFormat::STL:
+		return writeSTL(filename, mesh, threadCount);
+	case MeshFormat::PLY:
+		return writePLY(filename, mesh, threadCount);
+	case MeshFormat::DXF:
+		return writeDXF(filename, mesh);
+	default:
+		return false;
+	}
+}
+
+MeshFormat MeshIO::detect(const std::string& filename)
+{
+	std::ifstream stream(filename.c_str(), std::ios::binary | std::ios::ate);
+	if (!stream.is_open()) {
+		return toFormat(filename);
+	}
+	const size_t fileSize = static_cast<size_t>(stream.tellg());
+	stream.seekg(0);
+	char head[HeadSize];
+	stream.read(head, std::min(HeadSize, fileSize));
+	const MeshFormat format = detect(head, head + stream.gcount(), fileSize);
+	return (format == MeshFormat::Unknown) ? toFormat(filename) : format;
+}
+
+MeshFormat MeshIO::detect(const char* begin, const char* end, const size_t fileSize)
+{
+	// binary STL may start with "solid" too, so its exact size is checked first.
+	const size_t headSize = end - begin;
+	if (headSize >= STLBinaryFile::HeaderSize + 4) {
+		unsigned char count[4];
+		std::memcpy(count, begin + STLBinaryFile::HeaderSize, 4);
+		const size_t triangleCount = count[0] | (count[1] << 8) | (count[2] << 16) | (static_cast<size_t>(count[3]) << 24);
+		if (fileSize == STLBinaryFile::HeaderSize + 4 + triangleCount * sizeof(STLRecord)) {
+			return MeshFormat::STL;
+		}
+	}
+
+	const char* p = begin;
+	const std::string first = toTrimmedLine(p, end);
+	if (first == "ply") {
+		return MeshFormat::PLY;
+	}
+	std::string lower(first);
+	std::transform(lower.begin(), lower.end(), lower.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+	if (lower == "solid" || startsWith(lower, "solid ")) {
+		return MeshFormat::STL;
+	}
+	if ((first == "0" && toTrimmedLine(p, end) == "SECTION") || first == "999") {
+		return MeshFormat::DXF;
+	}
+
+	static const char* objKeywords[] = { "v ", "vt ", "vn ", "f ", "g ", "o ", "s ", "mtllib ", "usemtl " };
+	p = begin;
+	while (p < end) {
+		const std::string line = toTrimmedLine(p, end) + " ";
+		if (line == " " || line[0] == '#') {
+			continue;
+		}
+		for (const auto keyword : objKeywords) {
+			if (startsWith(line, keyword)) {
+				return MeshFormat::OBJ;
+			}
+		}
+		break;
+	}
+	return MeshFormat::Unknown;
+}
+
+MeshFormat MeshIO::toFormat(const std::string& filename)
+{
+	const size_t dot = filename.find_last_of('.');
+	if (dot == std::string::npos) {
+		return MeshFormat::Unknown;
+	}
+	std::string extension = filename.substr(dot);
+	std::transform(extension.begin(), extension.end(), extension.begin(), [](const char c) { return static_cast<char>(std::tolower(static_cast<unsigned char>(c))); });
+	for (const auto format : { MeshFormat::OBJ, MeshFormat::STL, MeshFormat::PLY, MeshFormat::DXF }) {
+		if (extension == toExtension(format)) {
+			return format;
+		}
+	}
+	return MeshFormat::Unknown;
+}
+
+std::string MeshIO::toExtension(const MeshFormat format)
+{
+	switch (format) {
+	case MeshFormat::OBJ: return ".obj";
+	case MeshFormat::STL: return ".stl";
+	case MeshFormat::PLY: return ".ply";
+	case MeshFormat::DXF: return ".dxf";
+	default: return "";
+	}
+}
@@ -0,0 +1,74 @@
+#ifndef __CRYSTAL_IO_MESH_IO_H__
+#define __CRYSTAL_IO_MESH_IO_H__
+
+#include "MeshConverter.h"
+
+#include <string>
+#include <vector>
+
+namespace Crystal {
+	namespace IO {
+
+enum class MeshFormat
+{
+	Unknown,
+	OBJ,
+	STL,
+	PLY,
+	DXF,
+};
+
+// One front-end for every mesh format: files are read through the fastest reader of their format into an
+// IndexedMesh and written from one. The format comes from the leading bytes when they are conclusive and from the
+// extension otherwise.
+class MeshIO final
+{
+public:
+	MeshIO() :
+		threadCount(0),
+		format(MeshFormat::Unknown)
+	{}
+
+	~MeshIO() = default;
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	// Unknown: detected. false also when the file holds no triangles.
+	bool read(const std::string& filename, const MeshFormat format = MeshFormat::Unknown);
+
+	const Math::IndexedMesh<float>& getMesh() const { return converter.getMesh(); }
+
+	// format of the last read.
+	MeshFormat getFormat() const { return format; }
+
+	// Unknown: from the extension. STL is written binary, PLY binary little-endian.
+	bool write(const std::string& filename, const Math::IndexedMesh<float>& mesh, const MeshFormat format = MeshFormat::Unknown) const;
+
+	// the reason of the last failed read, empty otherwise.
+	std::string getError() const { return error; }
+
+	static MeshFormat detect(const std::string& filename);
+
+	// from the leading bytes of a file of fileSize bytes; Unknown when they are not conclusive.
+	static MeshFormat detect(const char* begin, const char* end, const size_t fileSize);
+
+	// from the extension, ignoring case.
+	static MeshFormat toFormat(const std::string& filename);
+
+	// ".obj", ".stl", ".ply" or ".dxf".
+	static std::string toExtension(const MeshFormat format);
+
+private:
+	unsigned int threadCount;
+	MeshConverter converter;
+	MeshFormat format;
+	std::string error;
+};
+
+	}
+}
+
+#endif
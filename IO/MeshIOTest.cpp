@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+
+#include "MeshIO.h"
+
+#include <fstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class MeshIOTest : public testing::Test {
+protected:
+	static void writeText(const std::string& filename, const std::string& text)
+	{
+		std::ofstream stream(filename.c_str(), std::ios::binary);
+		stream << text;
+	}
+};
+
+TEST_F(MeshIOTest, TestToFormat)
+{
+	EXPECT_EQ(MeshFormat::OBJ, MeshIO::toFormat("a/b.OBJ"));
+	EXPECT_EQ(MeshFormat::STL, MeshIO::toFormat("b.stl"));
+	EXPECT_EQ(MeshFormat::PLY, MeshIO::toFormat("c.d.Ply"));
+	EXPECT_EQ(MeshFormat::DXF, MeshIO::toFormat("e.dxf"));
+	EXPECT_EQ(MeshFormat::Unknown, MeshIO::toFormat("f.txt"));
+	EXPECT_EQ(MeshFormat::Unknown, MeshIO::toFormat("obj"));
+	EXPECT_EQ(".ply", MeshIO::toExtension(MeshFormat::PLY));
+}
+
+TEST_F(MeshIOTest, TestDetect)
+{
+	const auto detect = [](const std::string& s) { return MeshIO::detect(s.data(), s.data() + s.size(), s.size()); };
+	EXPECT_EQ(MeshFormat::PLY, detect("ply\r\nformat ascii 1.0\r\n"));
+	EXPECT_EQ(MeshFormat::STL, detect("  Solid part\nfacet normal 0 0 1\n"));
+	EXPECT_EQ(MeshFormat::DXF, detect("  0\nSECTION\n  2\nENTITIES\n"));
+	EXPECT_EQ(MeshFormat::DXF, detect("999\ncomment\n"));
+	EXPECT_EQ(MeshFormat::OBJ, detect("# comment\n\nmtllib a.mtl\nv 0 0 0\n"));
+	EXPECT_EQ(MeshFormat::OBJ, detect("v 0 0 0\n"));
+	EXPECT_EQ(MeshFormat::Unknown, detect("vertex 0 0 0\n"));
+	EXPECT_EQ(MeshFormat::Unknown, detect(""));
+
+	// a binary header that starts with "solid" is still binary when the size matches the triangle count.
+	std::string binary(84 + 50 * 2, '\0');
+	binary.replace(0, 5, "solid");
+	binary[80] = 2;
+	EXPECT_EQ(MeshFormat::STL, detect(binary));
+	EXPECT_EQ(MeshFormat::STL, MeshIO::detect(binary.data(), binary.data() + 84, binary.size()));
+}
+
+TEST_F(MeshIOTest, TestReadWrite)
+{
+	// two triangles of a unit square.
+	PLYFile file;
+	file.setPositions({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) });
+	file.setNormals({ Vector3d<float>(0, 0, 1), Vector3d<float>(0, 0, 1), Vector3d<float>(0, 0, 1), Vector3d<float>(0, 0, 1) });
+	file.setFaces({ 0, 3, 6 }, { 0, 1, 2, 0, 2, 3 });
+	MeshConverter converter;
+	EXPECT_TRUE(converter.convert(file));
+	const IndexedMesh<float>& square = converter.getMesh();
+	for (const auto format : { MeshFormat::OBJ, MeshFormat::STL, MeshFormat::PLY, MeshFormat::DXF }) {
+		const std::string filename = "MeshIOTest" + MeshIO::toExtension(format);
+		SCOPED_TRACE(filename);
+		MeshIO io;
+		EXPECT_TRUE(io.write(filename, square));
+		EXPECT_TRUE(io.read(filename));
+		EXPECT_EQ(format, io.getFormat());
+		EXPECT_EQ(2, io.getMesh().getTriangleCount());
+		EXPECT_EQ(4, io.getMesh().getVertexCount());
+		for (const auto& n : io.getMesh().getNormals()) {
+			EXPECT_EQ(Vector3d<float>(0, 0, 1), n);
+		}
+		std::remove(filename.c_str());
+	}
+}
+
+TEST_F(MeshIOTest, TestReadByContent)
+{
+	// the extension is wrong on purpose.
+	const std::string filename = "MeshIOTest.obj";
+	writeText(filename, "ply\nformat ascii 1.0\nelement vertex 3\nproperty float x\nproperty float y\nproperty float z\n"
+		"element face 1\nproperty list uchar int vertex_indices\nend_header\n0 0 0\n1 0 0\n0 1 0\n3 0 1 2\n");
+	MeshIO io;
+	EXPECT_TRUE(io.read(filename));
+	EXPECT_EQ(MeshFormat::PLY, io.getFormat());
+	EXPECT_EQ(1, io.getMesh().getTriangleCount());
+
+	writeText(filename, "solid t\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nvertex 1 0 0\nvertex 0 1 0\nendloop\nendfacet\nendsolid t\n");
+	EXPECT_TRUE(io.read(filename));
+	EXPECT_EQ(MeshFormat::STL, io.getFormat());
+	EXPECT_EQ(1, io.getMesh().getTriangleCount());
+
+	writeText(filename, "solid t\nfacet normal 0 0 x\n");
+	EXPECT_FALSE(io.read(filename));
+	EXPECT_EQ(filename + ": 2:", io.getError().substr(0, filename.size() + 4));
+
+	writeText(filename, "not a mesh\n");
+	EXPECT_FALSE(io.read(filename));
+	EXPECT_FALSE(io.getError().empty());
+	std::remove(filename.c_str());
+
+	EXPECT_FALSE(io.read("MeshIOTest.txt"));
+	EXPECT_EQ(MeshFormat::Unknown, io.getFormat());
+}
+
+TEST_F(MeshIOTest, TestReadRelativeIndices)
+{
+	// the second face refers to the second vertex block.
+	const std::string filename = "MeshIOTest.obj";
+	writeText(filename, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\nv 0 0 1\nv 1 0 1\nv 0 1 1\nf -3 -2 -1\n");
+	MeshIO io;
+	EXPECT_TRUE(io.read(filename));
+	std::remove(filename.c_str());
+	const auto& mesh = io.getMesh();
+	ASSERT_EQ(2, mesh.getTriangleCount());
+	for (size_t i = 0; i < 6; ++i) {
+		EXPECT_EQ((i < 3) ? 0.0f : 1.0f, mesh.getPositions()[mesh.getIndices()[i]].getZ());
+	}
+}
@@ -0,0 +1,430 @@
+#include "OBJFastReader.h"
+
+#include "MappedFile.h"
+#include "TextScanner.h"
+#include "../Util/Parallel.h"
+
+#include <cstring>
+#include <iterator>
+#include <algorithm>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+	const char* skipSpaces(const char* p, const char* end)
+	{
+		while (p < end && isSpace(*p)) {
+			++p;
+		}
+		return p;
+	}
+
+	// true when the line starts with the keyword followed by a space or the end of the line.
+	bool isKeyword(const char* p, const char* end, const char* keyword)
+	{
+		const size_t length = std::strlen(keyword);
+		return
+			static_cast<size_t>(end - p) >= length &&
+			std::memcmp(p, keyword, length) == 0 &&
+			(p + length == end || isSpace(p[length]));
+	}
+
+	std::string toTrimmed(const char* p, const char* end)
+	{
+		p = skipSpaces(p, end);
+		while (end > p && isSpace(end[-1])) {
+			--end;
+		}
+		return std::string(p, end);
+	}
+
+	// reads up to count floats separated by spaces. returns how many were read.
+	int readFloats(const char* p, const char* end, float* values, const int count)
+	{
+		int n = 0;
+		for (p = skipSpaces(p, end); p < end && n < count; p = skipSpaces(p, end)) {
+			if (!TextScanner::parseFloat(p, end, values[n]) || (p < end && !isSpace(*p))) {
+				return -1;
+			}
+			++n;
+		}
+		return n;
+	}
+}
+
+bool OBJFastReader::read(const std::string& filename)
+{
+	MappedFile file;
+	if (!file.open(filename)) {
+		return false;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.getData());
+	return read(begin, begin + file.getSize());
+}
+
+bool OBJFastReader::read(std::istream& stream)
+{
+	const std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return read(buffer.data(), buffer.data() + buffer.size());
+}
+
+// one line-aligned slice of the input and everything parsed from it. face ends, group and material face positions,
+// snapshots and resolved relative indices are all local to the chunk until merge() offsets them.
+struct OBJFastReader::Chunk
+{
+	const char* begin;
+	const char* end;
+	Vector3dVector<float> positions;
+	Vector3dVector<float> texCoords;
+	Vector3dVector<float> normals;
+	std::vector<int> vertexIndices;
+	std::vector<int> texIndices;
+	std::vector<int> normalIndices;
+	std::vector<size_t> faceEnds;
+	std::vector<Range> groups;
+	std::vector<Range> materials;
+	std::vector<std::string> mtlLibs;
+	std::vector<GroupSnapshot> snapshots;
+	// corners whose relative index was resolved against this chunk's counts only.
+	std::vector<size_t> relativeVertices;
+	std::vector<size_t> relativeTexes;
+	std::vector<size_t> relativeNormals;
+
+	bool read(const bool resolvesRelative);
+
+	void reserve();
+
+	bool readLine(const char* p, const char* end, const bool resolvesRelative);
+
+	bool readFace(const char* p, const char* end, const bool resolvesRelative);
+
+	void resolve(const size_t count, std::vector<int>& indices, std::vector<size_t>& relatives);
+};
+
+bool OBJFastReader::read(const char* begin, const char* end)
+{
+	clear();
+	const size_t size = end - begin;
+	const size_t count = std::max<size_t>(1, (size + chunkSize - 1) / chunkSize);
+	std::vector<Chunk> chunks(count);
+	const char* p = begin;
+	for (size_t i = 0; i < count; ++i) {
+		const char* e = begin + size * (i + 1) / count;
+		if (i + 1 == count) {
+			e = end;
+		}
+		else if (e <= p) {
+			e = p;
+		}
+		else {
+			const char* lineEnd = static_cast<const char*>(std::memchr(e - 1, '\n', end - e + 1));
+			e = (lineEnd == nullptr) ? end : lineEnd + 1;
+		}
+		chunks[i].begin = p;
+		chunks[i].end = e;
+		p = e;
+	}
+
+	std::vector<char> results(count, 0);
+	Util::parallelFor(count, [&](const size_t i) {
+		results[i] = chunks[i].read(resolvesRelative) ? 1 : 0;
+	}, threadCount);
+	if (std::find(results.begin(), results.end(), 0) != results.end()) {
+		return false;
+	}
+	merge(chunks);
+	return true;
+}
+
+void OBJFastReader::clear()
+{
+	positions.clear();
+	texCoords.clear();
+	normals.clear();
+	vertexIndices.clear();
+	texIndices.clear();
+	normalIndices.clear();
+	faceOffsets.clear();
+	groups.clear();
+	materials.clear();
+	mtlLibs.clear();
+	snapshots.clear();
+}
+
+// concatenates the chunks in order. the bases of chunk i are the totals of chunks [0, i).
+void OBJFastReader::merge(std::vector<Chunk>& chunks)
+{
+	struct Bases
+	{
+		size_t position;
+		size_t texCoord;
+		size_t normal;
+		size_t corner;
+		size_t face;
+	};
+	std::vector<Bases> bases(chunks.size() + 1);
+	bases[0] = Bases{ 0, 0, 0, 0, 0 };
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		const Chunk& c = chunks[i];
+		bases[i + 1].position = bases[i].position + c.positions.size();
+		bases[i + 1].texCoord = bases[i].texCoord + c.texCoords.size();
+		bases[i + 1].normal = bases[i].normal + c.normals.size();
+		bases[i + 1].corner = bases[i].corner + c.vertexIndices.size();
+		bases[i + 1].face = bases[i].face + c.faceEnds.size();
+	}
+	const Bases& totals = bases.back();
+	positions.resize(totals.position);
+	texCoords.resize(totals.texCoord);
+	normals.resize(totals.normal);
+	vertexIndices.resize(totals.corner);
+	texIndices.resize(totals.corner);
+	normalIndices.resize(totals.corner);
+	faceOffsets.resize(totals.face + 1);
+	faceOffsets[0] = 0;
+
+	for (size_t i = 0; i < chunks.size(); ++i) {
+		const Chunk& c = chunks[i];
+		const Bases& b = bases[i];
+		for (auto r : c.groups) {
+			r.firstFace += b.face;
+			groups.push_back(r);
+		}
+		for (auto r : c.materials) {
+			r.firstFace += b.face;
+			materials.push_back(r);
+		}
+		for (auto s : c.snapshots) {
+			s.positionCount += b.position;
+			s.texCoordCount += b.texCoord;
+			s.normalCount += b.normal;
+			snapshots.push_back(s);
+		}
+		mtlLibs.insert(mtlLibs.end(), c.mtlLibs.begin(), c.mtlLibs.end());
+	}
+
+	Util::parallelFor(chunks.size(), [&](const size_t i) {
+		Chunk& c = chunks[i];
+		const Bases& b = bases[i];
+		std::copy(c.positions.begin(), c.positions.end(), positions.begin() + b.position);
+		std::copy(c.texCoords.begin(), c.texCoords.end(), texCoords.begin() + b.texCoord);
+		std::copy(c.normals.begin(), c.normals.end(), normals.begin() + b.normal);
+		std::copy(c.vertexIndices.begin(), c.vertexIndices.end(), vertexIndices.begin() + b.corner);
+		std::copy(c.texIndices.begin(), c.texIndices.end(), texIndices.begin() + b.corner);
+		std::copy(c.normalIndices.begin(), c.normalIndices.end(), normalIndices.begin() + b.corner);
+		for (const auto corner : c.relativeVertices) {
+			vertexIndices[b.corner + corner] += static_cast<int>(b.position);
+		}
+		for (const auto corner : c.relativeTexes) {
+			texIndices[b.corner + corner] += static_cast<int>(b.texCoord);
+		}
+		for (const auto corner : c.relativeNormals) {
+			normalIndices[b.corner + corner] += static_cast<int>(b.normal);
+		}
+		for (size_t f = 0; f < c.faceEnds.size(); ++f) {
+			faceOffsets[b.face + f + 1] = b.corner + c.faceEnds[f];
+		}
+		c = Chunk();
+	}, threadCount);
+}
+
+bool OBJFastReader::Chunk::read(const bool resolvesRelative)
+{
+	reserve();
+	for (const char* p = begin; p < end;) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		if (!readLine(skipSpaces(p, lineEnd), lineEnd, resolvesRelative)) {
+			return false;
+		}
+		p = lineEnd + 1;
+	}
+	return true;
+}
+
+// counts line kinds so every array is allocated once.
+void OBJFastReader::Chunk::reserve()
+{
+	size_t positionCount = 0;
+	size_t texCoordCount = 0;
+	size_t normalCount = 0;
+	size_t faceCount = 0;
+	size_t cornerCount = 0;
+	for (const char* p = begin; p < end;) {
+		const char* lineEnd = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		if (lineEnd == nullptr) {
+			lineEnd = end;
+		}
+		p = skipSpaces(p, lineEnd);
+		if (lineEnd - p >= 2) {
+			if (p[0] == 'v') {
+				positionCount += isSpace(p[1]) ? 1 : 0;
+				texCoordCount += (p[1] == 't') ? 1 : 0;
+				normalCount += (p[1] == 'n') ? 1 : 0;
+			}
+			else if (p[0] == 'f' && isSpace(p[1])) {
+				++faceCount;
+				// one corner per run of non-space characters.
+				for (const char* q = p + 1; q < lineEnd; ++q) {
+					cornerCount += (isSpace(q[-1]) && !isSpace(*q)) ? 1 : 0;
+				}
+			}
+		}
+		p = lineEnd + 1;
+	}
+	positions.reserve(positionCount);
+	texCoords.reserve(texCoordCount);
+	normals.reserve(normalCount);
+	faceEnds.reserve(faceCount);
+	vertexIndices.reserve(cornerCount);
+	texIndices.reserve(cornerCount);
+	normalIndices.reserve(cornerCount);
+}
+
+bool OBJFastReader::Chunk::readLine(const char* p, const char* end, const bool resolvesRelative)
+{
+	if (p >= end || *p == '#') {
+		return true;
+	}
+	float values[4];
+	if (isKeyword(p, end, "v")) {
+		if (readFloats(p + 1, end, values, 4) < 3) {
+			return false;
+		}
+		positions.push_back(Vector3d<float>(values[0], values[1], values[2]));
+	}
+	else if (isKeyword(p, end, "vt")) {
+		values[2] = 0.0f;
+		if (readFloats(p + 2, end, values, 3) < 2) {
+			return false;
+		}
+		texCoords.push_back(Vector3d<float>(values[0], values[1], values[2]));
+	}
+	else if (isKeyword(p, end, "vn") || isKeyword(p, end, "-vn")) {
+		const char* q = (*p == '-') ? p + 3 : p + 2;
+		values[2] = 0.0f;
+		if (readFloats(q, end, values, 3) < 2) {
+			return false;
+		}
+		normals.push_back(Vector3d<float>(values[0], values[1], values[2]));
+	}
+	else if (isKeyword(p, end, "f")) {
+		return readFace(p + 1, end, resolvesRelative);
+	}
+	else if (isKeyword(p, end, "g")) {
+		const Range r = { toTrimmed(p + 1, end), faceEnds.size() };
+		groups.push_back(r);
+		const GroupSnapshot s = { positions.size(), texCoords.size(), normals.size() };
+		snapshots.push_back(s);
+	}
+	else if (isKeyword(p, end, "usemtl")) {
+		const Range r = { toTrimmed(p + 6, end), faceEnds.size() };
+		materials.push_back(r);
+	}
+	else if (isKeyword(p, end, "mtllib")) {
+		mtlLibs.push_back(toTrimmed(p + 6, end));
+	}
+	return true;
+}
+
+// corners are v, v/t, v//n or v/t/n.
+bool OBJFastReader::Chunk::readFace(const char* p, const char* end, const bool resolvesRelative)
+{
+	for (p = skipSpaces(p, end); p < end; p = skipSpaces(p, end)) {
+		int v = 0;
+		int t = 0;
+		int n = 0;
+		if (!TextScanner::parseInt(p, end, v)) {
+			return false;
+		}
+		if (p < end && *p == '/') {
+			++p;
+			if (p < end && *p != '/' && !TextScanner::parseInt(p, end, t)) {
+				return false;
+			}
+			if (p < end && *p == '/') {
+				++p;
+				if (!TextScanner::parseInt(p, end, n)) {
+					return false;
+				}
+			}
+		}
+		if (p < end && !isSpace(*p)) {
+			return false;
+		}
+		vertexIndices.push_back(v);
+		texIndices.push_back(t);
+		normalIndices.push_back(n);
+		if (resolvesRelative) {
+			resolve(positions.size(), vertexIndices, relativeVertices);
+			resolve(texCoords.size(), texIndices, relativeTexes);
+			resolve(normals.size(), normalIndices, relativeNormals);
+		}
+	}
+	faceEnds.push_back(vertexIndices.size());
+	return true;
+}
+
+// -1 is the last element read so far. the result may still be <= 0 when it points into an earlier chunk.
+void OBJFastReader::Chunk::resolve(const size_t count, std::vector<int>& indices, std::vector<size_t>& relatives)
+{
+	int& index = indices.back();
+	if (index < 0) {
+		index += static_cast<int>(count) + 1;
+		relatives.push_back(indices.size() - 1);
+	}
+}
+
+OBJFace OBJFastReader::getFace(const size_t i) const
+{
+	OBJIndices vs;
+	OBJIndices ts;
+	OBJIndices ns;
+	for (size_t c = faceOffsets[i]; c < faceOffsets[i + 1]; ++c) {
+		vs.push_back(vertexIndices[c]);
+		if (texIndices[c] != 0) {
+			ts.push_back(texIndices[c]);
+		}
+		if (normalIndices[c] != 0) {
+			ns.push_back(normalIndices[c]);
+		}
+	}
+	return OBJFace(vs, ts, ns);
+}
+
+OBJFile OBJFastReader::toOBJFile() const
+{
+	OBJGroupSPtrVector results;
+	for (const auto& s : snapshots) {
+		OBJGroupSPtr g(new OBJGroup());
+		g->setPositions(Vector3dVector<float>(positions.begin(), positions.begin() + s.positionCount));
+		g->setTexCoords(Vector3dVector<float>(texCoords.begin(), texCoords.begin() + s.texCoordCount));
+		g->setNormals(Vector3dVector<float>(normals.begin(), normals.begin() + s.normalCount));
+		results.push_back(g);
+	}
+
+	OBJGroupSPtr last(new OBJGroup());
+	last->setPositions(positions);
+	last->setTexCoords(texCoords);
+	last->setNormals(normals);
+	std::vector<OBJFace> faces;
+	faces.reserve(getFaceCount());
+	for (size_t i = 0; i < getFaceCount(); ++i) {
+		faces.push_back(getFace(i));
+	}
+	last->setFaces(faces);
+	std::vector<std::string> names;
+	for (const auto& m : materials) {
+		names.push_back(m.name);
+	}
+	last->setMaterials(names);
+	results.push_back(last);
+
+	OBJFile file;
+	file.setGroups(results);
+	return file;
+}
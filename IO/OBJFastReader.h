@@ -0,0 +1,126 @@
+#ifndef __CRYSTAL_IO_OBJ_FAST_READER_H__
+#define __CRYSTAL_IO_OBJ_FAST_READER_H__
+
+#include "OBJFile.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+
+namespace Crystal {
+	namespace IO {
+
+// Reads OBJ geometry into flat arrays. The input is scanned in place (memory-mapped for files), numbers are parsed
+// straight from the character range and every array is reserved from a counting pass first, so no per-line or
+// per-token strings are built.
+//
+// Large inputs are split at line boundaries into chunks that are parsed on worker threads into their own arrays.
+// A prefix-sum merge then concatenates the chunks, offsets face and group positions, and fixes up relative indices,
+// so the result does not depend on the chunk size or the thread count.
+//
+// Faces are stored as runs of corners: face i owns corners [getFaceOffsets()[i], getFaceOffsets()[i + 1]).
+// Corner indices are kept as written in the file (1-based, negative for relative) unless relative indices are set to
+// be resolved, in which case they are all made absolute; 0 marks a missing texture or normal index.
+class OBJFastReader final
+{
+public:
+	struct Range
+	{
+		std::string name;
+		size_t firstFace;
+	};
+
+	OBJFastReader() :
+		threadCount(0),
+		chunkSize(4 * 1024 * 1024),
+		resolvesRelative(false)
+	{}
+
+	~OBJFastReader() = default;
+
+	bool read(const std::string& filename);
+
+	bool read(std::istream& stream);
+
+	bool read(const char* begin, const char* end);
+
+	void clear();
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	// approximate bytes per parse chunk.
+	void setChunkSize(const size_t size) { this->chunkSize = (size == 0) ? 1 : size; }
+
+	size_t getChunkSize() const { return chunkSize; }
+
+	// when true, negative indices are replaced by the absolute ones they refer to.
+	void setResolvesRelativeIndices(const bool b) { this->resolvesRelative = b; }
+
+	bool resolvesRelativeIndices() const { return resolvesRelative; }
+
+	const Math::Vector3dVector<float>& getPositions() const { return positions; }
+
+	const Math::Vector3dVector<float>& getTexCoords() const { return texCoords; }
+
+	const Math::Vector3dVector<float>& getNormals() const { return normals; }
+
+	const std::vector<int>& getVertexIndices() const { return vertexIndices; }
+
+	const std::vector<int>& getTexIndices() const { return texIndices; }
+
+	const std::vector<int>& getNormalIndices() const { return normalIndices; }
+
+	const std::vector<size_t>& getFaceOffsets() const { return faceOffsets; }
+
+	size_t getFaceCount() const { return faceOffsets.empty() ? 0 : faceOffsets.size() - 1; }
+
+	OBJFace getFace(const size_t i) const;
+
+	// "g" lines, each with the first face that follows it.
+	const std::vector<Range>& getGroups() const { return groups; }
+
+	// "usemtl" lines, each with the first face that follows it.
+	const std::vector<Range>& getMaterials() const { return materials; }
+
+	const std::vector<std::string>& getMtlLibs() const { return mtlLibs; }
+
+	// the same grouping OBJFileReader produces: one group per "g" line holding the vertex data read so far, and a
+	// last group holding everything plus all faces and materials.
+	OBJFile toOBJFile() const;
+
+private:
+	unsigned int threadCount;
+	size_t chunkSize;
+	bool resolvesRelative;
+
+	Math::Vector3dVector<float> positions;
+	Math::Vector3dVector<float> texCoords;
+	Math::Vector3dVector<float> normals;
+	std::vector<int> vertexIndices;
+	std::vector<int> texIndices;
+	std::vector<int> normalIndices;
+	std::vector<size_t> faceOffsets;
+	std::vector<Range> groups;
+	std::vector<Range> materials;
+	std::vector<std::string> mtlLibs;
+
+	struct GroupSnapshot
+	{
+		size_t positionCount;
+		size_t texCoordCount;
+		size_t normalCount;
+	};
+	std::vector<GroupSnapshot> snapshots;
+
+	struct Chunk;
+
+	void merge(std::vector<Chunk>& chunks);
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,238 @@
+#include "gtest/gtest.h"
+
+#include "OBJFastReader.h"
+
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class OBJFastReaderTest : public testing::Test {
+protected:
+	OBJFastReaderTest()
+	{
+		std::stringstream stream;
+		stream
+			<< "mtllib cube.mtl" << std::endl
+			<< "v 0 2 2" << std::endl
+			<< "v 0 0 2" << std::endl
+			<< "v 2 0 2" << std::endl
+			<< "v 2 2 2" << std::endl
+			<< "vt 0 1" << std::endl
+			<< "vt 1 1" << std::endl
+			<< "vn 0 0 1" << std::endl
+			<< "g front" << std::endl
+			<< "usemtl red" << std::endl
+			<< "f 1/1/1 2/2/1 3/1/1 4/2/1" << std::endl
+			<< "v 0 2 0" << std::endl
+			<< "v 0 0 0" << std::endl
+			<< "v 2 0 0" << std::endl
+			<< "v 2 2 0" << std::endl
+			<< "vn 0 0 -1" << std::endl
+			<< "g back" << std::endl
+			<< "usemtl blue" << std::endl
+			<< "f -1/-2/-1 -2/-1/-1 -3/-2/-1 -4/-1/-1" << std::endl
+			<< "f 8 7 6 5" << std::endl;
+		cubeText = stream.str();
+	}
+
+	static void expectSame(const OBJFile& expected, const OBJFile& actual)
+	{
+		ASSERT_EQ(expected.getGroups().size(), actual.getGroups().size());
+		for (size_t i = 0; i < expected.getGroups().size(); ++i) {
+			const auto& e = *expected.getGroups()[i];
+			const auto& a = *actual.getGroups()[i];
+			EXPECT_EQ(e, a);
+			EXPECT_EQ(e.getMaterials(), a.getMaterials());
+			EXPECT_EQ(e.getPositions(), a.getPositions());
+			EXPECT_EQ(e.getTexCoords(), a.getTexCoords());
+			EXPECT_EQ(e.getNormals(), a.getNormals());
+		}
+	}
+
+	std::string cubeText;
+};
+
+TEST_F(OBJFastReaderTest, TestReadVertices)
+{
+	std::stringstream stream;
+	stream
+		<< "v 0.1 0.2 0.3" << std::endl
+		<< "v -1.5e2 +2 .25 1.0" << std::endl
+		<< "vt 0.5 1.0" << std::endl
+		<< "vn 1.0 0.0 0.0" << std::endl;
+	OBJFastReader reader;
+	EXPECT_TRUE(reader.read(stream));
+	const std::vector< Vector3d<float> > positions = { Vector3d<float>(0.1f, 0.2f, 0.3f), Vector3d<float>(-150.0f, 2.0f, 0.25f) };
+	EXPECT_EQ(positions, reader.getPositions());
+	EXPECT_EQ(std::vector< Vector3d<float> > { Vector3d<float>(0.5f, 1.0f, 0.0f) }, reader.getTexCoords());
+	EXPECT_EQ(std::vector< Vector3d<float> > { Vector3d<float>(1.0f, 0.0f, 0.0f) }, reader.getNormals());
+}
+
+TEST_F(OBJFastReaderTest, TestReadFaces)
+{
+	std::stringstream stream;
+	stream
+		<< "f 1 2 3" << std::endl
+		<< "f 3/1 4/2 5/3" << std::endl
+		<< "f 1//1 2//2 3//3 4//4 " << std::endl
+		<< "\tf 6/4/1 3/5/3 -1/6/5\r" << std::endl;
+	OBJFastReader reader;
+	EXPECT_TRUE(reader.read(stream));
+	EXPECT_EQ(4, reader.getFaceCount());
+	const std::vector<size_t> offsets = { 0, 3, 6, 10, 13 };
+	EXPECT_EQ(offsets, reader.getFaceOffsets());
+	EXPECT_EQ(OBJFace({ 1, 2, 3 }), reader.getFace(0));
+	EXPECT_EQ(OBJFace({ 3, 4, 5 }, { 1, 2, 3 }), reader.getFace(1));
+	EXPECT_EQ(OBJFace({ 1, 2, 3, 4 }, {}, { 1, 2, 3, 4 }), reader.getFace(2));
+	EXPECT_EQ(OBJFace({ 6, 3, -1 }, { 4, 5, 6 }, { 1, 3, 5 }), reader.getFace(3));
+}
+
+TEST_F(OBJFastReaderTest, TestGroupsAndMaterials)
+{
+	std::stringstream stream;
+	stream
+		<< "mtllib master.mtl" << std::endl
+		<< "v 0 0 0" << std::endl
+		<< "g front cube" << std::endl
+		<< "usemtl wood" << std::endl
+		<< "f 1 1 1" << std::endl
+		<< "g back" << std::endl
+		<< "usemtl  stone " << std::endl
+		<< "f 1 1 1" << std::endl;
+	OBJFastReader reader;
+	EXPECT_TRUE(reader.read(stream));
+	EXPECT_EQ(std::vector<std::string>{ "master.mtl" }, reader.getMtlLibs());
+	ASSERT_EQ(2, reader.getGroups().size());
+	EXPECT_EQ("front cube", reader.getGroups()[0].name);
+	EXPECT_EQ(0, reader.getGroups()[0].firstFace);
+	EXPECT_EQ(1, reader.getGroups()[1].firstFace);
+	ASSERT_EQ(2, reader.getMaterials().size());
+	EXPECT_EQ("stone", reader.getMaterials()[1].name);
+	EXPECT_EQ(1, reader.getMaterials()[1].firstFace);
+}
+
+TEST_F(OBJFastReaderTest, TestSameAsOBJFileReader)
+{
+	std::stringstream stream;
+	stream
+		<< "# cube" << std::endl
+		<< "v 0.000000 2.000000 2.000000" << std::endl
+		<< "v 0.000000 0.000000 2.000000" << std::endl
+		<< "v 2.000000 0.000000 2.000000" << std::endl
+		<< "v 2.000000 2.000000 2.000000" << std::endl
+		<< "vt 0.000000 1.000000 0.000000" << std::endl
+		<< "vn 0 0 1" << std::endl
+		<< "g front" << std::endl
+		<< "usemtl wood" << std::endl
+		<< "f 1/1/1 2/1/1 3/1/1 4/1/1" << std::endl
+		<< "v 0.000000 2.000000 0.000000" << std::endl
+		<< "v 0.000000 0.000000 0.000000" << std::endl
+		<< "v 2.000000 0.000000 0.000000" << std::endl
+		<< "v 2.000000 2.000000 0.000000" << std::endl
+		<< "g back" << std::endl
+		<< "s 1" << std::endl
+		<< "usemtl  stone \t" << std::endl
+		<< "f 8 7 6 5" << std::endl
+		<< "f -4 -3 -2 -1" << std::endl;
+	const std::string str = stream.str();
+
+	std::stringstream s1(str);
+	const OBJFile& expected = OBJFileReader().read(s1);
+
+	std::stringstream s2(str);
+	OBJFastReader reader;
+	EXPECT_TRUE(reader.read(s2));
+	expectSame(expected, reader.toOBJFile());
+}
+
+TEST_F(OBJFastReaderTest, TestReadFile)
+{
+	const std::string filename = "OBJFastReaderTest.obj";
+	{
+		std::ofstream stream(filename);
+		stream
+			<< "v 1 2 3" << std::endl
+			<< "f 1 1 1";
+	}
+	OBJFastReader reader;
+	EXPECT_TRUE(reader.read(filename));
+	EXPECT_EQ(1, reader.getPositions().size());
+	EXPECT_EQ(1, reader.getFaceCount());
+	EXPECT_FALSE(reader.read("NotExisting.obj"));
+	std::remove(filename.c_str());
+}
+
+TEST_F(OBJFastReaderTest, TestReadInvalid)
+{
+	std::stringstream stream;
+	stream
+		<< "v 1 2" << std::endl
+		<< "f 1 2 3" << std::endl;
+	OBJFastReader reader;
+	EXPECT_FALSE(reader.read(stream));
+	EXPECT_EQ(0, reader.getFaceCount());
+
+	std::stringstream faces("f 1 2x 3");
+	EXPECT_FALSE(reader.read(faces));
+}
+
+TEST_F(OBJFastReaderTest, TestReadChunked)
+{
+	const std::string& str = cubeText;
+	OBJFastReader serial;
+	serial.setThreadCount(1);
+	EXPECT_TRUE(serial.read(str.data(), str.data() + str.size()));
+
+	for (size_t chunkSize = 1; chunkSize < 64; chunkSize += 7) {
+		OBJFastReader reader;
+		reader.setThreadCount(4);
+		reader.setChunkSize(chunkSize);
+		EXPECT_TRUE(reader.read(str.data(), str.data() + str.size()));
+		EXPECT_EQ(serial.getPositions(), reader.getPositions());
+		EXPECT_EQ(serial.getTexCoords(), reader.getTexCoords());
+		EXPECT_EQ(serial.getNormals(), reader.getNormals());
+		EXPECT_EQ(serial.getVertexIndices(), reader.getVertexIndices());
+		EXPECT_EQ(serial.getTexIndices(), reader.getTexIndices());
+		EXPECT_EQ(serial.getNormalIndices(), reader.getNormalIndices());
+		EXPECT_EQ(serial.getFaceOffsets(), reader.getFaceOffsets());
+		ASSERT_EQ(2, reader.getGroups().size());
+		EXPECT_EQ("back", reader.getGroups()[1].name);
+		EXPECT_EQ(1, reader.getGroups()[1].firstFace);
+		ASSERT_EQ(2, reader.getMaterials().size());
+		EXPECT_EQ(1, reader.getMaterials()[1].firstFace);
+		EXPECT_EQ(serial.getMtlLibs(), reader.getMtlLibs());
+
+		std::stringstream stream(str);
+		expectSame(OBJFileReader().read(stream), reader.toOBJFile());
+	}
+}
+
+TEST_F(OBJFastReaderTest, TestResolveRelativeIndices)
+{
+	const std::string& str = cubeText;
+	for (size_t chunkSize = 1; chunkSize < 256; chunkSize *= 2) {
+		OBJFastReader reader;
+		reader.setThreadCount(4);
+		reader.setChunkSize(chunkSize);
+		reader.setResolvesRelativeIndices(true);
+		EXPECT_TRUE(reader.read(str.data(), str.data() + str.size()));
+		ASSERT_EQ(3, reader.getFaceCount());
+		EXPECT_EQ(OBJFace({ 1, 2, 3, 4 }, { 1, 2, 1, 2 }, { 1, 1, 1, 1 }), reader.getFace(0));
+		EXPECT_EQ(OBJFace({ 8, 7, 6, 5 }, { 1, 2, 1, 2 }, { 2, 2, 2, 2 }), reader.getFace(1));
+		EXPECT_EQ(OBJFace({ 8, 7, 6, 5 }), reader.getFace(2));
+	}
+}
+
+TEST_F(OBJFastReaderTest, TestReadChunkedInvalid)
+{
+	const std::string str = cubeText + "v 1 x 2\n" + cubeText;
+	OBJFastReader reader;
+	reader.setThreadCount(4);
+	reader.setChunkSize(32);
+	EXPECT_FALSE(reader.read(str.data(), str.data() + str.size()));
+	EXPECT_TRUE(reader.getPositions().empty());
+	EXPECT_EQ(0, reader.getFaceCount());
+}
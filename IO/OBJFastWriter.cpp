@@ -0,0 +1,180 @@
+#define _CRT_SECURE_NO_DEPRECATE
+
+#include "OBJFastWriter.h"
+
+#include "../Util/Parallel.h"
+
+#include <fstream>
+#include <cstdio>
+#include <cmath>
+#include <algorithm>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	void appendUInt(std::string& s, unsigned long long v)
+	{
+		char digits[20];
+		int n = 0;
+		do {
+			digits[n++] = static_cast<char>('0' + v % 10);
+			v /= 10;
+		} while (v != 0);
+		while (n > 0) {
+			s.push_back(digits[--n]);
+		}
+	}
+
+	void appendInt(std::string& s, const int v)
+	{
+		if (v < 0) {
+			s.push_back('-');
+			appendUInt(s, static_cast<unsigned long long>(-static_cast<long long>(v)));
+		}
+		else {
+			appendUInt(s, static_cast<unsigned long long>(v));
+		}
+	}
+
+	// the same text as printf("%.*f"). a float times 10^decimals (decimals <= 6) is exact in a double, so rounding
+	// the product half to even gives printf's rounding; huge and non-finite values go through sprintf.
+	void appendFixed(std::string& s, const float value, const int decimals)
+	{
+		static const unsigned long long scales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000 };
+		const double scaled = static_cast<double>(value) * static_cast<double>(scales[decimals]);
+		if (!(std::fabs(scaled) < 9.0e15)) {
+			char buffer[512];
+			sprintf(buffer, "%.*f", decimals, static_cast<double>(value));
+			s += buffer;
+			return;
+		}
+		const unsigned long long n = static_cast<unsigned long long>(std::nearbyint(std::fabs(scaled)));
+		if (std::signbit(value)) {
+			s.push_back('-');
+		}
+		appendUInt(s, n / scales[decimals]);
+		if (decimals > 0) {
+			char digits[6];
+			unsigned long long f = n % scales[decimals];
+			for (int i = decimals - 1; i >= 0; --i) {
+				digits[i] = static_cast<char>('0' + f % 10);
+				f /= 10;
+			}
+			s.push_back('.');
+			s.append(digits, decimals);
+		}
+	}
+
+	void appendVector(std::string& s, const char* header, const Vector3d<float>& v, const int decimals)
+	{
+		s += header;
+		appendFixed(s, v.getX(), decimals);
+		s.push_back(' ');
+		appendFixed(s, v.getY(), decimals);
+		s.push_back(' ');
+		appendFixed(s, v.getZ(), decimals);
+		s.push_back('\n');
+	}
+
+	// the corner syntax follows OBJFace::write.
+	void appendFace(std::string& s, const OBJFace& face)
+	{
+		const auto& vs = face.getVertexIndices();
+		const auto& ts = face.getTexIndices();
+		const auto& ns = face.getNormalIndices();
+		s.push_back('f');
+		for (size_t i = 0; i < vs.size(); ++i) {
+			s.push_back(' ');
+			appendInt(s, vs[i]);
+			if (face.hasTexIndices()) {
+				s.push_back('/');
+				appendInt(s, ts[i]);
+				if (face.hasNormals()) {
+					s.push_back('/');
+					appendInt(s, ns[i]);
+				}
+			}
+			else if (face.hasNormals()) {
+				s += "//";
+				appendInt(s, ns[i]);
+			}
+		}
+		s.push_back('\n');
+	}
+}
+
+bool OBJFastWriter::write(const std::string& filename, const OBJFile& file)
+{
+	std::ofstream stream(filename.c_str());
+	if (!stream.is_open()) {
+		return false;
+	}
+	return write(stream, file);
+}
+
+bool OBJFastWriter::write(std::ostream& stream, const OBJFile& file)
+{
+	if (!file.getComment().empty()) {
+		stream << "# " << file.getComment() << '\n';
+	}
+	for (const auto& g : file.getGroups()) {
+		if (!write(stream, *g)) {
+			return false;
+		}
+	}
+	stream.flush();
+	return stream.good();
+}
+
+// lines of a group are numbered header, positions, texcoords, normals, faces; each block formats a run of them.
+bool OBJFastWriter::write(std::ostream& stream, const OBJGroup& group)
+{
+	const auto& positions = group.getPositions();
+	const auto& texCoords = group.getTexCoords();
+	const auto& normals = group.getNormals();
+	const auto& faces = group.getFaces();
+	const size_t texCoordBegin = 1 + positions.size();
+	const size_t normalBegin = texCoordBegin + texCoords.size();
+	const size_t faceBegin = normalBegin + normals.size();
+	const size_t lineCount = faceBegin + faces.size();
+
+	const size_t blockCount = (lineCount + blockLineCount - 1) / blockLineCount;
+	const size_t windowSize = std::max<size_t>(1, (threadCount == 0) ? Util::getThreadCount() : threadCount);
+	buffers.resize(windowSize);
+	for (size_t first = 0; first < blockCount; first += windowSize) {
+		const size_t count = std::min(windowSize, blockCount - first);
+		Util::parallelFor(count, [&](const size_t k) {
+			std::string& s = buffers[k];
+			s.clear();
+			const size_t begin = (first + k) * blockLineCount;
+			const size_t end = std::min(lineCount, begin + blockLineCount);
+			for (size_t i = begin; i < end; ++i) {
+				if (i == 0) {
+					s += "g ";
+					s += group.getName();
+					s.push_back('\n');
+				}
+				else if (i < texCoordBegin) {
+					appendVector(s, "v ", positions[i - 1], 4);
+				}
+				else if (i < normalBegin) {
+					appendVector(s, "vt ", texCoords[i - texCoordBegin], 4);
+				}
+				else if (i < faceBegin) {
+					appendVector(s, "vn ", normals[i - normalBegin], 6);
+				}
+				else {
+					appendFace(s, faces[i - faceBegin]);
+				}
+			}
+		}, threadCount);
+		for (size_t k = 0; k < count; ++k) {
+			stream.write(buffers[k].data(), buffers[k].size());
+		}
+		if (!stream.good()) {
+			return false;
+		}
+	}
+	return true;
+}
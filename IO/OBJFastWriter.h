@@ -0,0 +1,50 @@
+#ifndef __CRYSTAL_IO_OBJ_FAST_WRITER_H__
+#define __CRYSTAL_IO_OBJ_FAST_WRITER_H__
+
+#include "OBJFile.h"
+
+#include <string>
+#include <vector>
+#include <ostream>
+
+namespace Crystal {
+	namespace IO {
+
+// Writes the same text as OBJFileWriter without keeping it. Lines are formatted in blocks of getBlockLineCount()
+// into reusable buffers, one block per thread at a time, and the buffers are written to the stream in order, so
+// memory stays bounded however large the file is.
+class OBJFastWriter final
+{
+public:
+	OBJFastWriter() :
+		threadCount(0),
+		blockLineCount(64 * 1024)
+	{}
+
+	~OBJFastWriter() = default;
+
+	bool write(const std::string& filename, const OBJFile& file);
+
+	bool write(std::ostream& stream, const OBJFile& file);
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	void setBlockLineCount(const size_t count) { this->blockLineCount = (count == 0) ? 1 : count; }
+
+	size_t getBlockLineCount() const { return blockLineCount; }
+
+private:
+	unsigned int threadCount;
+	size_t blockLineCount;
+	std::vector<std::string> buffers;
+
+	bool write(std::ostream& stream, const OBJGroup& group);
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+
+#include "OBJFastWriter.h"
+
+#include <sstream>
+#include <fstream>
+#include <random>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class OBJFastWriterTest : public testing::Test {
+protected:
+	static OBJFile toFile()
+	{
+		OBJGroupSPtr front(new OBJGroup("front"));
+		front->setPositions({ Vector3d<float>(0.1f, -0.2f, 1.03125f), Vector3d<float>(-0.00001f, 12345.678f, 0.0f) });
+		front->setTexCoords({ Vector3d<float>(0.5f, 1.0f, 0.0f) });
+		front->setNormals({ Vector3d<float>(0.5f, -1.0f, 1e-7f) });
+		front->setFaces({ OBJFace({ 1, 2, 3 }), OBJFace({ 1, 2, 3 }, { 1, 1, 1 }), OBJFace({ 1, 2, 3 }, {}, { 1, 1, 1 }), OBJFace({ 1, 2, 3 }, { 1, 1, 1 }, { 1, 1, 1 }) });
+		OBJGroupSPtr back(new OBJGroup("back"));
+		back->setPositions({ Vector3d<float>(1, 2, 3) });
+		back->setFaces({ OBJFace({ 3, 2, 1 }) });
+		OBJFile file;
+		file.setComment("written");
+		file.setGroups({ front, back });
+		return file;
+	}
+
+	static std::string toLegacyText(const OBJFile& file)
+	{
+		std::stringstream stream;
+		OBJFileWriter().write(stream, file);
+		return stream.str();
+	}
+};
+
+TEST_F(OBJFastWriterTest, TestWrite)
+{
+	const OBJFile& file = toFile();
+	std::stringstream stream;
+	OBJFastWriter writer;
+	EXPECT_TRUE(writer.write(stream, file));
+	EXPECT_EQ(toLegacyText(file), stream.str());
+}
+
+TEST_F(OBJFastWriterTest, TestWriteEmpty)
+{
+	std::stringstream stream;
+	OBJFastWriter writer;
+	EXPECT_TRUE(writer.write(stream, OBJFile()));
+	EXPECT_TRUE(stream.str().empty());
+}
+
+TEST_F(OBJFastWriterTest, TestWriteInBlocks)
+{
+	std::mt19937 random(1);
+	std::uniform_real_distribution<float> distribution(-1000.0f, 1000.0f);
+	Vector3dVector<float> positions;
+	std::vector<OBJFace> faces;
+	for (int i = 0; i < 1000; ++i) {
+		positions.push_back(Vector3d<float>(distribution(random), distribution(random) * 1e-3f, distribution(random) * 1e3f));
+		faces.push_back(OBJFace({ i + 1, -1, 2 }, {}, { 1, 1, 1 }));
+	}
+	OBJGroupSPtr group(new OBJGroup("random"));
+	group->setPositions(positions);
+	group->setNormals(positions);
+	group->setFaces(faces);
+	OBJFile file;
+	file.setGroups({ group });
+
+	const std::string& expected = toLegacyText(file);
+	for (size_t lineCount = 1; lineCount < 2000; lineCount *= 3) {
+		std::stringstream stream;
+		OBJFastWriter writer;
+		writer.setThreadCount(4);
+		writer.setBlockLineCount(lineCount);
+		EXPECT_TRUE(writer.write(stream, file));
+		EXPECT_EQ(expected, stream.str());
+	}
+}
+
+TEST_F(OBJFastWriterTest, TestWriteFile)
+{
+	const std::string filename = "OBJFastWriterTest.obj";
+	OBJFastWriter writer;
+	EXPECT_TRUE(writer.write(filename, toFile()));
+	std::ifstream stream(filename);
+	std::stringstream text;
+	text << stream.rdbuf();
+	stream.close();
+	EXPECT_EQ(toLegacyText(toFile()), text.str());
+	std::remove(filename.c_str());
+}
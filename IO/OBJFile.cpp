@@ -151,7 +151,8 @@ OBJFile OBJFileReader::read(std::istream& stream )
 		else if( header == "usemtl" ) {
 			std::getline(stream, str);
 			//OBJMaterial material(str);
-			const std::string name = str;
+			const size_t first = str.find_first_not_of(" \t\r");
+			const std::string name = (first == std::string::npos) ? "" : str.substr(first, str.find_last_not_of(" \t\r") - first + 1);
 			materials.push_back(name);
 			useMtlName = name;
 		}
@@ -27,15 +27,15 @@ struct OBJFace
 
 	void setVertexIndices(const OBJIndices& vertexIndices) { this->vertexIndices = vertexIndices; }
 
-	OBJIndices getVertexIndices() const { return vertexIndices; }
+	const OBJIndices& getVertexIndices() const { return vertexIndices; }
 
 	void setTexIndices(const OBJIndices& texIndices) { this->texIndices = texIndices; }
 
-	OBJIndices getTexIndices() const { return texIndices; }
+	const OBJIndices& getTexIndices() const { return texIndices; }
 
 	void setNormalIndices(const OBJIndices& normalIndices) { this->normalIndices = normalIndices; }
 
-	OBJIndices getNormalIndices() const { return normalIndices; }
+	const OBJIndices& getNormalIndices() const { return normalIndices; }
 
 	bool hasTexIndices() const {
 		return !texIndices.empty();
@@ -129,24 +129,26 @@ struct OBJGroup {
 
 	void setFaces(const std::vector< OBJFace>& faces) { this->faces = faces; }
 
-	std::vector< OBJFace > getFaces() const { return faces; }
+	const std::vector< OBJFace >& getFaces() const { return faces; }
 
 	void setPositions(const std::vector< Math::Vector3d<float> >& positions) { this->positions = positions; }
 
-	std::vector< Math::Vector3d<float> > getPositions() const { return positions; }
+	const std::vector< Math::Vector3d<float> >& getPositions() const { return positions; }
 
 	void setNormals(const std::vector< Math::Vector3d<float> >& normals) { this->normals = normals; }
 
-	std::vector< Math::Vector3d<float> > getNormals() const { return normals; }
+	const std::vector< Math::Vector3d<float> >& getNormals() const { return normals; }
 
 	void setMtlLib(const OBJMTLLib& lib) { this->mtlLib = lib; }
 
 	void setTexCoords(const std::vector< Math::Vector3d<float> >& texCoords) { this->texCoords = texCoords; }
 
-	std::vector< Math::Vector3d<float> > getTexCoords() const { return texCoords; }
+	const std::vector< Math::Vector3d<float> >& getTexCoords() const { return texCoords; }
 
 	void setMaterials(const std::vector<std::string>& m) { this->materials = m; }
 
+	std::vector<std::string> getMaterials() const { return materials; }
+
 	Math::Vector3d<float> readVertices(const std::string& str);
 
 	Math::Vector3d<float> readVector3d(const std::string& str);
@@ -1,35 +1,866 @@
+#define _CRT_SECURE_NO_DEPRECATE
+
 #include "PLYFile.h"
 
+#include "MappedFile.h"
+#include "TextScanner.h"
+#include "../Util/Parallel.h"
+
+#include <fstream>
+#include <sstream>
+#include <iterator>
+#include <algorithm>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+
 using namespace Crystal::Math;
 using namespace Crystal::IO;
 
+namespace {
+	const size_t ColumnBlockSize = 16 * 1024;
+
+	struct TypeName
+	{
+		const char* name;
+		PLYType type;
+	};
+
+	// the first name of each type is the one written.
+	const TypeName typeNames[] = {
+		{ "char", PLYType::Char }, { "int8", PLYType::Char },
+		{ "uchar", PLYType::UChar }, { "uint8", PLYType::UChar },
+		{ "short", PLYType::Short }, { "int16", PLYType::Short },
+		{ "ushort", PLYType::UShort }, { "uint16", PLYType::UShort },
+		{ "int", PLYType::Int }, { "int32", PLYType::Int },
+		{ "uint", PLYType::UInt }, { "uint32", PLYType::UInt },
+		{ "float", PLYType::Float }, { "float32", PLYType::Float },
+		{ "double", PLYType::Double }, { "float64", PLYType::Double },
+	};
+
+	PLYType toType(const std::string& name)
+	{
+		for (const auto& t : typeNames) {
+			if (name == t.name) {
+				return t.type;
+			}
+		}
+		return PLYType::None;
+	}
+
+	const char* toName(const PLYType type)
+	{
+		for (const auto& t : typeNames) {
+			if (type == t.type) {
+				return t.name;
+			}
+		}
+		return "";
+	}
+
+	bool isInteger(const PLYType type) { return type != PLYType::None && type != PLYType::Float && type != PLYType::Double; }
+
+	bool isHostLittleEndian()
+	{
+		const unsigned short v = 1;
+		return *reinterpret_cast<const unsigned char*>(&v) == 1;
+	}
+
+	void swapBytes(unsigned char* values, const size_t count, const size_t size)
+	{
+		for (size_t i = 0; i < count; ++i) {
+			std::reverse(values + i * size, values + (i + 1) * size);
+		}
+	}
+
+	template<typename S, typename D>
+	void cast(const S* src, const size_t count, void* dst)
+	{
+		D* d = static_cast<D*>(dst);
+		for (size_t i = 0; i < count; ++i) {
+			d[i] = static_cast<D>(src[i]);
+		}
+	}
+
+	template<typename S>
+	void convertFrom(const S* src, const size_t count, const PLYType to, void* dst)
+	{
+		switch (to) {
+		case PLYType::Char: cast<S, signed char>(src, count, dst); break;
+		case PLYType::UChar: cast<S, unsigned char>(src, count, dst); break;
+		case PLYType::Short: cast<S, short>(src, count, dst); break;
+		case PLYType::UShort: cast<S, unsigned short>(src, count, dst); break;
+		case PLYType::Int: cast<S, int>(src, count, dst); break;
+		case PLYType::UInt: cast<S, unsigned int>(src, count, dst); break;
+		case PLYType::Float: cast<S, float>(src, count, dst); break;
+		case PLYType::Double: cast<S, double>(src, count, dst); break;
+		default: break;
+		}
+	}
+
+	// src may be unaligned, so values are copied out before converting.
+	void convert(const PLYType from, const void* src, const size_t count, const PLYType to, void* dst)
+	{
+		if (from == to) {
+			std::memcpy(dst, src, count * PLYFile::getSize(from));
+			return;
+		}
+		const size_t blockSize = 256;
+		const unsigned char* s = static_cast<const unsigned char*>(src);
+		unsigned char* d = static_cast<unsigned char*>(dst);
+		double buffer[blockSize];
+		for (size_t first = 0; first < count; first += blockSize) {
+			const size_t n = std::min(blockSize, count - first);
+			std::memcpy(buffer, s + first * PLYFile::getSize(from), n * PLYFile::getSize(from));
+			void* out = d + first * PLYFile::getSize(to);
+			switch (from) {
+			case PLYType::Char: convertFrom(reinterpret_cast<const signed char*>(buffer), n, to, out); break;
+			case PLYType::UChar: convertFrom(reinterpret_cast<const unsigned char*>(buffer), n, to, out); break;
+			case PLYType::Short: convertFrom(reinterpret_cast<const short*>(buffer), n, to, out); break;
+			case PLYType::UShort: convertFrom(reinterpret_cast<const unsigned short*>(buffer), n, to, out); break;
+			case PLYType::Int: convertFrom(reinterpret_cast<const int*>(buffer), n, to, out); break;
+			case PLYType::UInt: convertFrom(reinterpret_cast<const unsigned int*>(buffer), n, to, out); break;
+			case PLYType::Float: convertFrom(reinterpret_cast<const float*>(buffer), n, to, out); break;
+			case PLYType::Double: convertFrom(buffer, n, to, out); break;
+			default: break;
+			}
+		}
+	}
+
+	double toDouble(const PLYType type, const void* value)
+	{
+		double d = 0.0;
+		convert(type, value, 1, PLYType::Double, &d);
+		return d;
+	}
+
+	// largest list length a count type can hold.
+	double toMaxCount(const PLYType type)
+	{
+		switch (type) {
+		case PLYType::Char: return 127.0;
+		case PLYType::UChar: return 255.0;
+		case PLYType::Short: return 32767.0;
+		case PLYType::UShort: return 65535.0;
+		case PLYType::Int: return 2147483647.0;
+		case PLYType::UInt: return 4294967295.0;
+		default: return -1.0;
+		}
+	}
+
+	// smallest value an integer type can hold.
+	double toMinValue(const PLYType type)
+	{
+		switch (type) {
+		case PLYType::Char: return -128.0;
+		case PLYType::Short: return -32768.0;
+		case PLYType::Int: return -2147483648.0;
+		default: return 0.0;
+		}
+	}
+
+	const char* toLineEnd(const char* p, const char* end)
+	{
+		const char* e = static_cast<const char*>(std::memchr(p, '\n', end - p));
+		return (e == nullptr) ? end : e;
+	}
+
+	std::vector<std::string> toTokens(const std::string& line)
+	{
+		std::istringstream stream(line);
+		return std::vector<std::string>((std::istream_iterator<std::string>(stream)), std::istream_iterator<std::string>());
+	}
+
+	bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+	// one ASCII value in the property's type, stored unaligned at out.
+	bool readASCIIValue(const char*& p, const char* end, const PLYType type, unsigned char* out)
+	{
+		while (p < end && isSpace(*p)) {
+			++p;
+		}
+		if (type == PLYType::Float) {
+			float v = 0.0f;
+			if (!TextScanner::parseFloat(p, end, v)) {
+				return false;
+			}
+			std::memcpy(out, &v, sizeof(v));
+		}
+		else if (type == PLYType::Double) {
+			char buffer[64];
+			const char* e = p;
+			while (e < end && !isSpace(*e)) {
+				++e;
+			}
+			const size_t length = std::min<size_t>(e - p, sizeof(buffer) - 1);
+			std::memcpy(buffer, p, length);
+			buffer[length] = '\0';
+			char* last = nullptr;
+			const double v = std::strtod(buffer, &last);
+			if (length == 0 || last != buffer + length) {
+				return false;
+			}
+			std::memcpy(out, &v, sizeof(v));
+			p = e;
+		}
+		else {
+			bool isNegative = false;
+			if (p < end && (*p == '-' || *p == '+')) {
+				isNegative = (*p == '-');
+				++p;
+			}
+			if (p >= end || *p < '0' || *p > '9') {
+				return false;
+			}
+			// digits stop as soon as the value leaves the type, so v stays exact in a double.
+			const double limit = isNegative ? -toMinValue(type) : toMaxCount(type);
+			double v = 0.0;
+			for (; p < end && *p >= '0' && *p <= '9'; ++p) {
+				v = v * 10.0 + (*p - '0');
+				if (v > limit) {
+					return false;
+				}
+			}
+			const double d = isNegative ? -v : v;
+			convert(PLYType::Double, &d, 1, type, out);
+		}
+		return p >= end || isSpace(*p);
+	}
+
+	// shortest text that reads back to the same value.
+	void appendASCIIValue(std::string& s, const PLYType type, const void* value)
+	{
+		char buffer[64];
+		if (type == PLYType::Float) {
+			float v = 0.0f;
+			std::memcpy(&v, value, sizeof(v));
+			for (int precision = 6; precision <= 9; ++precision) {
+				sprintf(buffer, "%.*g", precision, v);
+				if (static_cast<float>(std::strtod(buffer, nullptr)) == v) {
+					break;
+				}
+			}
+		}
+		else if (type == PLYType::Double) {
+			double v = 0.0;
+			std::memcpy(&v, value, sizeof(v));
+			for (int precision = 15; precision <= 17; ++precision) {
+				sprintf(buffer, "%.*g", precision, v);
+				if (std::strtod(buffer, nullptr) == v) {
+					break;
+				}
+			}
+		}
+		else {
+			sprintf(buffer, "%.0f", toDouble(type, value));
+		}
+		s += buffer;
+	}
+}
+
+size_t PLYFile::getSize(const PLYType type)
+{
+	switch (type) {
+	case PLYType::Char:
+	case PLYType::UChar:
+		return 1;
+	case PLYType::Short:
+	case PLYType::UShort:
+		return 2;
+	case PLYType::Int:
+	case PLYType::UInt:
+	case PLYType::Float:
+		return 4;
+	case PLYType::Double:
+		return 8;
+	default:
+		return 0;
+	}
+}
+
 bool PLYFile::read(const std::string& filename)
 {
-	return false;
+	MappedFile file;
+	if (!file.open(filename)) {
+		return false;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.getData());
+	return read(begin, begin + file.getSize());
 }
 
 bool PLYFile::read(std::istream& stream)
 {
+	const std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return read(buffer.data(), buffer.data() + buffer.size());
+}
+
+bool PLYFile::read(const char* begin, const char* end)
+{
+	clear();
+	const char* p = begin;
+	const bool isRead =
+		parseHeader(p, end) &&
+		((format == PLYFormat::ASCII) ? readASCII(p, end) : readBinary(p, end));
+	if (!isRead) {
+		clear();
+	}
+	return isRead;
+}
+
+size_t PLYFile::readHeader(const char* begin, const char* end)
+{
+	clear();
+	const char* p = begin;
+	if (!parseHeader(p, end)) {
+		clear();
+		return 0;
+	}
+	return p - begin;
+}
+
+bool PLYFile::parseHeader(const char*& p, const char* end)
+{
+	bool hasFormat = false;
+	for (bool isFirst = true; p < end; isFirst = false) {
+		const char* lineEnd = toLineEnd(p, end);
+		const std::string line(p, (lineEnd > p && lineEnd[-1] == '\r') ? lineEnd - 1 : lineEnd);
+		p = (lineEnd < end) ? lineEnd + 1 : end;
+		const std::vector<std::string>& tokens = toTokens(line);
+		if (isFirst) {
+			if (tokens.size() != 1 || tokens[0] != "ply") {
+				return false;
+			}
+			continue;
+		}
+		if (tokens.empty()) {
+			continue;
+		}
+		const std::string& keyword = tokens[0];
+		if (keyword == "format" && tokens.size() >= 2) {
+			if (tokens[1] == "ascii") {
+				format = PLYFormat::ASCII;
+			}
+			else if (tokens[1] == "binary_little_endian") {
+				format = PLYFormat::BinaryLittleEndian;
+			}
+			else if (tokens[1] == "binary_big_endian") {
+				format = PLYFormat::BinaryBigEndian;
+			}
+			else {
+				return false;
+			}
+			hasFormat = true;
+		}
+		else if (keyword == "comment") {
+			const size_t start = line.find_first_not_of(" \t", line.find("comment") + 7);
+			comments.push_back((start == std::string::npos) ? std::string() : line.substr(start));
+		}
+		else if (keyword == "obj_info") {
+			continue;
+		}
+		else if (keyword == "element" && tokens.size() == 3) {
+			PLYElement e;
+			e.name = tokens[1];
+			char* last = nullptr;
+			e.count = static_cast<size_t>(std::strtoull(tokens[2].c_str(), &last, 10));
+			if (*last != '\0') {
+				return false;
+			}
+			elements.push_back(e);
+		}
+		else if (keyword == "property" && !elements.empty()) {
+			PLYProperty property;
+			if (tokens.size() == 3) {
+				property.type = toType(tokens[1]);
+				property.countType = PLYType::None;
+				property.name = tokens[2];
+			}
+			else if (tokens.size() == 5 && tokens[1] == "list") {
+				property.countType = toType(tokens[2]);
+				property.type = toType(tokens[3]);
+				property.name = tokens[4];
+				if (!isInteger(property.countType)) {
+					return false;
+				}
+			}
+			else {
+				return false;
+			}
+			if (property.type == PLYType::None) {
+				return false;
+			}
+			elements.back().properties.push_back(property);
+		}
+		else if (keyword == "end_header") {
+			return hasFormat;
+		}
+		else {
+			return false;
+		}
+	}
 	return false;
 }
 
+// every value and list count takes at least one character, so each element's rows are checked against the bytes
+// left before any property is allocated.
+bool PLYFile::readASCII(const char* p, const char* end)
+{
+	for (auto& e : elements) {
+		if (e.properties.empty()) {
+			continue;
+		}
+		if (e.count > static_cast<size_t>(end - p) / e.properties.size()) {
+			return false;
+		}
+		for (auto& property : e.properties) {
+			if (property.isList()) {
+				property.offsets.reserve(e.count + 1);
+				property.offsets.push_back(0);
+			}
+			else {
+				property.values.resize(e.count * getSize(property.type));
+			}
+		}
+		for (size_t i = 0; i < e.count; ++i) {
+			for (auto& property : e.properties) {
+				const size_t size = getSize(property.type);
+				if (!property.isList()) {
+					if (!readASCIIValue(p, end, property.type, &property.values[i * size])) {
+						return false;
+					}
+					continue;
+				}
+				unsigned char count[8];
+				if (!readASCIIValue(p, end, property.countType, count)) {
+					return false;
+				}
+				const double n = toDouble(property.countType, count);
+				if (n < 0.0) {
+					return false;
+				}
+				for (size_t k = 0; k < static_cast<size_t>(n); ++k) {
+					const size_t first = property.values.size();
+					property.values.resize(first + size);
+					if (!readASCIIValue(p, end, property.type, &property.values[first])) {
+						return false;
+					}
+				}
+				property.offsets.push_back(property.offsets.back() + static_cast<size_t>(n));
+			}
+		}
+	}
+	return true;
+}
+
+// elements without lists have fixed-size rows, so each column is gathered in parallel; rows with lists are walked.
+bool PLYFile::readBinary(const char* p, const char* end)
+{
+	const bool needsSwap = (format == PLYFormat::BinaryLittleEndian) != isHostLittleEndian();
+	for (auto& e : elements) {
+		const bool hasList = std::any_of(e.properties.begin(), e.properties.end(), [](const PLYProperty& property) { return property.isList(); });
+		if (!hasList) {
+			size_t stride = 0;
+			for (const auto& property : e.properties) {
+				stride += getSize(property.type);
+			}
+			if (static_cast<size_t>(end - p) / std::max<size_t>(stride, 1) < e.count) {
+				return false;
+			}
+			size_t offset = 0;
+			for (auto& property : e.properties) {
+				const size_t size = getSize(property.type);
+				property.values.resize(e.count * size);
+				unsigned char* values = property.values.data();
+				const char* src = p + offset;
+				Util::parallelForBlocks(e.count, ColumnBlockSize, [&](const size_t first, const size_t last) {
+					for (size_t i = first; i < last; ++i) {
+						std::memcpy(values + i * size, src + i * stride, size);
+					}
+					if (needsSwap) {
+						swapBytes(values + first * size, last - first, size);
+					}
+				}, threadCount);
+				offset += size;
+			}
+			p += stride * e.count;
+			continue;
+		}
+
+		// each row holds at least one count per list.
+		size_t rowSize = 0;
+		for (const auto& property : e.properties) {
+			rowSize += property.isList() ? getSize(property.countType) : getSize(property.type);
+		}
+		if (static_cast<size_t>(end - p) / rowSize < e.count) {
+			return false;
+		}
+		for (auto& property : e.properties) {
+			if (property.isList()) {
+				property.offsets.reserve(e.count + 1);
+				property.offsets.push_back(0);
+			}
+		}
+		for (size_t i = 0; i < e.count; ++i) {
+			for (auto& property : e.properties) {
+				const size_t size = getSize(property.type);
+				size_t n = 1;
+				if (property.isList()) {
+					unsigned char count[8];
+					const size_t countSize = getSize(property.countType);
+					if (static_cast<size_t>(end - p) < countSize) {
+						return false;
+					}
+					std::memcpy(count, p, countSize);
+					if (needsSwap) {
+						swapBytes(count, 1, countSize);
+					}
+					p += countSize;
+					const double d = toDouble(property.countType, count);
+					if (d < 0.0) {
+						return false;
+					}
+					n = static_cast<size_t>(d);
+					property.offsets.push_back(property.offsets.back() + n);
+				}
+				if (static_cast<size_t>(end - p) / size < n) {
+					return false;
+				}
+				const size_t first = property.values.size();
+				property.values.insert(property.values.end(), p, p + n * size);
+				if (needsSwap) {
+					swapBytes(&property.values[first], n, size);
+				}
+				p += n * size;
+			}
+		}
+	}
+	return true;
+}
+
+bool PLYFile::write(const std::string& filename) const
+{
+	std::ofstream stream(filename.c_str(), std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	return write(stream);
+}
+
+bool PLYFile::write(std::ostream& stream) const
+{
+	static const char* formatNames[] = { "ascii", "binary_little_endian", "binary_big_endian" };
+	stream << "ply\n";
+	stream << "format " << formatNames[static_cast<int>(format)] << " 1.0\n";
+	for (const auto& c : comments) {
+		stream << "comment " << c << "\n";
+	}
+	for (const auto& e : elements) {
+		stream << "element " << e.name << " " << e.count << "\n";
+		for (const auto& property : e.properties) {
+			if (property.isList()) {
+				stream << "property list " << toName(property.countType) << " " << toName(property.type) << " " << property.name << "\n";
+			}
+			else {
+				stream << "property " << toName(property.type) << " " << property.name << "\n";
+			}
+		}
+	}
+	stream << "end_header\n";
+	const bool isWritten = (format == PLYFormat::ASCII) ? writeASCII(stream) : writeBinary(stream);
+	stream.flush();
+	return isWritten && stream.good();
+}
+
+bool PLYFile::writeASCII(std::ostream& stream) const
+{
+	const size_t flushSize = 1024 * 1024;
+	std::string buffer;
+	buffer.reserve(flushSize + 1024);
+	for (const auto& e : elements) {
+		for (size_t i = 0; i < e.count; ++i) {
+			for (size_t k = 0; k < e.properties.size(); ++k) {
+				const PLYProperty& property = e.properties[k];
+				const size_t size = getSize(property.type);
+				if (k > 0) {
+					buffer.push_back(' ');
+				}
+				if (!property.isList()) {
+					appendASCIIValue(buffer, property.type, &property.values[i * size]);
+					continue;
+				}
+				const size_t first = property.offsets[i];
+				const size_t last = property.offsets[i + 1];
+				const unsigned int n = static_cast<unsigned int>(last - first);
+				appendASCIIValue(buffer, PLYType::UInt, &n);
+				for (size_t v = first; v < last; ++v) {
+					buffer.push_back(' ');
+					appendASCIIValue(buffer, property.type, &property.values[v * size]);
+				}
+			}
+			buffer.push_back('\n');
+			if (buffer.size() >= flushSize) {
+				stream.write(buffer.data(), buffer.size());
+				buffer.clear();
+			}
+		}
+	}
+	stream.write(buffer.data(), buffer.size());
+	return true;
+}
+
+bool PLYFile::writeBinary(std::ostream& stream) const
+{
+	const bool needsSwap = (format == PLYFormat::BinaryLittleEndian) != isHostLittleEndian();
+	const size_t flushSize = 1024 * 1024;
+	std::vector<unsigned char> buffer;
+	for (const auto& e : elements) {
+		const bool hasList = std::any_of(e.properties.begin(), e.properties.end(), [](const PLYProperty& property) { return property.isList(); });
+		if (!hasList) {
+			// fixed-size rows: a window of rows is interleaved column by column in parallel, then written.
+			size_t stride = 0;
+			for (const auto& property : e.properties) {
+				stride += getSize(property.type);
+			}
+			if (stride == 0) {
+				continue;
+			}
+			const size_t windowCount = std::max<size_t>(1, flushSize / stride);
+			buffer.resize(std::min(windowCount, e.count) * stride);
+			for (size_t row = 0; row < e.count; row += windowCount) {
+				const size_t rowCount = std::min(windowCount, e.count - row);
+				size_t offset = 0;
+				for (const auto& property : e.properties) {
+					const size_t size = getSize(property.type);
+					const unsigned char* values = property.values.data() + row * size;
+					unsigned char* dst = buffer.data() + offset;
+					Util::parallelForBlocks(rowCount, ColumnBlockSize, [&](const size_t first, const size_t last) {
+						for (size_t i = first; i < last; ++i) {
+							std::memcpy(dst + i * stride, values + i * size, size);
+							if (needsSwap) {
+								swapBytes(dst + i * stride, 1, size);
+							}
+						}
+					}, threadCount);
+					offset += size;
+				}
+				stream.write(reinterpret_cast<const char*>(buffer.data()), rowCount * stride);
+			}
+			continue;
+		}
+
+		buffer.clear();
+		for (size_t i = 0; i < e.count; ++i) {
+			for (const auto& property : e.properties) {
+				const size_t size = getSize(property.type);
+				size_t first = i;
+				size_t n = 1;
+				if (property.isList()) {
+					first = property.offsets[i];
+					n = property.offsets[i + 1] - property.offsets[i];
+					unsigned char count[8];
+					const double d = static_cast<double>(n);
+					convert(PLYType::Double, &d, 1, property.countType, count);
+					const size_t countSize = getSize(property.countType);
+					if (needsSwap) {
+						swapBytes(count, 1, countSize);
+					}
+					buffer.insert(buffer.end(), count, count + countSize);
+				}
+				const size_t start = buffer.size();
+				buffer.insert(buffer.end(), property.values.begin() + first * size, property.values.begin() + (first + n) * size);
+				if (needsSwap) {
+					swapBytes(&buffer[start], n, size);
+				}
+			}
+			if (buffer.size() >= flushSize) {
+				stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+				buffer.clear();
+			}
+		}
+		stream.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+	}
+	return true;
+}
+
 bool PLYFile::write(const std::string& filename, const Vector3dVector<float>& points)
 {
-	return false;
+	std::ofstream stream(filename.c_str(), std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	return write(stream, points);
 }
 
 bool PLYFile::write(std::ostream& stream, const Vector3dVector<float>& points)
 {
-	stream << "ply" << std::endl;
-	stream << "format ascii 1.0" << std::endl;
-	stream << "comment" << " " << std::endl;
-	stream << "elememt" << " vertex " << points.size() << std::endl;
-	stream << "property" << " double " << "x" << std::endl;
-	stream << "property" << " double " << "y" << std::endl;
-	stream << "property" << " double " << "z" << std::endl;
-	stream << "end_header" << std::endl;
-	for (const auto& p : points) {
-		stream << p.getX() << " " << p.getY() << " " << p.getZ() << std::endl;
+	clear();
+	format = PLYFormat::ASCII;
+	setPositions(points);
+	return write(stream);
+}
+
+void PLYFile::clear()
+{
+	comments.clear();
+	elements.clear();
+}
+
+void PLYFile::setElement(const std::string& name, const size_t count)
+{
+	for (auto& e : elements) {
+		if (e.name == name) {
+			if (e.count != count) {
+				e.count = count;
+				e.properties.clear();
+			}
+			return;
+		}
+	}
+	PLYElement e;
+	e.name = name;
+	e.count = count;
+	elements.push_back(e);
+}
+
+const PLYElement* PLYFile::findElement(const std::string& name) const
+{
+	for (const auto& e : elements) {
+		if (e.name == name) {
+			return &e;
+		}
+	}
+	return nullptr;
+}
+
+const PLYProperty* PLYFile::findProperty(const std::string& element, const std::string& name) const
+{
+	const PLYElement* e = findElement(element);
+	if (e == nullptr) {
+		return nullptr;
 	}
+	for (const auto& p : e->properties) {
+		if (p.name == name) {
+			return &p;
+		}
+	}
+	return nullptr;
+}
+
+PLYElement* PLYFile::findEditableElement(const std::string& name)
+{
+	return const_cast<PLYElement*>(static_cast<const PLYFile*>(this)->findElement(name));
+}
+
+bool PLYFile::setValues(const std::string& element, const std::string& name, const PLYType type, const PLYType countType, const void* values, const size_t count, const std::vector<size_t>* offsets)
+{
+	PLYElement* e = findEditableElement(element);
+	if (e == nullptr) {
+		return false;
+	}
+	if (offsets != nullptr) {
+		if (!isInteger(countType) || offsets->size() != e->count + 1 || offsets->front() != 0 || offsets->back() != count) {
+			return false;
+		}
+		for (size_t i = 0; i < e->count; ++i) {
+			if ((*offsets)[i + 1] < (*offsets)[i] || (*offsets)[i + 1] - (*offsets)[i] > toMaxCount(countType)) {
+				return false;
+			}
+		}
+	}
+	else if (count != e->count) {
+		return false;
+	}
+
+	auto p = std::find_if(e->properties.begin(), e->properties.end(), [&](const PLYProperty& property) { return property.name == name; });
+	if (p == e->properties.end()) {
+		e->properties.push_back(PLYProperty());
+		p = e->properties.end() - 1;
+		p->name = name;
+	}
+	p->type = type;
+	p->countType = (offsets == nullptr) ? PLYType::None : countType;
+	const unsigned char* bytes = static_cast<const unsigned char*>(values);
+	p->values.assign(bytes, bytes + count * getSize(type));
+	p->offsets = (offsets == nullptr) ? std::vector<size_t>() : *offsets;
 	return true;
 }
+
+void PLYFile::getValues(const PLYProperty& p, const PLYType type, void* values)
+{
+	convert(p.type, p.values.data(), getValueCount(p), type, values);
+}
+
+void PLYFile::setPositions(const Vector3dVector<float>& positions)
+{
+	std::vector<float> xs(positions.size());
+	std::vector<float> ys(positions.size());
+	std::vector<float> zs(positions.size());
+	for (size_t i = 0; i < positions.size(); ++i) {
+		xs[i] = positions[i].getX();
+		ys[i] = positions[i].getY();
+		zs[i] = positions[i].getZ();
+	}
+	setElement("vertex", positions.size());
+	setProperty("vertex", "x", xs);
+	setProperty("vertex", "y", ys);
+	setProperty("vertex", "z", zs);
+}
+
+Vector3dVector<float> PLYFile::getPositions() const
+{
+	return getVectors("x", "y", "z");
+}
+
+bool PLYFile::setNormals(const Vector3dVector<float>& normals)
+{
+	std::vector<float> xs(normals.size());
+	std::vector<float> ys(normals.size());
+	std::vector<float> zs(normals.size());
+	for (size_t i = 0; i < normals.size(); ++i) {
+		xs[i] = normals[i].getX();
+		ys[i] = normals[i].getY();
+		zs[i] = normals[i].getZ();
+	}
+	return
+		setProperty("vertex", "nx", xs) &&
+		setProperty("vertex", "ny", ys) &&
+		setProperty("vertex", "nz", zs);
+}
+
+Vector3dVector<float> PLYFile::getNormals() const
+{
+	return getVectors("nx", "ny", "nz");
+}
+
+Vector3dVector<float> PLYFile::getVectors(const char* x, const char* y, const char* z) const
+{
+	std::vector<float> xs;
+	std::vector<float> ys;
+	std::vector<float> zs;
+	if (!getProperty("vertex", x, xs) || !getProperty("vertex", y, ys) || !getProperty("vertex", z, zs)) {
+		return Vector3dVector<float>();
+	}
+	Vector3dVector<float> vectors(xs.size());
+	for (size_t i = 0; i < xs.size(); ++i) {
+		vectors[i] = Vector3d<float>(xs[i], ys[i], zs[i]);
+	}
+	return vectors;
+}
+
+void PLYFile::setFaces(const std::vector<size_t>& offsets, const std::vector<unsigned int>& indices)
+{
+	size_t maxCount = 0;
+	for (size_t i = 0; i + 1 < offsets.size(); ++i) {
+		maxCount = std::max(maxCount, offsets[i + 1] - offsets[i]);
+	}
+	const std::vector<int> values(indices.begin(), indices.end());
+	setElement("face", offsets.empty() ? 0 : offsets.size() - 1);
+	setListProperty("face", "vertex_indices", offsets, values, (maxCount <= 255) ? PLYType::UChar : PLYType::UInt);
+}
+
+bool PLYFile::getFaces(std::vector<size_t>& offsets, std::vector<unsigned int>& indices) const
+{
+	return
+		getListProperty("face", "vertex_indices", offsets, indices) ||
+		getListProperty("face", "vertex_index", offsets, indices);
+}
@@ -4,23 +4,207 @@
 #include "../Math/Vector.h"
 
 #include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
 
 namespace Crystal {
 	namespace IO {
 
+enum class PLYFormat
+{
+	ASCII,
+	BinaryLittleEndian,
+	BinaryBigEndian,
+};
+
+enum class PLYType
+{
+	None,
+	Char,
+	UChar,
+	Short,
+	UShort,
+	Int,
+	UInt,
+	Float,
+	Double,
+};
+
+template<typename T>
+struct PLYTypeOf { static const PLYType value = PLYType::None; };
+
+template<> struct PLYTypeOf<char> { static const PLYType value = PLYType::Char; };
+template<> struct PLYTypeOf<signed char> { static const PLYType value = PLYType::Char; };
+template<> struct PLYTypeOf<unsigned char> { static const PLYType value = PLYType::UChar; };
+template<> struct PLYTypeOf<short> { static const PLYType value = PLYType::Short; };
+template<> struct PLYTypeOf<unsigned short> { static const PLYType value = PLYType::UShort; };
+template<> struct PLYTypeOf<int> { static const PLYType value = PLYType::Int; };
+template<> struct PLYTypeOf<unsigned int> { static const PLYType value = PLYType::UInt; };
+template<> struct PLYTypeOf<float> { static const PLYType value = PLYType::Float; };
+template<> struct PLYTypeOf<double> { static const PLYType value = PLYType::Double; };
+
+// One property column. Scalar values are stored packed in their file type, one per element; list properties also
+// keep offsets, so the values of element i are [offsets[i], offsets[i + 1]).
+struct PLYProperty
+{
+	std::string name;
+	PLYType type;
+	PLYType countType;
+	std::vector<unsigned char> values;
+	std::vector<size_t> offsets;
+
+	bool isList() const { return countType != PLYType::None; }
+};
+
+struct PLYElement
+{
+	std::string name;
+	size_t count;
+	std::vector<PLYProperty> properties;
+};
+
+// PLY in ASCII and little/big-endian binary with any elements and typed scalar or list properties. Properties are
+// held as columns (structure of arrays) in their file type and converted on access. Binary elements without list
+// properties are decoded column by column in parallel straight from the memory-mapped file.
 class PLYFile final
 {
 public:
+	PLYFile() :
+		format(PLYFormat::BinaryLittleEndian),
+		threadCount(0)
+	{}
+
+	~PLYFile() = default;
+
 	bool read(const std::string& filename);
 
 	bool read(std::istream& stream);
 
+	bool read(const char* begin, const char* end);
+
+	// parses only the header at begin; elements and properties are set up without values or list offsets, so nothing
+	// is allocated for the counts it declares. returns the header size in bytes, or 0 when it is invalid.
+	size_t readHeader(const char* begin, const char* end);
+
+	bool write(const std::string& filename) const;
+
+	bool write(std::ostream& stream) const;
+
+	// replaces the contents with the points as an ASCII vertex element with float x, y and z.
 	bool write(const std::string& filename, const Math::Vector3dVector<float>& points);
 
 	bool write(std::ostream& stream, const Math::Vector3dVector<float>& points);
+
+	void clear();
+
+	void setFormat(const PLYFormat format) { this->format = format; }
+
+	PLYFormat getFormat() const { return format; }
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	void setComments(const std::vector<std::string>& comments) { this->comments = comments; }
+
+	const std::vector<std::string>& getComments() const { return comments; }
+
+	const std::vector<PLYElement>& getElements() const { return elements; }
+
+	// adds the element, or resizes it and drops its properties when it exists.
+	void setElement(const std::string& name, const size_t count);
+
+	const PLYElement* findElement(const std::string& name) const;
+
+	const PLYProperty* findProperty(const std::string& element, const std::string& name) const;
+
+	// one value per element; false when the element is missing or the size differs.
+	template<typename T>
+	bool setProperty(const std::string& element, const std::string& name, const std::vector<T>& values) {
+		static_assert(PLYTypeOf<T>::value != PLYType::None, "unsupported property type");
+		return setValues(element, name, PLYTypeOf<T>::value, PLYType::None, values.data(), values.size(), nullptr);
+	}
+
+	// offsets has one entry per element plus one; each list length must fit countType.
+	template<typename T>
+	bool setListProperty(const std::string& element, const std::string& name, const std::vector<size_t>& offsets, const std::vector<T>& values, const PLYType countType = PLYType::UChar) {
+		static_assert(PLYTypeOf<T>::value != PLYType::None, "unsupported property type");
+		return setValues(element, name, PLYTypeOf<T>::value, countType, values.data(), values.size(), &offsets);
+	}
+
+	// converts the column to T; false when the property is missing.
+	template<typename T>
+	bool getProperty(const std::string& element, const std::string& name, std::vector<T>& values) const {
+		static_assert(PLYTypeOf<T>::value != PLYType::None, "unsupported property type");
+		const PLYProperty* p = findProperty(element, name);
+		if (p == nullptr || p->isList()) {
+			return false;
+		}
+		values.resize(getValueCount(*p));
+		getValues(*p, PLYTypeOf<T>::value, values.data());
+		return true;
+	}
+
+	template<typename T>
+	bool getListProperty(const std::string& element, const std::string& name, std::vector<size_t>& offsets, std::vector<T>& values) const {
+		static_assert(PLYTypeOf<T>::value != PLYType::None, "unsupported property type");
+		const PLYProperty* p = findProperty(element, name);
+		if (p == nullptr || !p->isList()) {
+			return false;
+		}
+		offsets = p->offsets;
+		values.resize(getValueCount(*p));
+		getValues(*p, PLYTypeOf<T>::value, values.data());
+		return true;
+	}
+
+	// "vertex" x, y, z.
+	void setPositions(const Math::Vector3dVector<float>& positions);
+
+	Math::Vector3dVector<float> getPositions() const;
+
+	// "vertex" nx, ny, nz; the vertex element must exist.
+	bool setNormals(const Math::Vector3dVector<float>& normals);
+
+	Math::Vector3dVector<float> getNormals() const;
+
+	// "face" vertex_indices (or vertex_index when read).
+	void setFaces(const std::vector<size_t>& offsets, const std::vector<unsigned int>& indices);
+
+	bool getFaces(std::vector<size_t>& offsets, std::vector<unsigned int>& indices) const;
+
+	static size_t getSize(const PLYType type);
+
 private:
+	PLYFormat format;
+	unsigned int threadCount;
+	std::vector<std::string> comments;
+	std::vector<PLYElement> elements;
+
+	PLYElement* findEditableElement(const std::string& name);
+
+	bool setValues(const std::string& element, const std::string& name, const PLYType type, const PLYType countType, const void* values, const size_t count, const std::vector<size_t>* offsets);
+
+	static size_t getValueCount(const PLYProperty& p) { return p.values.size() / getSize(p.type); }
+
+	static void getValues(const PLYProperty& p, const PLYType type, void* values);
+
+	Math::Vector3dVector<float> getVectors(const char* x, const char* y, const char* z) const;
+
+	bool parseHeader(const char*& p, const char* end);
+
+	bool readASCII(const char* p, const char* end);
+
+	bool readBinary(const char* p, const char* end);
+
+	bool writeASCII(std::ostream& stream) const;
+
+	bool writeBinary(std::ostream& stream) const;
 };
+
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -2,9 +2,47 @@
 
 #include "PLYFile.h"
 
+#include <sstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
 using namespace Crystal::IO;
 
-TEST(PLYFileTest, TestRead)
+class PLYFileTest : public testing::Test {
+protected:
+	static void expectSame(const PLYFile& expected, const PLYFile& actual)
+	{
+		EXPECT_EQ(expected.getComments(), actual.getComments());
+		ASSERT_EQ(expected.getElements().size(), actual.getElements().size());
+		for (size_t i = 0; i < expected.getElements().size(); ++i) {
+			const PLYElement& e = expected.getElements()[i];
+			const PLYElement& a = actual.getElements()[i];
+			EXPECT_EQ(e.name, a.name);
+			EXPECT_EQ(e.count, a.count);
+			ASSERT_EQ(e.properties.size(), a.properties.size());
+			for (size_t j = 0; j < e.properties.size(); ++j) {
+				EXPECT_EQ(e.properties[j].name, a.properties[j].name);
+				EXPECT_EQ(e.properties[j].type, a.properties[j].type);
+				EXPECT_EQ(e.properties[j].countType, a.properties[j].countType);
+				EXPECT_EQ(e.properties[j].values, a.properties[j].values);
+				EXPECT_EQ(e.properties[j].offsets, a.properties[j].offsets);
+			}
+		}
+	}
+
+	static PLYFile toRoundTrip(PLYFile& file, const PLYFormat format)
+	{
+		file.setFormat(format);
+		std::stringstream stream;
+		EXPECT_TRUE(file.write(stream));
+		PLYFile actual;
+		EXPECT_TRUE(actual.read(stream));
+		EXPECT_EQ(format, actual.getFormat());
+		return actual;
+	}
+};
+
+TEST_F(PLYFileTest, TestRead)
 {
 	std::stringstream stream;
 	stream
@@ -19,4 +57,204 @@ TEST(PLYFileTest, TestRead)
 		<< "0.0 0.0 0.0" << std::endl
 		<< "1.0 2.0 3.0" << std::endl
 		<< "3.0 2.0 1.0" << std::endl;
-}
\ No newline at end of file
+	PLYFile file;
+	EXPECT_TRUE(file.read(stream));
+	EXPECT_EQ(PLYFormat::ASCII, file.getFormat());
+	EXPECT_EQ(std::vector<std::string>{ "Kinect v1 generated" }, file.getComments());
+	const Vector3dVector<float> expected = { Vector3d<float>(0.0f, 0.0f, 0.0f), Vector3d<float>(1.0f, 2.0f, 3.0f), Vector3d<float>(3.0f, 2.0f, 1.0f) };
+	EXPECT_EQ(expected, file.getPositions());
+	EXPECT_EQ(PLYType::Double, file.findProperty("vertex", "x")->type);
+}
+
+TEST_F(PLYFileTest, TestReadFaces)
+{
+	std::stringstream stream;
+	stream
+		<< "ply\r\n"
+		<< "format ascii 1.0\r\n"
+		<< "obj_info generated\r\n"
+		<< "element vertex 4\r\n"
+		<< "property float32 x\r\n"
+		<< "property float32 y\r\n"
+		<< "property float32 z\r\n"
+		<< "property uint8 red\r\n"
+		<< "element face 2\r\n"
+		<< "property list uchar int vertex_index\r\n"
+		<< "end_header\r\n"
+		<< "0 0 0 255\r\n"
+		<< "1 0 0 0\r\n"
+		<< "1 1 0 128\r\n"
+		<< "0 1 0 7\r\n"
+		<< "3 0 1 2\r\n"
+		<< "4 0 1 2 3\r\n";
+	PLYFile file;
+	EXPECT_TRUE(file.read(stream));
+	EXPECT_EQ(4, file.getPositions().size());
+	std::vector<int> reds;
+	EXPECT_TRUE(file.getProperty("vertex", "red", reds));
+	EXPECT_EQ(std::vector<int>({ 255, 0, 128, 7 }), reds);
+	std::vector<size_t> offsets;
+	std::vector<unsigned int> indices;
+	EXPECT_TRUE(file.getFaces(offsets, indices));
+	EXPECT_EQ(std::vector<size_t>({ 0, 3, 7 }), offsets);
+	EXPECT_EQ(std::vector<unsigned int>({ 0, 1, 2, 0, 1, 2, 3 }), indices);
+}
+
+TEST_F(PLYFileTest, TestRoundTrip)
+{
+	for (const auto format : { PLYFormat::ASCII, PLYFormat::BinaryLittleEndian, PLYFormat::BinaryBigEndian }) {
+		PLYFile file;
+		file.setPositions({ Vector3d<float>(0.0f, 0.0f, 0.0f), Vector3d<float>(1.0f, 0.0f, 0.0f), Vector3d<float>(0.0f, 1.0f, 0.0f), Vector3d<float>(0.5f, 0.25f, -1.0f) });
+		file.setNormals(Vector3dVector<float>(4, Vector3d<float>(0.0f, 0.0f, 1.0f)));
+		file.setFaces({ 0, 3, 7 }, { 0, 1, 2, 0, 1, 3, 2 });
+		file.setComments({ "made by test" });
+		const PLYFile& actual = toRoundTrip(file, format);
+		expectSame(file, actual);
+		EXPECT_EQ(file.getPositions(), actual.getPositions());
+		EXPECT_EQ(file.getNormals(), actual.getNormals());
+	}
+}
+
+TEST_F(PLYFileTest, TestCustomProperties)
+{
+	PLYFile file;
+	file.setElement("particle", 3);
+	EXPECT_TRUE(file.setProperty("particle", "density", std::vector<double>{ 1000.0, 0.1, -1.0e-300 }));
+	EXPECT_TRUE(file.setProperty("particle", "id", std::vector<unsigned int>{ 0, 4000000000u, 7 }));
+	EXPECT_TRUE(file.setProperty("particle", "red", std::vector<unsigned char>{ 0, 128, 255 }));
+	EXPECT_TRUE(file.setProperty("particle", "phase", std::vector<short>{ -32768, 0, 32767 }));
+	EXPECT_TRUE(file.setListProperty("particle", "neighbors", { 0, 0, 2, 3 }, std::vector<float>{ 0.1f, 1.0e-8f, 3.0f }, PLYType::UShort));
+	EXPECT_FALSE(file.setProperty("particle", "wrong", std::vector<float>{ 1.0f }));
+	EXPECT_FALSE(file.setProperty("missing", "x", std::vector<float>{ 1.0f }));
+	EXPECT_FALSE(file.setListProperty("particle", "wrong", { 0, 1, 2, 4 }, std::vector<float>{ 1.0f, 2.0f, 3.0f }));
+	for (const auto format : { PLYFormat::ASCII, PLYFormat::BinaryLittleEndian, PLYFormat::BinaryBigEndian }) {
+		expectSame(file, toRoundTrip(file, format));
+	}
+	std::vector<float> densities;
+	EXPECT_TRUE(file.getProperty("particle", "density", densities));
+	EXPECT_EQ(std::vector<float>({ 1000.0f, 0.1f, -0.0f }), densities);
+}
+
+TEST_F(PLYFileTest, TestLongList)
+{
+	std::vector<unsigned int> indices(300);
+	for (unsigned int i = 0; i < 300; ++i) {
+		indices[i] = i;
+	}
+	PLYFile file;
+	file.setFaces({ 0, 300 }, indices);
+	EXPECT_EQ(PLYType::UInt, file.findProperty("face", "vertex_indices")->countType);
+	EXPECT_FALSE(file.setListProperty("face", "other", { 0, 300 }, indices, PLYType::UChar));
+}
+
+TEST_F(PLYFileTest, TestBigEndianBytes)
+{
+	PLYFile file;
+	file.setFormat(PLYFormat::BinaryBigEndian);
+	file.setElement("v", 1);
+	file.setProperty("v", "a", std::vector<unsigned short>{ 0x0102 });
+	file.setProperty("v", "b", std::vector<int>{ -2 });
+	std::stringstream stream;
+	EXPECT_TRUE(file.write(stream));
+	const std::string& s = stream.str();
+	EXPECT_EQ(std::string("\x01\x02\xff\xff\xff\xfe", 6), s.substr(s.size() - 6));
+}
+
+TEST_F(PLYFileTest, TestInvalid)
+{
+	const std::vector<std::string> headers = {
+		"",
+		"plyx\nformat ascii 1.0\nend_header\n",
+		"ply\nformat ascii 1.0\n",
+		"ply\nend_header\n",
+		"ply\nformat binary_middle_endian 1.0\nend_header\n",
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty float128 x\nend_header\n0\n",
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty list float int i\nend_header\n1 0\n",
+		"ply\nformat ascii 1.0\nelement vertex 2\nproperty float x\nend_header\n0\n",
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty int x\nend_header\n0.5\n",
+		// integers outside their type.
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty uchar x\nend_header\n256\n",
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty char x\nend_header\n-129\n",
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty uint x\nend_header\n-1\n",
+		"ply\nformat ascii 1.0\nelement vertex 1\nproperty int x\nend_header\n99999999999999999999\n",
+		"ply\nformat binary_little_endian 1.0\nelement vertex 2\nproperty float x\nend_header\nabcd",
+		"ply\nformat binary_little_endian 1.0\nelement face 1\nproperty list uchar int i\nend_header\n\x02\x01\x00\x00\x00",
+		// counts far beyond the data must fail without allocating for them.
+		"ply\nformat ascii 1.0\nelement vertex 2000000000000000000\nproperty float x\nend_header\n0\n",
+		"ply\nformat ascii 1.0\nelement face 2000000000000000000\nproperty list uchar int i\nend_header\n1 0\n",
+		"ply\nformat ascii 1.0\nelement face 1\nproperty list uint int i\nend_header\n4000000000 0\n",
+		"ply\nformat ascii 1.0\nelement vertex 6\nproperty float x\nproperty float y\nproperty float z\nend_header\n0 0 0 0 0 0\n",
+		"ply\nformat binary_little_endian 1.0\nelement vertex 2000000000000000000\nproperty float x\nproperty float y\nend_header\nabcd",
+		"ply\nformat binary_little_endian 1.0\nelement face 2000000000000000000\nproperty list uchar int i\nend_header\n\x01\x01\x00\x00\x00",
+	};
+	for (const auto& h : headers) {
+		PLYFile file;
+		EXPECT_FALSE(file.read(h.data(), h.data() + h.size())) << h;
+		EXPECT_TRUE(file.getElements().empty());
+	}
+}
+
+TEST_F(PLYFileTest, TestReadIntegerLimits)
+{
+	const std::string s = "ply\nformat ascii 1.0\nelement vertex 1\nproperty char a\nproperty uchar b\nproperty int c\nproperty uint d\nend_header\n"
+		"-128 255 -2147483648 4294967295\n";
+	PLYFile file;
+	ASSERT_TRUE(file.read(s.data(), s.data() + s.size()));
+	std::vector<signed char> a;
+	std::vector<unsigned char> b;
+	std::vector<int> c;
+	std::vector<unsigned int> d;
+	EXPECT_TRUE(file.getProperty("vertex", "a", a));
+	EXPECT_TRUE(file.getProperty("vertex", "b", b));
+	EXPECT_TRUE(file.getProperty("vertex", "c", c));
+	EXPECT_TRUE(file.getProperty("vertex", "d", d));
+	EXPECT_EQ(std::vector<signed char>(1, -128), a);
+	EXPECT_EQ(std::vector<unsigned char>(1, 255), b);
+	EXPECT_EQ(std::vector<int>(1, -2147483647 - 1), c);
+	EXPECT_EQ(std::vector<unsigned int>(1, 4294967295u), d);
+}
+
+TEST_F(PLYFileTest, TestReadHeader)
+{
+	const std::string s = "ply\nformat binary_little_endian 1.0\nelement face 2000000000000000000\nproperty list uchar int i\nend_header\n";
+	PLYFile file;
+	EXPECT_EQ(s.size(), file.readHeader(s.data(), s.data() + s.size()));
+	ASSERT_EQ(1, file.getElements().size());
+	EXPECT_EQ(2000000000000000000u, file.getElements()[0].count);
+	EXPECT_TRUE(file.getElements()[0].properties[0].isList());
+	EXPECT_TRUE(file.getElements()[0].properties[0].offsets.empty());
+}
+
+TEST_F(PLYFileTest, TestWritePoints)
+{
+	const Vector3dVector<float> points = { Vector3d<float>(0.1f, 2.0f, 3.0f), Vector3d<float>(-1.0f, 0.0f, 1.5f) };
+	std::stringstream stream;
+	PLYFile file;
+	EXPECT_TRUE(file.write(stream, points));
+	EXPECT_NE(std::string::npos, stream.str().find("element vertex 2\n"));
+	EXPECT_NE(std::string::npos, stream.str().find("end_header\n0.1 2 3\n-1 0 1.5\n"));
+	PLYFile actual;
+	EXPECT_TRUE(actual.read(stream));
+	EXPECT_EQ(points, actual.getPositions());
+}
+
+TEST_F(PLYFileTest, TestReadFile)
+{
+	const std::string filename = "PLYFileTest.ply";
+	std::vector<float> xs(100000);
+	for (size_t i = 0; i < xs.size(); ++i) {
+		xs[i] = static_cast<float>(i) * 0.5f;
+	}
+	PLYFile file;
+	file.setThreadCount(4);
+	file.setElement("vertex", xs.size());
+	file.setProperty("vertex", "x", xs);
+	file.setProperty("vertex", "y", xs);
+	file.setProperty("vertex", "z", xs);
+	file.setFormat(PLYFormat::BinaryBigEndian);
+	EXPECT_TRUE(file.write(filename));
+	PLYFile actual;
+	EXPECT_TRUE(actual.read(filename));
+	expectSame(file, actual);
+	std::remove(filename.c_str());
+}
@@ -0,0 +1,541 @@
+#include "PNGFile.h"
+
+#include <fstream>
+#include <cstring>
+#include <cstdlib>
+#include <iterator>
+#include <algorithm>
+
+using namespace Crystal::IO;
+
+namespace {
+	const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+
+	// built during static initialization, so concurrent slice writers never race on it.
+	struct CRCTable
+	{
+		CRCTable() {
+			for (unsigned int n = 0; n < 256; ++n) {
+				unsigned int c = n;
+				for (int k = 0; k < 8; ++k) {
+					c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+				}
+				values[n] = c;
+			}
+		}
+
+		unsigned int values[256];
+	};
+
+	const CRCTable crcTable;
+
+	unsigned int toCRC(const unsigned char* data, const size_t size)
+	{
+		unsigned int crc = 0xFFFFFFFFu;
+		for (size_t i = 0; i < size; ++i) {
+			crc = crcTable.values[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+		}
+		return crc ^ 0xFFFFFFFFu;
+	}
+
+	unsigned int toAdler32(const unsigned char* data, const size_t size)
+	{
+		unsigned int a = 1;
+		unsigned int b = 0;
+		for (size_t i = 0; i < size; ++i) {
+			a = (a + data[i]) % 65521;
+			b = (b + a) % 65521;
+		}
+		return (b << 16) | a;
+	}
+
+	unsigned int readUInt32(const unsigned char* p)
+	{
+		return (static_cast<unsigned int>(p[0]) << 24) | (p[1] << 16) | (p[2] << 8) | p[3];
+	}
+
+	void appendUInt32(std::vector<unsigned char>& out, const unsigned int v)
+	{
+		out.push_back(static_cast<unsigned char>(v >> 24));
+		out.push_back(static_cast<unsigned char>(v >> 16));
+		out.push_back(static_cast<unsigned char>(v >> 8));
+		out.push_back(static_cast<unsigned char>(v));
+	}
+
+	void writeChunk(std::ostream& stream, const char* type, const std::vector<unsigned char>& data)
+	{
+		std::vector<unsigned char> chunk;
+		chunk.reserve(data.size() + 12);
+		appendUInt32(chunk, static_cast<unsigned int>(data.size()));
+		chunk.insert(chunk.end(), type, type + 4);
+		chunk.insert(chunk.end(), data.begin(), data.end());
+		appendUInt32(chunk, toCRC(chunk.data() + 4, data.size() + 4));
+		stream.write(reinterpret_cast<const char*>(chunk.data()), chunk.size());
+	}
+
+	// Inflate (RFC 1951) over a complete zlib stream held in memory. Output beyond maxSize bytes fails the stream.
+	class Inflater
+	{
+	public:
+		Inflater(const unsigned char* data, const size_t size, const size_t maxSize) :
+			data(data),
+			size(size),
+			maxSize(maxSize),
+			pos(0),
+			bitBuffer(0),
+			bitCount(0)
+		{}
+
+		bool inflate(std::vector<unsigned char>& out) {
+			if (size < 2 || ((data[0] << 8) | data[1]) % 31 != 0 || (data[0] & 0x0F) != 8 || (data[1] & 0x20) != 0) {
+				return false;
+			}
+			pos = 2;
+			for (bool isLast = false; !isLast;) {
+				int bit;
+				int type;
+				if (!getBits(1, bit) || !getBits(2, type)) {
+					return false;
+				}
+				isLast = (bit != 0);
+				bool isOk = false;
+				if (type == 0) {
+					isOk = readStored(out);
+				}
+				else if (type == 1) {
+					isOk = readFixed(out);
+				}
+				else if (type == 2) {
+					isOk = readDynamic(out);
+				}
+				if (!isOk) {
+					return false;
+				}
+			}
+			return true;
+		}
+
+	private:
+		struct Huffman
+		{
+			short counts[16];
+			short symbols[288];
+		};
+
+		const unsigned char* data;
+		size_t size;
+		size_t maxSize;
+		size_t pos;
+		unsigned int bitBuffer;
+		int bitCount;
+
+		bool getBits(const int need, int& value) {
+			while (bitCount < need) {
+				if (pos >= size) {
+					return false;
+				}
+				bitBuffer |= static_cast<unsigned int>(data[pos++]) << bitCount;
+				bitCount += 8;
+			}
+			value = static_cast<int>(bitBuffer & ((1u << need) - 1));
+			bitBuffer >>= need;
+			bitCount -= need;
+			return true;
+		}
+
+		bool readStored(std::vector<unsigned char>& out) {
+			bitBuffer = 0;
+			bitCount = 0;
+			if (pos + 4 > size) {
+				return false;
+			}
+			const unsigned int length = data[pos] | (data[pos + 1] << 8);
+			const unsigned int complement = data[pos + 2] | (data[pos + 3] << 8);
+			pos += 4;
+			if (length != (~complement & 0xFFFF) || pos + length > size || length > maxSize - out.size()) {
+				return false;
+			}
+			out.insert(out.end(), data + pos, data + pos + length);
+			pos += length;
+			return true;
+		}
+
+		static bool build(Huffman& h, const short* lengths, const int n) {
+			std::fill(std::begin(h.counts), std::end(h.counts), short(0));
+			for (int i = 0; i < n; ++i) {
+				h.counts[lengths[i]]++;
+			}
+			if (h.counts[0] == n) {
+				return true;
+			}
+			int left = 1;
+			for (int len = 1; len < 16; ++len) {
+				left <<= 1;
+				left -= h.counts[len];
+				if (left < 0) {
+					return false;
+				}
+			}
+			short offsets[16];
+			offsets[1] = 0;
+			for (int len = 1; len < 15; ++len) {
+				offsets[len + 1] = offsets[len] + h.counts[len];
+			}
+			for (int i = 0; i < n; ++i) {
+				if (lengths[i] != 0) {
+					h.symbols[offsets[lengths[i]]++] = static_cast<short>(i);
+				}
+			}
+			return true;
+		}
+
+		bool decode(const Huffman& h, int& symbol) {
+			int code = 0;
+			int first = 0;
+			int index = 0;
+			for (int len = 1; len < 16; ++len) {
+				int bit;
+				if (!getBits(1, bit)) {
+					return false;
+				}
+				code |= bit;
+				const int count = h.counts[len];
+				if (code - count < first) {
+					symbol = h.symbols[index + (code - first)];
+					return true;
+				}
+				index += count;
+				first += count;
+				first <<= 1;
+				code <<= 1;
+			}
+			return false;
+		}
+
+		bool readCodes(std::vector<unsigned char>& out, const Huffman& lengthCodes, const Huffman& distCodes) {
+			static const short lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31, 35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+			static const short lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+			static const short distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193, 257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+			static const short distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6, 7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+			for (;;) {
+				int symbol;
+				if (!decode(lengthCodes, symbol)) {
+					return false;
+				}
+				if (symbol < 256) {
+					if (out.size() >= maxSize) {
+						return false;
+					}
+					out.push_back(static_cast<unsigned char>(symbol));
+					continue;
+				}
+				if (symbol == 256) {
+					return true;
+				}
+				symbol -= 257;
+				if (symbol >= 29) {
+					return false;
+				}
+				int extra;
+				if (!getBits(lengthExtra[symbol], extra)) {
+					return false;
+				}
+				const size_t length = lengthBase[symbol] + extra;
+				if (!decode(distCodes, symbol) || symbol >= 30 || !getBits(distExtra[symbol], extra)) {
+					return false;
+				}
+				const size_t distance = distBase[symbol] + extra;
+				if (distance > out.size() || length > maxSize - out.size()) {
+					return false;
+				}
+				const size_t from = out.size() - distance;
+				for (size_t i = 0; i < length; ++i) {
+					out.push_back(out[from + i]);
+				}
+			}
+		}
+
+		bool readFixed(std::vector<unsigned char>& out) {
+			short lengths[288];
+			for (int i = 0; i < 144; ++i) { lengths[i] = 8; }
+			for (int i = 144; i < 256; ++i) { lengths[i] = 9; }
+			for (int i = 256; i < 280; ++i) { lengths[i] = 7; }
+			for (int i = 280; i < 288; ++i) { lengths[i] = 8; }
+			Huffman lengthCodes;
+			build(lengthCodes, lengths, 288);
+			for (int i = 0; i < 30; ++i) { lengths[i] = 5; }
+			Huffman distCodes;
+			build(distCodes, lengths, 30);
+			return readCodes(out, lengthCodes, distCodes);
+		}
+
+		bool readDynamic(std::vector<unsigned char>& out) {
+			static const short order[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+			int nlen;
+			int ndist;
+			int ncode;
+			if (!getBits(5, nlen) || !getBits(5, ndist) || !getBits(4, ncode)) {
+				return false;
+			}
+			nlen += 257;
+			ndist += 1;
+			ncode += 4;
+			if (nlen > 286 || ndist > 30) {
+				return false;
+			}
+			short lengths[320] = {};
+			for (int i = 0; i < ncode; ++i) {
+				int v;
+				if (!getBits(3, v)) {
+					return false;
+				}
+				lengths[order[i]] = static_cast<short>(v);
+			}
+			Huffman codeCodes;
+			if (!build(codeCodes, lengths, 19)) {
+				return false;
+			}
+			for (int i = 0; i < 19; ++i) {
+				lengths[i] = 0;
+			}
+			for (int i = 0; i < nlen + ndist;) {
+				int symbol;
+				if (!decode(codeCodes, symbol)) {
+					return false;
+				}
+				if (symbol < 16) {
+					lengths[i++] = static_cast<short>(symbol);
+					continue;
+				}
+				short value = 0;
+				int repeat;
+				if (symbol == 16) {
+					if (i == 0 || !getBits(2, repeat)) {
+						return false;
+					}
+					value = lengths[i - 1];
+					repeat += 3;
+				}
+				else if (symbol == 17) {
+					if (!getBits(3, repeat)) {
+						return false;
+					}
+					repeat += 3;
+				}
+				else {
+					if (!getBits(7, repeat)) {
+						return false;
+					}
+					repeat += 11;
+				}
+				if (i + repeat > nlen + ndist) {
+					return false;
+				}
+				while (repeat--) {
+					lengths[i++] = value;
+				}
+			}
+			Huffman lengthCodes;
+			Huffman distCodes;
+			if (!build(lengthCodes, lengths, nlen) || !build(distCodes, lengths + nlen, ndist)) {
+				return false;
+			}
+			return readCodes(out, lengthCodes, distCodes);
+		}
+	};
+
+	int toPaeth(const int a, const int b, const int c)
+	{
+		const int p = a + b - c;
+		const int pa = std::abs(p - a);
+		const int pb = std::abs(p - b);
+		const int pc = std::abs(p - c);
+		if (pa <= pb && pa <= pc) {
+			return a;
+		}
+		return (pb <= pc) ? b : c;
+	}
+
+	// reverses the per-row filters in place. raw holds a filter byte followed by rowSize bytes for every row.
+	bool unfilter(std::vector<unsigned char>& raw, const size_t rowSize, const unsigned int height, const size_t bytesPerPixel)
+	{
+		for (unsigned int y = 0; y < height; ++y) {
+			unsigned char* row = raw.data() + y * (rowSize + 1);
+			const unsigned char filter = row[0];
+			unsigned char* cur = row + 1;
+			const unsigned char* prev = (y == 0) ? nullptr : cur - (rowSize + 1);
+			for (size_t i = 0; i < rowSize; ++i) {
+				const int a = (i >= bytesPerPixel) ? cur[i - bytesPerPixel] : 0;
+				const int b = (prev != nullptr) ? prev[i] : 0;
+				const int c = (prev != nullptr && i >= bytesPerPixel) ? prev[i - bytesPerPixel] : 0;
+				int predicted = 0;
+				switch (filter) {
+				case 0: predicted = 0; break;
+				case 1: predicted = a; break;
+				case 2: predicted = b; break;
+				case 3: predicted = (a + b) / 2; break;
+				case 4: predicted = toPaeth(a, b, c); break;
+				default: return false;
+				}
+				cur[i] = static_cast<unsigned char>(cur[i] + predicted);
+			}
+		}
+		return true;
+	}
+}
+
+bool PNGFile::read(const std::string& filename)
+{
+	std::ifstream stream(filename, std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	return read(stream);
+}
+
+bool PNGFile::read(std::istream& stream)
+{
+	const std::vector<unsigned char> file((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	if (file.size() < 8 || std::memcmp(file.data(), signature, 8) != 0) {
+		return false;
+	}
+
+	unsigned int colorType = 0;
+	std::vector<unsigned char> compressed;
+	bool hasHeader = false;
+	for (size_t pos = 8; pos + 12 <= file.size();) {
+		const unsigned int length = readUInt32(&file[pos]);
+		if (length > file.size() - pos - 12) {
+			return false;
+		}
+		const unsigned char* type = &file[pos + 4];
+		const unsigned char* data = &file[pos + 8];
+		if (std::memcmp(type, "IHDR", 4) == 0) {
+			if (length != 13 || data[10] != 0 || data[11] != 0 || data[12] != 0) {
+				return false;
+			}
+			width = readUInt32(data);
+			height = readUInt32(data + 4);
+			bitDepth = data[8];
+			colorType = data[9];
+			hasHeader = true;
+		}
+		else if (std::memcmp(type, "IDAT", 4) == 0) {
+			compressed.insert(compressed.end(), data, data + length);
+		}
+		else if (std::memcmp(type, "IEND", 4) == 0) {
+			break;
+		}
+		pos += 12 + length;
+	}
+
+	unsigned int channels = 0;
+	switch (colorType) {
+	case 0: channels = 1; break;
+	case 2: channels = 3; break;
+	case 4: channels = 2; break;
+	case 6: channels = 4; break;
+	default: return false;
+	}
+	if (!hasHeader || (bitDepth != 8 && bitDepth != 16) || width == 0 || height == 0 ||
+		width > MaxDimension || height > MaxDimension || static_cast<size_t>(width) * height > MaxPixelCount) {
+		return false;
+	}
+
+	// deflate expands at most 1032 times, so a short stream cannot claim a huge image.
+	const size_t bytesPerPixel = channels * bitDepth / 8;
+	const size_t rowSize = bytesPerPixel * width;
+	const size_t rawSize = (rowSize + 1) * height;
+	if (rawSize / 1032 > compressed.size()) {
+		return false;
+	}
+	std::vector<unsigned char> raw;
+	raw.reserve(rawSize);
+	Inflater inflater(compressed.data(), compressed.size(), rawSize);
+	if (!inflater.inflate(raw) || raw.size() != rawSize || !unfilter(raw, rowSize, height, bytesPerPixel)) {
+		return false;
+	}
+
+	// gray and gray+alpha keep the gray sample, color is averaged. alpha is dropped.
+	const unsigned int colorChannels = (channels >= 3) ? 3 : 1;
+	pixels.resize(static_cast<size_t>(width) * height);
+	for (unsigned int y = 0; y < height; ++y) {
+		const unsigned char* row = raw.data() + y * (rowSize + 1) + 1;
+		for (unsigned int x = 0; x < width; ++x) {
+			const unsigned char* p = row + x * bytesPerPixel;
+			unsigned int sum = 0;
+			for (unsigned int c = 0; c < colorChannels; ++c) {
+				sum += (bitDepth == 16) ? ((p[c * 2] << 8) | p[c * 2 + 1]) : p[c];
+			}
+			pixels[y * width + x] = static_cast<unsigned short>(sum / colorChannels);
+		}
+	}
+	return true;
+}
+
+bool PNGFile::write(const std::string& filename) const
+{
+	std::ofstream stream(filename, std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	return write(stream);
+}
+
+bool PNGFile::write(std::ostream& stream) const
+{
+	if ((bitDepth != 8 && bitDepth != 16) || width == 0 || height == 0 || pixels.size() != static_cast<size_t>(width) * height) {
+		return false;
+	}
+	stream.write(reinterpret_cast<const char*>(signature), sizeof(signature));
+
+	std::vector<unsigned char> header;
+	appendUInt32(header, width);
+	appendUInt32(header, height);
+	header.push_back(static_cast<unsigned char>(bitDepth));
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	header.push_back(0);
+	writeChunk(stream, "IHDR", header);
+
+	// unfiltered rows, big-endian samples.
+	const size_t bytesPerPixel = bitDepth / 8;
+	const size_t rowSize = width * bytesPerPixel + 1;
+	std::vector<unsigned char> raw(rowSize * height, 0);
+	for (unsigned int y = 0; y < height; ++y) {
+		unsigned char* row = raw.data() + y * rowSize + 1;
+		for (unsigned int x = 0; x < width; ++x) {
+			const unsigned short v = pixels[y * width + x];
+			if (bitDepth == 16) {
+				row[x * 2] = static_cast<unsigned char>(v >> 8);
+				row[x * 2 + 1] = static_cast<unsigned char>(v);
+			}
+			else {
+				row[x] = static_cast<unsigned char>(v);
+			}
+		}
+	}
+
+	// zlib stream of stored deflate blocks.
+	std::vector<unsigned char> compressed;
+	compressed.reserve(raw.size() + raw.size() / 65535 * 5 + 11);
+	compressed.push_back(0x78);
+	compressed.push_back(0x01);
+	size_t pos = 0;
+	do {
+		const size_t length = std::min<size_t>(65535, raw.size() - pos);
+		const bool isLast = (pos + length == raw.size());
+		compressed.push_back(isLast ? 1 : 0);
+		compressed.push_back(static_cast<unsigned char>(length));
+		compressed.push_back(static_cast<unsigned char>(length >> 8));
+		compressed.push_back(static_cast<unsigned char>(~length));
+		compressed.push_back(static_cast<unsigned char>(~length >> 8));
+		compressed.insert(compressed.end(), raw.begin() + pos, raw.begin() + pos + length);
+		pos += length;
+	} while (pos < raw.size());
+	appendUInt32(compressed, toAdler32(raw.data(), raw.size()));
+	writeChunk(stream, "IDAT", compressed);
+	writeChunk(stream, "IEND", std::vector<unsigned char>());
+	return stream.good();
+}
@@ -0,0 +1,74 @@
+#ifndef __CRYSTAL_IO_PNG_FILE_H__
+#define __CRYSTAL_IO_PNG_FILE_H__
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+namespace Crystal {
+	namespace IO {
+
+// Minimal grayscale PNG codec with no external dependency. Reads non-interlaced 8/16-bit gray, gray+alpha, RGB and
+// RGBA images (color is averaged, alpha dropped). Writes 8/16-bit gray with uncompressed deflate blocks.
+// Reading never inflates more than the header's image size.
+class PNGFile final
+{
+public:
+	// larger headers are rejected before anything is allocated.
+	static const unsigned int MaxDimension = 65536;
+
+	static const size_t MaxPixelCount = 1 << 26;
+
+	PNGFile() :
+		width(0),
+		height(0),
+		bitDepth(8)
+	{}
+
+	PNGFile(const unsigned int width, const unsigned int height, const unsigned int bitDepth) :
+		width(width),
+		height(height),
+		bitDepth(bitDepth),
+		pixels(width * height, 0)
+	{}
+
+	~PNGFile() = default;
+
+	bool read(const std::string& filename);
+
+	bool read(std::istream& stream);
+
+	bool write(const std::string& filename) const;
+
+	bool write(std::ostream& stream) const;
+
+	unsigned int getWidth() const { return width; }
+
+	unsigned int getHeight() const { return height; }
+
+	// 8 or 16.
+	unsigned int getBitDepth() const { return bitDepth; }
+
+	unsigned short getMaxValue() const { return (bitDepth == 16) ? 0xFFFF : 0xFF; }
+
+	unsigned short get(const unsigned int x, const unsigned int y) const { return pixels[y * width + x]; }
+
+	void set(const unsigned int x, const unsigned int y, const unsigned short v) { pixels[y * width + x] = v; }
+
+	// row-major, one value per pixel.
+	const std::vector<unsigned short>& getPixels() const { return pixels; }
+
+	std::vector<unsigned short>& getPixels() { return pixels; }
+
+private:
+	unsigned int width;
+	unsigned int height;
+	unsigned int bitDepth;
+	std::vector<unsigned short> pixels;
+};
+
+	}
+}
+
+#endif
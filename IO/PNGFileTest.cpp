@@ -0,0 +1,152 @@
+#include "gtest/gtest.h"
+
+#include "PNGFile.h"
+
+#include <sstream>
+#include <string>
+
+using namespace Crystal::IO;
+
+class PNGFileTest : public testing::Test {
+protected:
+	// 16x16 8-bit gray, rows cycling through all five filter types, fixed-Huffman deflate.
+	static std::string toGrayFixed()
+	{
+		static const unsigned char bytes[] = {
+			0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+			0x00, 0x00, 0x00, 0x10, 0x00, 0x00, 0x00, 0x10, 0x08, 0x00, 0x00, 0x00, 0x00, 0x3a, 0x98, 0xa0,
+			0xbd, 0x00, 0x00, 0x00, 0x71, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x63, 0x60, 0x10, 0x50, 0x30,
+			0x70, 0x08, 0x48, 0x28, 0x68, 0x98, 0xb0, 0x60, 0xc3, 0x81, 0x0b, 0x0f, 0x3e, 0x30, 0x32, 0x0b,
+			0xa0, 0x02, 0x26, 0x66, 0x74, 0xc0, 0xc6, 0x85, 0x0a, 0x58, 0xd0, 0x15, 0x30, 0xf0, 0xcb, 0xeb,
+			0xdb, 0xfb, 0xc7, 0xe7, 0xd7, 0xf7, 0xcf, 0x5f, 0xbf, 0xff, 0xfc, 0xfd, 0xf7, 0xff, 0x19, 0x85,
+			0x08, 0x1a, 0xca, 0x87, 0x6a, 0x66, 0x17, 0xa6, 0xa1, 0x72, 0x7a, 0x76, 0x7e, 0x71, 0x79, 0x75,
+			0x7d, 0xf3, 0xd6, 0xed, 0x3b, 0x77, 0xef, 0xdd, 0x3f, 0x3e, 0x46, 0x45, 0x82, 0x86, 0x8a, 0xa2,
+			0x9a, 0x89, 0xc5, 0xa5, 0xba, 0xb6, 0xbe, 0xb1, 0xb9, 0xb5, 0xbd, 0x73, 0xd7, 0xee, 0x3d, 0x7b,
+			0xf7, 0xed, 0x5f, 0x5e, 0x59, 0x00, 0x6e, 0x8e, 0x27, 0xd0, 0x2e, 0x26, 0x60, 0xb6, 0x00, 0x00,
+			0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae, 0x42, 0x60, 0x82
+		};
+		return std::string(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+	}
+
+	// a written 3x2 image whose IHDR claims another size. the reader does not check CRCs.
+	static std::string toResized(const unsigned int width, const unsigned int height)
+	{
+		std::stringstream stream;
+		PNGFile(3, 2, 8).write(stream);
+		std::string bytes = stream.str();
+		for (int i = 0; i < 4; ++i) {
+			bytes[16 + i] = static_cast<char>(width >> (24 - i * 8));
+			bytes[20 + i] = static_cast<char>(height >> (24 - i * 8));
+		}
+		return bytes;
+	}
+};
+
+TEST_F(PNGFileTest, TestWriteAndRead8)
+{
+	PNGFile expected(3, 2, 8);
+	for (unsigned int y = 0; y < 2; ++y) {
+		for (unsigned int x = 0; x < 3; ++x) {
+			expected.set(x, y, static_cast<unsigned short>(x * 100 + y * 7));
+		}
+	}
+	std::stringstream stream;
+	EXPECT_TRUE(expected.write(stream));
+
+	PNGFile actual;
+	EXPECT_TRUE(actual.read(stream));
+	EXPECT_EQ(3, actual.getWidth());
+	EXPECT_EQ(2, actual.getHeight());
+	EXPECT_EQ(8, actual.getBitDepth());
+	EXPECT_EQ(expected.getPixels(), actual.getPixels());
+}
+
+TEST_F(PNGFileTest, TestWriteAndRead16)
+{
+	// larger than one stored deflate block.
+	PNGFile expected(300, 200, 16);
+	for (unsigned int y = 0; y < 200; ++y) {
+		for (unsigned int x = 0; x < 300; ++x) {
+			expected.set(x, y, static_cast<unsigned short>(x * 200 + y));
+		}
+	}
+	std::stringstream stream;
+	EXPECT_TRUE(expected.write(stream));
+
+	PNGFile actual;
+	EXPECT_TRUE(actual.read(stream));
+	EXPECT_EQ(16, actual.getBitDepth());
+	EXPECT_EQ(65535, actual.getMaxValue());
+	EXPECT_EQ(expected.getPixels(), actual.getPixels());
+}
+
+TEST_F(PNGFileTest, TestReadFiltered)
+{
+	std::stringstream stream(toGrayFixed());
+	PNGFile file;
+	EXPECT_TRUE(file.read(stream));
+	ASSERT_EQ(16, file.getWidth());
+	ASSERT_EQ(16, file.getHeight());
+	for (unsigned int y = 0; y < 16; ++y) {
+		for (unsigned int x = 0; x < 16; ++x) {
+			EXPECT_EQ((x * 16 + y * 3) % 256, file.get(x, y));
+		}
+	}
+}
+
+TEST_F(PNGFileTest, TestReadColor)
+{
+	// 10x10 8-bit RGB, dynamic-Huffman deflate.
+	const unsigned char bytes[] = {
+		0x89, 0x50, 0x4e, 0x47, 0x0d, 0x0a, 0x1a, 0x0a, 0x00, 0x00, 0x00, 0x0d, 0x49, 0x48, 0x44, 0x52,
+		0x00, 0x00, 0x00, 0x0a, 0x00, 0x00, 0x00, 0x0a, 0x08, 0x02, 0x00, 0x00, 0x00, 0x02, 0x50, 0x58,
+		0xea, 0x00, 0x00, 0x00, 0x4a, 0x49, 0x44, 0x41, 0x54, 0x78, 0xda, 0x75, 0xcf, 0x51, 0x0a, 0x00,
+		0x20, 0x08, 0x03, 0xd0, 0x1d, 0x6c, 0x07, 0xdb, 0xc1, 0x76, 0xc0, 0x92, 0x8a, 0x14, 0x14, 0x3f,
+		0xd2, 0x86, 0x0f, 0x04, 0xb4, 0xcb, 0x34, 0xcf, 0xf3, 0xa6, 0x68, 0xe2, 0xf3, 0x04, 0xe2, 0x8f,
+		0xd2, 0xa4, 0x1b, 0x7d, 0x41, 0x69, 0x55, 0xc0, 0x80, 0xa3, 0xe0, 0xee, 0x71, 0x17, 0x5c, 0x3d,
+		0xce, 0x82, 0xb3, 0xc7, 0x51, 0x70, 0x3c, 0x7c, 0x3e, 0x3a, 0xe1, 0xcd, 0xd1, 0xbb, 0x59, 0xc1,
+		0xdc, 0x67, 0xd5, 0xd1, 0x81, 0x6a, 0xe1, 0x00, 0x00, 0x00, 0x00, 0x49, 0x45, 0x4e, 0x44, 0xae,
+		0x42, 0x60, 0x82
+	};
+
+	std::stringstream stream(std::string(reinterpret_cast<const char*>(bytes), sizeof(bytes)));
+	PNGFile file;
+	EXPECT_TRUE(file.read(stream));
+	ASSERT_EQ(10, file.getWidth());
+	EXPECT_EQ(40, file.get(0, 0));
+	EXPECT_EQ(140, file.get(4, 0));
+	EXPECT_EQ(100, file.get(9, 0));
+	EXPECT_EQ(100, file.get(9, 9));
+}
+
+TEST_F(PNGFileTest, TestReadInvalid)
+{
+	std::stringstream stream("not a png");
+	PNGFile file;
+	EXPECT_FALSE(file.read(stream));
+
+	const std::string& png = toGrayFixed();
+	std::stringstream broken(png.substr(0, png.size() - 40));
+	EXPECT_FALSE(file.read(broken));
+}
+
+TEST_F(PNGFileTest, TestReadOversized)
+{
+	PNGFile file;
+	std::stringstream huge(toResized(0xFFFFFFFFu, 0xFFFFFFFFu));
+	EXPECT_FALSE(file.read(huge));
+
+	std::stringstream tooMany(toResized(PNGFile::MaxDimension, PNGFile::MaxDimension));
+	EXPECT_FALSE(file.read(tooMany));
+
+	// more rows than the stream could hold.
+	std::stringstream tall(toResized(3, 60000));
+	EXPECT_FALSE(file.read(tall));
+
+	// the stream inflates past the claimed size.
+	std::stringstream trailing(toResized(3, 1));
+	EXPECT_FALSE(file.read(trailing));
+
+	std::stringstream same(toResized(3, 2));
+	EXPECT_TRUE(file.read(same));
+}
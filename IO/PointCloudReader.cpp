@@ -0,0 +1,515 @@
+#include "PointCloudReader.h"
+
+#include "TextScanner.h"
+#include "../Util/Parallel.h"
+
+#include <fstream>
+#include <algorithm>
+#include <cstring>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	const size_t TextBlockSize = 1024 * 1024;
+	const size_t MaxHeaderSize = 1024 * 1024;
+
+	const size_t RowBlockSize = 4096;
+
+	bool isHostLittleEndian()
+	{
+		const unsigned short v = 1;
+		return *reinterpret_cast<const unsigned char*>(&v) == 1;
+	}
+
+	template<typename T>
+	float toFloat(const unsigned char* bytes)
+	{
+		T v;
+		std::memcpy(&v, bytes, sizeof(v));
+		return static_cast<float>(v);
+	}
+
+	// one value in its file byte order.
+	float toFloat(const PLYType type, const unsigned char* bytes, const bool needsSwap)
+	{
+		unsigned char b[8];
+		const size_t size = PLYFile::getSize(type);
+		std::memcpy(b, bytes, size);
+		if (needsSwap) {
+			std::reverse(b, b + size);
+		}
+		switch (type) {
+		case PLYType::Char: return toFloat<signed char>(b);
+		case PLYType::UChar: return toFloat<unsigned char>(b);
+		case PLYType::Short: return toFloat<short>(b);
+		case PLYType::UShort: return toFloat<unsigned short>(b);
+		case PLYType::Int: return toFloat<int>(b);
+		case PLYType::UInt: return toFloat<unsigned int>(b);
+		case PLYType::Float: return toFloat<float>(b);
+		case PLYType::Double: return toFloat<double>(b);
+		default: return 0.0f;
+		}
+	}
+
+	bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n'; }
+
+	void skipSpaces(const char*& p, const char* end)
+	{
+		while (p < end && isSpace(*p)) {
+			++p;
+		}
+	}
+
+	bool parseValue(const char*& p, const char* end, float& value)
+	{
+		skipSpaces(p, end);
+		return TextScanner::parseFloat(p, end, value) && (p == end || isSpace(*p));
+	}
+
+	void resize(PointBatch& batch, const size_t count, const size_t attributeCount)
+	{
+		batch.positions.resize(count);
+		batch.attributes.resize(attributeCount);
+		for (auto& a : batch.attributes) {
+			a.resize(count);
+		}
+	}
+
+	void setValue(PointBatch& batch, const size_t i, const int role, const float v)
+	{
+		if (role >= 3) {
+			batch.attributes[role - 3][i] = v;
+			return;
+		}
+		Vector3d<float>& p = batch.positions[i];
+		switch (role) {
+		case 0: p.setX(v); break;
+		case 1: p.setY(v); break;
+		case 2: p.setZ(v); break;
+		default: break;
+		}
+	}
+}
+
+PointCloudReader::PointCloudReader() :
+	batchSize(64 * 1024),
+	threadCount(0),
+	source(nullptr),
+	isPLYSource(false),
+	isBinary(false),
+	needsSwap(false),
+	isFailedSource(false),
+	pointCount(0),
+	readCount(0),
+	stride(0),
+	hasList(false),
+	textPosition(0)
+{}
+
+bool PointCloudReader::open(const std::string& filename)
+{
+	close();
+	file.reset(new std::ifstream(filename.c_str(), std::ios::binary));
+	if (!static_cast<std::ifstream*>(file.get())->is_open()) {
+		file.reset();
+		return false;
+	}
+	return start(*file);
+}
+
+bool PointCloudReader::open(std::istream& stream)
+{
+	close();
+	return start(stream);
+}
+
+void PointCloudReader::close()
+{
+	file.reset();
+	source = nullptr;
+	isPLYSource = false;
+	isBinary = false;
+	needsSwap = false;
+	isFailedSource = false;
+	pointCount = 0;
+	readCount = 0;
+	attributeNames.clear();
+	columns.clear();
+	stride = 0;
+	hasList = false;
+	text.clear();
+	textPosition = 0;
+	bytes.clear();
+}
+
+bool PointCloudReader::start(std::istream& stream)
+{
+	source = &stream;
+	while (text.size() < 4 && fillText()) {
+	}
+	isPLYSource = (text.compare(0, 3, "ply") == 0) && (text.size() == 3 || text[3] == '\n' || text[3] == '\r');
+	const bool isOpened = isPLYSource ? openPLY() : openXYZ();
+	if (!isOpened) {
+		close();
+	}
+	return isOpened;
+}
+
+bool PointCloudReader::openPLY()
+{
+	PLYFile header;
+	size_t headerSize = 0;
+	for (;;) {
+		headerSize = header.readHeader(text.data(), text.data() + text.size());
+		// a header cut right after end_header still needs its line break.
+		const bool isComplete = (headerSize > 0) && (text[headerSize - 1] == '\n');
+		if (isComplete) {
+			break;
+		}
+		if (text.size() > MaxHeaderSize || !fillText()) {
+			if (headerSize > 0) {
+				break;
+			}
+			return false;
+		}
+	}
+	textPosition = headerSize;
+	isBinary = (header.getFormat() != PLYFormat::ASCII);
+	needsSwap = isBinary && ((header.getFormat() == PLYFormat::BinaryLittleEndian) != isHostLittleEndian());
+
+	const PLYElement* vertex = header.findElement("vertex");
+	if (vertex == nullptr) {
+		return false;
+	}
+	for (const auto& e : header.getElements()) {
+		if (&e == vertex) {
+			break;
+		}
+		if (!skipElement(e)) {
+			return false;
+		}
+	}
+
+	int found[3] = { 0, 0, 0 };
+	for (const auto& property : vertex->properties) {
+		Column c;
+		c.type = property.type;
+		c.countType = property.countType;
+		c.role = -1;
+		if (property.isList()) {
+			hasList = true;
+		}
+		else if (property.name == "x" || property.name == "y" || property.name == "z") {
+			c.role = property.name[0] - 'x';
+			++found[c.role];
+		}
+		else {
+			c.role = static_cast<int>(3 + attributeNames.size());
+			attributeNames.push_back(property.name);
+		}
+		stride += PLYFile::getSize(property.type);
+		columns.push_back(c);
+	}
+	pointCount = vertex->count;
+	return found[0] == 1 && found[1] == 1 && found[2] == 1;
+}
+
+bool PointCloudReader::openXYZ()
+{
+	std::vector<size_t> lineStarts;
+	for (size_t count = 1;; ++count) {
+		if (readLines(count, lineStarts) < count) {
+			return true;
+		}
+		const char* p = text.data() + lineStarts[count - 1];
+		const char* end = text.data() + lineStarts[count];
+		skipSpaces(p, end);
+		if (p == end || *p == '#') {
+			continue;
+		}
+		size_t columnCount = 0;
+		while (p < end) {
+			while (p < end && !isSpace(*p)) {
+				++p;
+			}
+			skipSpaces(p, end);
+			++columnCount;
+		}
+		if (columnCount < 3) {
+			return false;
+		}
+		for (size_t c = 3; c < columnCount; ++c) {
+			attributeNames.push_back("column" + std::to_string(c));
+		}
+		return true;
+	}
+}
+
+bool PointCloudReader::skipElement(const PLYElement& e)
+{
+	if (!isBinary) {
+		std::vector<size_t> lineStarts;
+		for (size_t left = e.count; left > 0;) {
+			const size_t count = std::min(left, batchSize);
+			if (readLines(count, lineStarts) < count) {
+				return false;
+			}
+			textPosition = lineStarts.back();
+			left -= count;
+		}
+		return true;
+	}
+
+	const bool hasListProperty = std::any_of(e.properties.begin(), e.properties.end(), [](const PLYProperty& property) { return property.isList(); });
+	if (!hasListProperty) {
+		size_t size = 0;
+		for (const auto& property : e.properties) {
+			size += PLYFile::getSize(property.type);
+		}
+		return readBytes(nullptr, size * e.count);
+	}
+	for (size_t i = 0; i < e.count; ++i) {
+		for (const auto& property : e.properties) {
+			size_t n = 1;
+			if (property.isList()) {
+				unsigned char count[8];
+				if (!readBytes(count, PLYFile::getSize(property.countType))) {
+					return false;
+				}
+				const float c = toFloat(property.countType, count, needsSwap);
+				if (c < 0.0f) {
+					return false;
+				}
+				n = static_cast<size_t>(c);
+			}
+			if (!readBytes(nullptr, n * PLYFile::getSize(property.type))) {
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
+// drops the consumed text and appends the next block; false when the stream has nothing more.
+bool PointCloudReader::fillText()
+{
+	text.erase(0, textPosition);
+	textPosition = 0;
+	const size_t size = text.size();
+	text.resize(size + TextBlockSize);
+	source->read(&text[size], TextBlockSize);
+	text.resize(size + static_cast<size_t>(source->gcount()));
+	return text.size() > size;
+}
+
+size_t PointCloudReader::readLines(const size_t count, std::vector<size_t>& lineStarts)
+{
+	lineStarts.assign(1, textPosition);
+	size_t p = textPosition;
+	while (lineStarts.size() <= count) {
+		const size_t lineEnd = text.find('\n', p);
+		if (lineEnd != std::string::npos) {
+			p = lineEnd + 1;
+			lineStarts.push_back(p);
+			continue;
+		}
+		const size_t offset = textPosition;
+		if (!fillText()) {
+			if (p < text.size() + offset) {
+				lineStarts.push_back(text.size() + offset);
+			}
+			for (auto& s : lineStarts) {
+				s -= offset;
+			}
+			return lineStarts.size() - 1;
+		}
+		for (auto& s : lineStarts) {
+			s -= offset;
+		}
+		p -= offset;
+	}
+	return count;
+}
+
+bool PointCloudReader::read(PointBatch& batch)
+{
+	resize(batch, 0, attributeNames.size());
+	if (source == nullptr || isFailedSource) {
+		return false;
+	}
+	return (isPLYSource && isBinary) ? readBinary(batch) : readASCII(batch);
+}
+
+bool PointCloudReader::readASCII(PointBatch& batch)
+{
+	std::vector<size_t> lineStarts;
+	std::vector<int> results;
+	for (;;) {
+		const size_t count = isPLYSource ? std::min(batchSize, pointCount - readCount) : batchSize;
+		if (count == 0) {
+			return false;
+		}
+		const size_t lineCount = readLines(count, lineStarts);
+		if (isPLYSource && lineCount < count) {
+			return fail();
+		}
+		if (lineCount == 0) {
+			return false;
+		}
+		resize(batch, lineCount, attributeNames.size());
+		results.assign(lineCount, 0);
+		Util::parallelForBlocks(lineCount, RowBlockSize, [&](const size_t first, const size_t last) {
+			for (size_t i = first; i < last; ++i) {
+				results[i] = parseLine(text.data() + lineStarts[i], text.data() + lineStarts[i + 1], batch, i);
+			}
+		}, threadCount);
+		textPosition = lineStarts.back();
+
+		size_t n = 0;
+		for (size_t i = 0; i < lineCount; ++i) {
+			if (results[i] < 0 || (results[i] == 0 && isPLYSource)) {
+				return fail();
+			}
+			if (results[i] == 0) {
+				continue;
+			}
+			if (n != i) {
+				batch.positions[n] = batch.positions[i];
+				for (auto& a : batch.attributes) {
+					a[n] = a[i];
+				}
+			}
+			++n;
+		}
+		resize(batch, n, attributeNames.size());
+		readCount += n;
+		if (n > 0) {
+			return true;
+		}
+	}
+}
+
+int PointCloudReader::parseLine(const char* p, const char* end, PointBatch& batch, const size_t i) const
+{
+	skipSpaces(p, end);
+	if (!isPLYSource && (p == end || *p == '#')) {
+		return 0;
+	}
+	float v = 0.0f;
+	if (isPLYSource) {
+		for (const auto& c : columns) {
+			if (!parseValue(p, end, v)) {
+				return -1;
+			}
+			if (c.countType != PLYType::None) {
+				for (int k = 0; k < static_cast<int>(v); ++k) {
+					float skipped = 0.0f;
+					if (!parseValue(p, end, skipped)) {
+						return -1;
+					}
+				}
+				continue;
+			}
+			setValue(batch, i, c.role, v);
+		}
+	}
+	else {
+		const int columnCount = static_cast<int>(3 + attributeNames.size());
+		for (int c = 0; c < columnCount; ++c) {
+			if (!parseValue(p, end, v)) {
+				return -1;
+			}
+			setValue(batch, i, c, v);
+		}
+	}
+	skipSpaces(p, end);
+	return (p == end) ? 1 : -1;
+}
+
+// fixed-size rows are read as one block and decoded in parallel.
+bool PointCloudReader::readBinary(PointBatch& batch)
+{
+	const size_t count = std::min(batchSize, pointCount - readCount);
+	if (count == 0) {
+		return false;
+	}
+	if (hasList) {
+		return readBinaryRows(batch, count);
+	}
+	bytes.resize(count * stride);
+	if (!readBytes(bytes.data(), bytes.size())) {
+		return fail();
+	}
+	resize(batch, count, attributeNames.size());
+	Util::parallelForBlocks(count, RowBlockSize, [&](const size_t first, const size_t last) {
+		for (size_t i = first; i < last; ++i) {
+			const unsigned char* row = bytes.data() + i * stride;
+			for (const auto& c : columns) {
+				if (c.role >= 0) {
+					setValue(batch, i, c.role, toFloat(c.type, row, needsSwap));
+				}
+				row += PLYFile::getSize(c.type);
+			}
+		}
+	}, threadCount);
+	readCount += count;
+	return true;
+}
+
+bool PointCloudReader::readBinaryRows(PointBatch& batch, const size_t count)
+{
+	resize(batch, count, attributeNames.size());
+	unsigned char value[8];
+	for (size_t i = 0; i < count; ++i) {
+		for (const auto& c : columns) {
+			if (c.countType != PLYType::None) {
+				if (!readBytes(value, PLYFile::getSize(c.countType))) {
+					return fail();
+				}
+				const float n = toFloat(c.countType, value, needsSwap);
+				if (n < 0.0f || !readBytes(nullptr, static_cast<size_t>(n) * PLYFile::getSize(c.type))) {
+					return fail();
+				}
+				continue;
+			}
+			if (!readBytes(value, PLYFile::getSize(c.type))) {
+				return fail();
+			}
+			setValue(batch, i, c.role, toFloat(c.type, value, needsSwap));
+		}
+	}
+	readCount += count;
+	return true;
+}
+
+// buffered header text is used up before the stream is read.
+bool PointCloudReader::readBytes(void* values, const size_t size)
+{
+	const size_t buffered = std::min(size, text.size() - textPosition);
+	if (values != nullptr) {
+		std::memcpy(values, text.data() + textPosition, buffered);
+	}
+	textPosition += buffered;
+	if (textPosition == text.size()) {
+		text.clear();
+		textPosition = 0;
+	}
+	const size_t rest = size - buffered;
+	if (rest == 0) {
+		return true;
+	}
+	if (values != nullptr) {
+		source->read(static_cast<char*>(values) + buffered, rest);
+	}
+	else {
+		source->ignore(static_cast<std::streamsize>(rest));
+	}
+	return static_cast<size_t>(source->gcount()) == rest;
+}
+
+bool PointCloudReader::fail()
+{
+	isFailedSource = true;
+	return false;
+}
@@ -0,0 +1,144 @@
+#ifndef __CRYSTAL_IO_POINT_CLOUD_READER_H__
+#define __CRYSTAL_IO_POINT_CLOUD_READER_H__
+
+#include "PLYFile.h"
+
+#include "../Util/UnCopyable.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <memory>
+
+namespace Crystal {
+	namespace IO {
+
+// Points of one batch; attribute column a holds the values of getAttributeNames()[a].
+struct PointBatch
+{
+	Math::Vector3dVector<float> positions;
+	std::vector< std::vector<float> > attributes;
+
+	size_t getSize() const { return positions.size(); }
+};
+
+// Reads the vertices of a PLY file (ASCII or binary) or the lines of an XYZ text file ("x y z [values...]", '#'
+// comments) in batches of at most getBatchSize() points. Only one batch and one read buffer are held at a time, so
+// clouds far larger than memory can be voxelized (BitSpace3d::setPoints, Volume3d::addPoints) or turned into
+// particles (ParticleBuilder::create) in a single pass. Each batch is decoded on worker threads.
+//
+// PLY attributes are the scalar vertex properties other than x, y and z; XYZ attributes are the columns after z,
+// named "column3", "column4", ... as counted on the first point line.
+class PointCloudReader final : private UnCopyable
+{
+public:
+	PointCloudReader();
+
+	~PointCloudReader() = default;
+
+	// PLY when the input starts with "ply", XYZ otherwise.
+	bool open(const std::string& filename);
+
+	// the stream must outlive the reader.
+	bool open(std::istream& stream);
+
+	void close();
+
+	bool isOpen() const { return source != nullptr; }
+
+	void setBatchSize(const size_t size) { this->batchSize = (size == 0) ? 1 : size; }
+
+	size_t getBatchSize() const { return batchSize; }
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	bool isPLY() const { return isPLYSource; }
+
+	// vertex count of a PLY header; 0 for XYZ, whose size is unknown until the end.
+	size_t getPointCount() const { return isPLYSource ? pointCount : 0; }
+
+	const std::vector<std::string>& getAttributeNames() const { return attributeNames; }
+
+	// the next batch; false when no points are left or the input is broken.
+	bool read(PointBatch& batch);
+
+	// true after malformed or truncated input.
+	bool isFailed() const { return isFailedSource; }
+
+	// points returned so far.
+	size_t getReadCount() const { return readCount; }
+
+	// calls func(batch) for every remaining batch; false when the input is broken.
+	template<typename Func>
+	bool forEachBatch(const Func& func) {
+		PointBatch batch;
+		while (read(batch)) {
+			func(static_cast<const PointBatch&>(batch));
+		}
+		return !isFailedSource;
+	}
+
+private:
+	size_t batchSize;
+	unsigned int threadCount;
+	std::unique_ptr<std::istream> file;
+	std::istream* source;
+	bool isPLYSource;
+	bool isBinary;
+	bool needsSwap;
+	bool isFailedSource;
+	size_t pointCount;
+	size_t readCount;
+	std::vector<std::string> attributeNames;
+
+	// vertex properties in file order; role -1 is skipped, 0-2 are x, y, z, 3 and above are attributes.
+	struct Column
+	{
+		PLYType type;
+		PLYType countType;
+		int role;
+	};
+	std::vector<Column> columns;
+	size_t stride;
+	bool hasList;
+
+	// text not yet consumed starts at textPosition.
+	std::string text;
+	size_t textPosition;
+	std::vector<unsigned char> bytes;
+
+	bool start(std::istream& stream);
+
+	bool openPLY();
+
+	bool openXYZ();
+
+	bool skipElement(const PLYElement& e);
+
+	bool fillText();
+
+	// up to count lines from textPosition; line i is [lineStarts[i], lineStarts[i + 1]).
+	size_t readLines(const size_t count, std::vector<size_t>& lineStarts);
+
+	bool readASCII(PointBatch& batch);
+
+	bool readBinary(PointBatch& batch);
+
+	bool readBinaryRows(PointBatch& batch, const size_t count);
+
+	// skips the bytes when values is null.
+	bool readBytes(void* values, const size_t size);
+
+	// 1 for a point, 0 for a blank or comment line, -1 for a malformed one.
+	int parseLine(const char* p, const char* end, PointBatch& batch, const size_t i) const;
+
+	bool fail();
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+
+#include "PointCloudReader.h"
+
+#include "../Math/BitSpace.h"
+#include "../Math/Volume.h"
+
+#include <sstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class PointCloudReaderTest : public testing::Test {
+protected:
+	static PLYFile toCloud(const size_t count)
+	{
+		Vector3dVector<float> positions(count);
+		std::vector<float> densities(count);
+		std::vector<unsigned char> reds(count);
+		for (size_t i = 0; i < count; ++i) {
+			positions[i] = Vector3d<float>(static_cast<float>(i % 10), static_cast<float>(i / 10 % 10), static_cast<float>(i / 100) * 0.5f);
+			densities[i] = 1000.0f + static_cast<float>(i);
+			reds[i] = static_cast<unsigned char>(i);
+		}
+		PLYFile file;
+		file.setPositions(positions);
+		file.setProperty("vertex", "density", densities);
+		file.setProperty("vertex", "red", reds);
+		return file;
+	}
+
+	// every batch appended in order.
+	static PointBatch toAll(PointCloudReader& reader)
+	{
+		PointBatch all;
+		all.attributes.resize(reader.getAttributeNames().size());
+		EXPECT_TRUE(reader.forEachBatch([&](const PointBatch& batch) {
+			EXPECT_LE(batch.getSize(), reader.getBatchSize());
+			all.positions.insert(all.positions.end(), batch.positions.begin(), batch.positions.end());
+			for (size_t a = 0; a < batch.attributes.size(); ++a) {
+				all.attributes[a].insert(all.attributes[a].end(), batch.attributes[a].begin(), batch.attributes[a].end());
+			}
+		}));
+		return all;
+	}
+};
+
+TEST_F(PointCloudReaderTest, TestReadPLY)
+{
+	for (const auto format : { PLYFormat::ASCII, PLYFormat::BinaryLittleEndian, PLYFormat::BinaryBigEndian }) {
+		PLYFile file = toCloud(1000);
+		file.setFormat(format);
+		std::stringstream stream;
+		EXPECT_TRUE(file.write(stream));
+
+		PointCloudReader reader;
+		reader.setBatchSize(300);
+		EXPECT_TRUE(reader.open(stream));
+		EXPECT_TRUE(reader.isPLY());
+		EXPECT_EQ(1000, reader.getPointCount());
+		EXPECT_EQ(std::vector<std::string>({ "density", "red" }), reader.getAttributeNames());
+		const PointBatch& all = toAll(reader);
+		EXPECT_FALSE(reader.isFailed());
+		EXPECT_EQ(1000, reader.getReadCount());
+		EXPECT_EQ(file.getPositions(), all.positions);
+		std::vector<float> densities;
+		std::vector<float> reds;
+		file.getProperty("vertex", "density", densities);
+		file.getProperty("vertex", "red", reds);
+		EXPECT_EQ(densities, all.attributes[0]);
+		EXPECT_EQ(reds, all.attributes[1]);
+	}
+}
+
+TEST_F(PointCloudReaderTest, TestReadPLYWithOtherElements)
+{
+	for (const auto format : { PLYFormat::ASCII, PLYFormat::BinaryLittleEndian }) {
+		PLYFile file;
+		file.setFormat(format);
+		file.setElement("camera", 2);
+		file.setListProperty("camera", "ids", { 0, 1, 3 }, std::vector<int>{ 7, 8, 9 });
+		file.setPositions({ Vector3d<float>(1, 2, 3), Vector3d<float>(4, 5, 6) });
+		file.setListProperty("vertex", "neighbors", { 0, 2, 2 }, std::vector<short>{ 1, 0 });
+		file.setFaces({ 0, 3 }, { 0, 1, 0 });
+		std::stringstream stream;
+		EXPECT_TRUE(file.write(stream));
+
+		PointCloudReader reader;
+		EXPECT_TRUE(reader.open(stream));
+		EXPECT_TRUE(reader.getAttributeNames().empty());
+		PointBatch batch;
+		EXPECT_TRUE(reader.read(batch));
+		EXPECT_EQ(file.getPositions(), batch.positions);
+		EXPECT_FALSE(reader.read(batch));
+		EXPECT_FALSE(reader.isFailed());
+	}
+}
+
+TEST_F(PointCloudReaderTest, TestReadXYZ)
+{
+	std::stringstream stream;
+	stream
+		<< "# scan" << std::endl
+		<< std::endl
+		<< "0 0 0 255 0 0" << std::endl
+		<< "1.5 -2 3e2 0 255 0" << std::endl
+		<< "# middle" << std::endl
+		<< "\t4 5 6 0 0 255\r" << std::endl
+		<< "7 8 9 1 1 1";
+	PointCloudReader reader;
+	reader.setBatchSize(2);
+	EXPECT_TRUE(reader.open(stream));
+	EXPECT_FALSE(reader.isPLY());
+	EXPECT_EQ(std::vector<std::string>({ "column3", "column4", "column5" }), reader.getAttributeNames());
+	const PointBatch& all = toAll(reader);
+	const Vector3dVector<float> expected = { Vector3d<float>(0, 0, 0), Vector3d<float>(1.5f, -2, 300), Vector3d<float>(4, 5, 6), Vector3d<float>(7, 8, 9) };
+	EXPECT_EQ(expected, all.positions);
+	EXPECT_EQ(std::vector<float>({ 255, 0, 0, 1 }), all.attributes[0]);
+	EXPECT_EQ(std::vector<float>({ 0, 0, 255, 1 }), all.attributes[2]);
+}
+
+TEST_F(PointCloudReaderTest, TestInvalid)
+{
+	{
+		std::stringstream stream("0 0 0\n1 1\n");
+		PointCloudReader reader;
+		EXPECT_TRUE(reader.open(stream));
+		PointBatch batch;
+		EXPECT_FALSE(reader.read(batch));
+		EXPECT_TRUE(reader.isFailed());
+	}
+	{
+		std::stringstream stream("0 0\n");
+		PointCloudReader reader;
+		EXPECT_FALSE(reader.open(stream));
+	}
+	{
+		std::stringstream stream("ply\nformat ascii 1.0\nelement face 0\nend_header\n");
+		PointCloudReader reader;
+		EXPECT_FALSE(reader.open(stream));
+	}
+
+	PLYFile file = toCloud(100);
+	std::stringstream stream;
+	EXPECT_TRUE(file.write(stream));
+	std::string s = stream.str();
+	s.resize(s.size() - 5);
+	std::stringstream truncated(s);
+	PointCloudReader reader;
+	reader.setBatchSize(60);
+	EXPECT_TRUE(reader.open(truncated));
+	PointBatch batch;
+	EXPECT_TRUE(reader.read(batch));
+	EXPECT_FALSE(reader.read(batch));
+	EXPECT_TRUE(reader.isFailed());
+}
+
+TEST_F(PointCloudReaderTest, TestVoxelize)
+{
+	const std::string filename = "PointCloudReaderTest.ply";
+	PLYFile file = toCloud(1000);
+	EXPECT_TRUE(file.write(filename));
+
+	PointCloudReader reader;
+	reader.setBatchSize(128);
+	EXPECT_TRUE(reader.open(filename));
+	const Space3d<float> space(Vector3d<float>(0, 0, 0), Vector3d<float>(10, 10, 5));
+	BitSpace3d<float> bits(space, Bitmap3d(10, 10, 5));
+	Volume3d<float, float> volume(space, Grid3d<float>(10, 10, 5));
+	size_t count = 0;
+	EXPECT_TRUE(reader.forEachBatch([&](const PointBatch& batch) {
+		count += bits.setPoints(batch.positions);
+		volume.addPoints(batch.positions, 1.0f);
+	}));
+	EXPECT_EQ(1000, count);
+	EXPECT_EQ(500, bits.getBitmap().getCount());
+	EXPECT_EQ(2.0f, volume.getValue(3, 4, 2));
+	reader.close();
+	std::remove(filename.c_str());
+}
@@ -0,0 +1,185 @@
+#include "RawVolumeFile.h"
+
+#include "MappedFile.h"
+#include "../Util/Parallel.h"
+
+#include <fstream>
+#include <cstring>
+#include <vector>
+#include <limits>
+#include <algorithm>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	const char magicStr[8] = { 'C', 'G', 'B', 'R', 'A', 'W', '\0', '\0' };
+
+	// RawVolumeFile::DataAlignment; chunks are padded to it.
+	const unsigned long long Alignment = 4096;
+
+	bool multiply(const unsigned long long a, const unsigned long long b, unsigned long long& result)
+	{
+		if (a != 0 && b > std::numeric_limits<unsigned long long>::max() / a) {
+			return false;
+		}
+		result = a * b;
+		return true;
+	}
+
+	// placement of the data section; every chunk but the last is padded to stride bytes.
+	struct Layout
+	{
+		unsigned long long sliceSize;
+		unsigned long long depth;
+		unsigned long long stride;
+		unsigned long long dataSize;
+
+		unsigned long long getOffset(const size_t z) const { return (z / depth) * stride + (z % depth) * sliceSize; }
+	};
+
+	// false when a size overflows.
+	bool toLayout(const unsigned int resolution[3], const unsigned long long valueSize, const unsigned int chunkDepth, Layout& layout)
+	{
+		const unsigned int sizez = resolution[2];
+		layout.depth = (chunkDepth == 0 || chunkDepth > sizez) ? sizez : chunkDepth;
+		layout.dataSize = 0;
+		layout.stride = 0;
+		unsigned long long chunkBytes = 0;
+		if (!multiply(static_cast<unsigned long long>(resolution[0]) * resolution[1], valueSize, layout.sliceSize) ||
+			!multiply(layout.sliceSize, layout.depth, chunkBytes) ||
+			chunkBytes > std::numeric_limits<unsigned long long>::max() - Alignment) {
+			return false;
+		}
+		if (layout.depth == 0) {
+			layout.depth = 1;
+			return true;
+		}
+		layout.stride = (chunkBytes + Alignment - 1) / Alignment * Alignment;
+		const unsigned long long chunkCount = (sizez + layout.depth - 1) / layout.depth;
+		const unsigned long long lastBytes = (sizez - (chunkCount - 1) * layout.depth) * layout.sliceSize;
+		if (!multiply(chunkCount - 1, layout.stride, layout.dataSize) || layout.dataSize > std::numeric_limits<unsigned long long>::max() - lastBytes) {
+			return false;
+		}
+		layout.dataSize += lastBytes;
+		return true;
+	}
+
+	// the offsets are compared against the file size without adding them, so crafted values cannot wrap around.
+	bool isValid(const RawVolumeHeader& header, const size_t fileSize, Layout& layout)
+	{
+		if (std::memcmp(header.magic, magicStr, sizeof(magicStr)) != 0 || header.version == 0 || header.version > 2 ||
+			header.compression != 0 || header.valueSize == 0 || (header.version == 1 && header.chunkDepth != 0)) {
+			return false;
+		}
+		return
+			toLayout(header.resolution, header.valueSize, header.chunkDepth, layout) &&
+			header.dataSize == layout.dataSize &&
+			header.dataOffset >= sizeof(RawVolumeHeader) &&
+			header.dataOffset <= fileSize &&
+			header.dataSize <= fileSize - header.dataOffset;
+	}
+}
+
+template<typename GeomType, typename ValueType>
+bool RawVolumeFile<GeomType, ValueType>::save(const std::string& filename, const Volume3d<GeomType, ValueType>& volume) const
+{
+	static_assert(RawValueTypeOf<ValueType>::value != RawValueType::None, "unsupported value type");
+	static_assert(DataAlignment == 4096, "chunk padding assumes the data alignment");
+
+	std::ofstream stream(filename, std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	const auto& res = volume.getResolutions();
+	const auto& grid = volume.getGrid();
+
+	RawVolumeHeader header;
+	std::memset(&header, 0, sizeof(header));
+	std::memcpy(header.magic, magicStr, sizeof(magicStr));
+	header.version = Version;
+	header.valueType = static_cast<unsigned int>(RawValueTypeOf<ValueType>::value);
+	header.valueSize = sizeof(ValueType);
+	for (int i = 0; i < 3; ++i) {
+		header.resolution[i] = res[i];
+	}
+	const auto& start = volume.getStart();
+	const auto& length = volume.getSpace().getLengths();
+	header.origin[0] = start.getX();
+	header.origin[1] = start.getY();
+	header.origin[2] = start.getZ();
+	header.length[0] = length.getX();
+	header.length[1] = length.getY();
+	header.length[2] = length.getZ();
+	const size_t sliceSize = grid.getStrideZ() * sizeof(ValueType);
+	header.chunkDepth = static_cast<unsigned int>(std::max<size_t>(1, std::min<size_t>(res[2], (sliceSize == 0) ? res[2] : chunkSize / sliceSize)));
+	Layout layout;
+	if (!toLayout(header.resolution, header.valueSize, header.chunkDepth, layout)) {
+		return false;
+	}
+	header.dataOffset = DataAlignment;
+	header.dataSize = layout.dataSize;
+
+	stream.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	const std::vector<char> padding(DataAlignment, 0);
+	stream.write(padding.data(), DataAlignment - sizeof(header));
+	for (size_t z = 0; z < res[2]; z += header.chunkDepth) {
+		const size_t depth = std::min<size_t>(header.chunkDepth, res[2] - z);
+		stream.write(reinterpret_cast<const char*>(grid.getSlice(z)), depth * sliceSize);
+		if (z + depth < res[2]) {
+			stream.write(padding.data(), static_cast<size_t>(layout.stride - depth * sliceSize));
+		}
+	}
+	return stream.good();
+}
+
+template<typename GeomType, typename ValueType>
+bool RawVolumeFile<GeomType, ValueType>::load(const std::string& filename, Volume3d<GeomType, ValueType>& volume) const
+{
+	MappedFile file;
+	if (!file.open(filename) || file.getSize() < sizeof(RawVolumeHeader)) {
+		return false;
+	}
+	RawVolumeHeader header;
+	std::memcpy(&header, file.getData(), sizeof(header));
+	Layout layout;
+	if (!isValid(header, file.getSize(), layout) ||
+		header.valueType != static_cast<unsigned int>(RawValueTypeOf<ValueType>::value) ||
+		header.valueSize != sizeof(ValueType)) {
+		return false;
+	}
+
+	Grid3d<ValueType> grid(header.resolution[0], header.resolution[1], header.resolution[2]);
+	const unsigned char* src = file.getData() + header.dataOffset;
+	const size_t sliceSize = static_cast<size_t>(layout.sliceSize);
+	Util::parallelFor(grid.getSizeZ(), [&](const size_t z) {
+		std::memcpy(grid.getSlice(z), src + layout.getOffset(z), sliceSize);
+	});
+
+	const Vector3d<GeomType> origin(static_cast<GeomType>(header.origin[0]), static_cast<GeomType>(header.origin[1]), static_cast<GeomType>(header.origin[2]));
+	const Vector3d<GeomType> length(static_cast<GeomType>(header.length[0]), static_cast<GeomType>(header.length[1]), static_cast<GeomType>(header.length[2]));
+	volume = Volume3d<GeomType, ValueType>(Space3d<GeomType>(origin, length), std::move(grid));
+	return true;
+}
+
+template<typename GeomType, typename ValueType>
+bool RawVolumeFile<GeomType, ValueType>::readHeader(const std::string& filename, RawVolumeHeader& header)
+{
+	std::ifstream stream(filename, std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	stream.seekg(0, std::ios::end);
+	const auto fileSize = static_cast<size_t>(stream.tellg());
+	stream.seekg(0, std::ios::beg);
+	if (!stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+		return false;
+	}
+	Layout layout;
+	return isValid(header, fileSize, layout);
+}
+
+template class RawVolumeFile<float, unsigned char>;
+template class RawVolumeFile<float, unsigned short>;
+template class RawVolumeFile<float, float>;
+template class RawVolumeFile<float, double>;
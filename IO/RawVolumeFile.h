@@ -0,0 +1,86 @@
+#ifndef __CRYSTAL_IO_RAW_VOLUME_FILE_H__
+#define __CRYSTAL_IO_RAW_VOLUME_FILE_H__
+
+#include "../Math/Volume.h"
+
+#include <string>
+
+namespace Crystal {
+	namespace IO {
+
+enum class RawValueType : unsigned int
+{
+	None = 0,
+	UnsignedChar = 1,
+	UnsignedShort = 2,
+	Float = 3,
+	Double = 4,
+};
+
+template<typename T>
+struct RawValueTypeOf { static const RawValueType value = RawValueType::None; };
+
+template<> struct RawValueTypeOf<unsigned char> { static const RawValueType value = RawValueType::UnsignedChar; };
+template<> struct RawValueTypeOf<unsigned short> { static const RawValueType value = RawValueType::UnsignedShort; };
+template<> struct RawValueTypeOf<float> { static const RawValueType value = RawValueType::Float; };
+template<> struct RawValueTypeOf<double> { static const RawValueType value = RawValueType::Double; };
+
+// Fixed-size little-endian header at the start of the file. Fields are ordered so that the struct has no padding.
+struct RawVolumeHeader
+{
+	char magic[8];
+	unsigned int version;
+	unsigned int valueType;
+	unsigned int valueSize;
+	unsigned int compression;
+	unsigned int resolution[3];
+	unsigned int chunkDepth;
+	double origin[3];
+	double length[3];
+	unsigned long long dataOffset;
+	unsigned long long dataSize;
+};
+
+static_assert(sizeof(RawVolumeHeader) == 104, "RawVolumeHeader must not be padded");
+
+// Binary volume: the header above, then the voxel values in Grid3d order (x fastest) split into chunks of
+// chunkDepth whole z slices. The data section starts at a DataAlignment boundary and every chunk is padded to the
+// next one, so each chunk can be mapped or read on its own. Loading maps the file and copies the slices straight
+// into the grid in parallel, without parsing. Version 1 files hold a single chunk and store 0 as chunkDepth.
+template<typename GeomType, typename ValueType>
+class RawVolumeFile final
+{
+public:
+	static const unsigned int Version = 2;
+
+	static const size_t DataAlignment = 4096;
+
+	RawVolumeFile() :
+		chunkSize(4 * 1024 * 1024)
+	{}
+
+	// target bytes per chunk when saving; a chunk always holds at least one z slice.
+	void setChunkSize(const size_t size) { this->chunkSize = size; }
+
+	size_t getChunkSize() const { return chunkSize; }
+
+	bool save(const std::string& filename, const Math::Volume3d<GeomType, ValueType>& volume) const;
+
+	bool load(const std::string& filename, Math::Volume3d<GeomType, ValueType>& volume) const;
+
+	static bool readHeader(const std::string& filename, RawVolumeHeader& header);
+
+private:
+	size_t chunkSize;
+};
+
+template<typename GeomType, typename ValueType>
+const unsigned int RawVolumeFile<GeomType, ValueType>::Version;
+
+template<typename GeomType, typename ValueType>
+const size_t RawVolumeFile<GeomType, ValueType>::DataAlignment;
+
+	}
+}
+
+#endif
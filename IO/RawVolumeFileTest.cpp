@@ -0,0 +1,170 @@
+#include "gtest/gtest.h"
+
+#include "RawVolumeFile.h"
+#include "MappedFile.h"
+
+#include <cstdio>
+#include <fstream>
+#include <vector>
+#include <iterator>
+#include <cstring>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+using FloatVolumeFile = RawVolumeFile<float, float>;
+
+class RawVolumeFileTest : public testing::Test {
+protected:
+	template<typename T>
+	static Volume3d<float, T> createVolume()
+	{
+		Grid3d<T> grid(3, 4, 5);
+		for (size_t z = 0; z < 5; ++z) {
+			for (size_t y = 0; y < 4; ++y) {
+				for (size_t x = 0; x < 3; ++x) {
+					grid.set(x, y, z, static_cast<T>(x + y * 3 + z * 12));
+				}
+			}
+		}
+		return Volume3d<float, T>(Space3d<float>(Vector3d<float>(-1, 2, 3), Vector3d<float>(3, 4, 10)), grid);
+	}
+};
+
+TEST_F(RawVolumeFileTest, TestSaveAndLoad)
+{
+	const std::string filename = "RawVolumeFileTest.cgr";
+	const auto& expected = createVolume<float>();
+	FloatVolumeFile file;
+	EXPECT_TRUE(file.save(filename, expected));
+
+	RawVolumeHeader header;
+	EXPECT_TRUE(FloatVolumeFile::readHeader(filename, header));
+	EXPECT_EQ(3, header.resolution[0]);
+	EXPECT_EQ(4, header.resolution[1]);
+	EXPECT_EQ(5, header.resolution[2]);
+	EXPECT_EQ(FloatVolumeFile::DataAlignment, header.dataOffset);
+	EXPECT_EQ(static_cast<unsigned int>(RawValueType::Float), header.valueType);
+
+	Volume3d<float, float> actual;
+	EXPECT_TRUE(file.load(filename, actual));
+	EXPECT_EQ(expected.getGrid(), actual.getGrid());
+	EXPECT_EQ(expected.getStart(), actual.getStart());
+	EXPECT_EQ(expected.getSpace().getLengths(), actual.getSpace().getLengths());
+	EXPECT_TRUE(actual.isDirty());
+	std::remove(filename.c_str());
+}
+
+TEST_F(RawVolumeFileTest, TestValueTypeMismatch)
+{
+	const std::string filename = "RawVolumeFileTest.cgr";
+	RawVolumeFile<float, unsigned char> file;
+	EXPECT_TRUE(file.save(filename, createVolume<unsigned char>()));
+
+	Volume3d<float, unsigned char> bytes;
+	EXPECT_TRUE(file.load(filename, bytes));
+	EXPECT_EQ(59, bytes.getValue(2, 3, 4));
+
+	Volume3d<float, float> floats;
+	EXPECT_FALSE(FloatVolumeFile().load(filename, floats));
+	std::remove(filename.c_str());
+}
+
+TEST_F(RawVolumeFileTest, TestLoadInvalid)
+{
+	const std::string filename = "RawVolumeFileTest.cgr";
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		stream << "not a volume";
+	}
+	Volume3d<float, float> volume;
+	EXPECT_FALSE(FloatVolumeFile().load(filename, volume));
+	EXPECT_FALSE(FloatVolumeFile().load("NotExisting.cgr", volume));
+	std::remove(filename.c_str());
+}
+
+TEST_F(RawVolumeFileTest, TestChunks)
+{
+	const std::string filename = "RawVolumeFileTest.cgr";
+	const auto& expected = createVolume<float>();
+	FloatVolumeFile file;
+	// two slices of 48 bytes per chunk.
+	file.setChunkSize(100);
+	EXPECT_TRUE(file.save(filename, expected));
+
+	RawVolumeHeader header;
+	EXPECT_TRUE(FloatVolumeFile::readHeader(filename, header));
+	EXPECT_EQ(2, header.chunkDepth);
+	EXPECT_EQ(FloatVolumeFile::DataAlignment * 2 + 48, header.dataSize);
+	{
+		MappedFile mapped(filename);
+		float v = 0;
+		std::memcpy(&v, mapped.getData() + header.dataOffset + FloatVolumeFile::DataAlignment, sizeof(v));
+		EXPECT_EQ(expected.getValue(0, 0, 2), v);
+	}
+
+	Volume3d<float, float> actual;
+	EXPECT_TRUE(file.load(filename, actual));
+	EXPECT_EQ(expected.getGrid(), actual.getGrid());
+	std::remove(filename.c_str());
+}
+
+TEST_F(RawVolumeFileTest, TestLoadCrafted)
+{
+	const std::string filename = "RawVolumeFileTest.cgr";
+	FloatVolumeFile file;
+	EXPECT_TRUE(file.save(filename, createVolume<float>()));
+	RawVolumeHeader valid;
+	EXPECT_TRUE(FloatVolumeFile::readHeader(filename, valid));
+	std::vector<char> data;
+	{
+		std::ifstream stream(filename, std::ios::binary);
+		data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+	}
+	const auto writeWith = [&](const RawVolumeHeader& header) {
+		std::memcpy(data.data(), &header, sizeof(header));
+		std::ofstream stream(filename, std::ios::binary);
+		stream.write(data.data(), data.size());
+	};
+	Volume3d<float, float> volume;
+
+	// an offset near 2^64 must not wrap around the size check.
+	RawVolumeHeader header = valid;
+	header.dataOffset = ~0ull - header.dataSize + 2;
+	writeWith(header);
+	EXPECT_FALSE(file.load(filename, volume));
+
+	// a resolution whose byte count overflows 64 bits.
+	header = valid;
+	header.resolution[0] = header.resolution[1] = header.resolution[2] = 0xffffffff;
+	writeWith(header);
+	EXPECT_FALSE(file.load(filename, volume));
+
+	header = valid;
+	header.valueSize = 0;
+	writeWith(header);
+	EXPECT_FALSE(FloatVolumeFile::readHeader(filename, header));
+
+	writeWith(valid);
+	EXPECT_TRUE(file.load(filename, volume));
+	std::remove(filename.c_str());
+}
+
+TEST(MappedFileTest, TestOpen)
+{
+	const std::string filename = "MappedFileTest.bin";
+	{
+		std::ofstream stream(filename, std::ios::binary);
+		stream << "abc";
+	}
+	{
+		MappedFile file(filename);
+		ASSERT_TRUE(file.isOpen());
+		EXPECT_EQ(3, file.getSize());
+		EXPECT_EQ('b', file.getData()[1]);
+		file.close();
+		EXPECT_FALSE(file.isOpen());
+	}
+	EXPECT_FALSE(MappedFile("NotExisting.bin").isOpen());
+	std::remove(filename.c_str());
+}
@@ -0,0 +1,127 @@
+#include "STLASCIIReader.h"
+
+#include "MappedFile.h"
+#include "TextScanner.h"
+
+#include <iterator>
+#include <vector>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+namespace {
+	bool readVector(TextScanner& scanner, Vector3d<float>& v)
+	{
+		float x = 0.0f;
+		float y = 0.0f;
+		float z = 0.0f;
+		if (!scanner.readFloat(x) || !scanner.readFloat(y) || !scanner.readFloat(z)) {
+			return false;
+		}
+		v = Vector3d<float>(x, y, z);
+		return true;
+	}
+}
+
+bool STLASCIIReader::read(const std::string& filename)
+{
+	MappedFile file;
+	if (!file.open(filename)) {
+		clear();
+		error = "cannot open " + filename;
+		return false;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.getData());
+	return read(begin, begin + file.getSize());
+}
+
+bool STLASCIIReader::read(std::istream& stream)
+{
+	const std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return read(buffer.data(), buffer.data() + buffer.size());
+}
+
+bool STLASCIIReader::read(const char* begin, const char* end)
+{
+	clear();
+	TextScanner scanner(begin, end);
+	const auto fail = [&](const std::string& message) {
+		errorLine = scanner.getLine();
+		errorColumn = scanner.getColumn();
+		error = std::to_string(errorLine) + ":" + std::to_string(errorColumn) + ": " + message;
+		normals.clear();
+		positions.clear();
+		return false;
+	};
+
+	if (!scanner.readKeyword("solid")) {
+		return fail("expected 'solid'");
+	}
+	title = scanner.readLine();
+	Vector3dVector<float> loop;
+	for (;;) {
+		if (scanner.readKeyword("endsolid")) {
+			return true;
+		}
+		if (!scanner.readKeyword("facet")) {
+			return fail(scanner.isEnd() ? "expected 'endsolid' before the end of the file" : "expected 'facet' or 'endsolid'");
+		}
+		Vector3d<float> normal;
+		if (!scanner.readKeyword("normal")) {
+			return fail("expected 'normal'");
+		}
+		if (!readVector(scanner, normal)) {
+			return fail("expected a number");
+		}
+		if (!scanner.readKeyword("outer")) {
+			return fail("expected 'outer'");
+		}
+		if (!scanner.readKeyword("loop")) {
+			return fail("expected 'loop'");
+		}
+		loop.clear();
+		while (!scanner.readKeyword("endloop")) {
+			Vector3d<float> v;
+			if (!scanner.readKeyword("vertex")) {
+				return fail("expected 'vertex' or 'endloop'");
+			}
+			if (!readVector(scanner, v)) {
+				return fail("expected a number");
+			}
+			loop.push_back(v);
+		}
+		if (loop.size() < 3) {
+			return fail("a facet needs at least 3 vertices");
+		}
+		if (!scanner.readKeyword("endfacet")) {
+			return fail("expected 'endfacet'");
+		}
+		for (size_t i = 1; i + 1 < loop.size(); ++i) {
+			normals.push_back(normal);
+			positions.push_back(loop[0]);
+			positions.push_back(loop[i]);
+			positions.push_back(loop[i + 1]);
+		}
+	}
+}
+
+void STLASCIIReader::clear()
+{
+	title.clear();
+	normals.clear();
+	positions.clear();
+	error.clear();
+	errorLine = 0;
+	errorColumn = 0;
+}
+
+STLCellVector STLASCIIReader::toCells() const
+{
+	STLCellVector cells;
+	cells.reserve(getTriangleCount());
+	for (size_t i = 0; i < getTriangleCount(); ++i) {
+		const Vector3dVector<float> ps(positions.begin() + i * 3, positions.begin() + i * 3 + 3);
+		cells.push_back(STLCell(ps, normals[i]));
+	}
+	return cells;
+}
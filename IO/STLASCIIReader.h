@@ -0,0 +1,65 @@
+#ifndef __CRYSTAL_IO_STL_ASCII_READER_H__
+#define __CRYSTAL_IO_STL_ASCII_READER_H__
+
+#include "STLFile.h"
+
+#include <string>
+#include <istream>
+
+namespace Crystal {
+	namespace IO {
+
+// Reads ASCII STL from a character range (memory-mapped for files) with a tokenizer instead of stream extraction.
+// Keywords are matched ignoring case, loops with more than three vertices are fan-triangulated, and malformed
+// input makes read() return false with the line and column of the offending token.
+class STLASCIIReader final
+{
+public:
+	STLASCIIReader() :
+		errorLine(0),
+		errorColumn(0)
+	{}
+
+	~STLASCIIReader() = default;
+
+	bool read(const std::string& filename);
+
+	bool read(std::istream& stream);
+
+	bool read(const char* begin, const char* end);
+
+	void clear();
+
+	// the rest of the "solid" line, as STLFile keeps it.
+	std::string getTitle() const { return title; }
+
+	size_t getTriangleCount() const { return normals.size(); }
+
+	// one per triangle.
+	const Math::Vector3dVector<float>& getNormals() const { return normals; }
+
+	// three per triangle.
+	const Math::Vector3dVector<float>& getPositions() const { return positions; }
+
+	STLCellVector toCells() const;
+
+	// "line:column: message" for the last failed read, empty otherwise.
+	std::string getError() const { return error; }
+
+	unsigned int getErrorLine() const { return errorLine; }
+
+	unsigned int getErrorColumn() const { return errorColumn; }
+
+private:
+	std::string title;
+	Math::Vector3dVector<float> normals;
+	Math::Vector3dVector<float> positions;
+	std::string error;
+	unsigned int errorLine;
+	unsigned int errorColumn;
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,110 @@
+#include "gtest/gtest.h"
+
+#include "STLASCIIReader.h"
+#include "STLBinaryFile.h"
+
+#include <sstream>
+#include <fstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class STLASCIIReaderTest : public testing::Test {
+protected:
+	STLASCIIReaderTest()
+	{
+		std::stringstream stream;
+		stream
+			<< "solid cube" << std::endl
+			<< "facet normal 0 0 1" << std::endl
+			<< "  outer loop" << std::endl
+			<< "    vertex 0 0 1" << std::endl
+			<< "    vertex 1 0 1" << std::endl
+			<< "    vertex 0 1 1" << std::endl
+			<< "  endloop" << std::endl
+			<< "endfacet" << std::endl
+			<< "FACET NORMAL 0 0 -1" << std::endl
+			<< "  OUTER LOOP" << std::endl
+			<< "    VERTEX 0 0 0" << std::endl
+			<< "    VERTEX 1 0 0" << std::endl
+			<< "    VERTEX 1 1 0" << std::endl
+			<< "    VERTEX 0 1 0" << std::endl
+			<< "  ENDLOOP" << std::endl
+			<< "ENDFACET" << std::endl
+			<< "endsolid cube" << std::endl;
+		text = stream.str();
+	}
+
+	static STLASCIIReader readText(const std::string& str)
+	{
+		STLASCIIReader reader;
+		reader.read(str.data(), str.data() + str.size());
+		return reader;
+	}
+
+	std::string text;
+};
+
+TEST_F(STLASCIIReaderTest, TestRead)
+{
+	std::stringstream stream(text);
+	STLASCIIReader reader;
+	EXPECT_TRUE(reader.read(stream));
+	EXPECT_EQ(" cube", reader.getTitle());
+	EXPECT_EQ(3, reader.getTriangleCount());
+	EXPECT_EQ(Vector3d<float>(0, 0, -1), reader.getNormals()[2]);
+	const Vector3dVector<float> last = { Vector3d<float>(0, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) };
+	EXPECT_EQ(last, Vector3dVector<float>(reader.getPositions().begin() + 6, reader.getPositions().end()));
+	EXPECT_TRUE(reader.getError().empty());
+	EXPECT_EQ(3, reader.toCells().size());
+}
+
+TEST_F(STLASCIIReaderTest, TestReadErrors)
+{
+	std::string str = text;
+	str.replace(str.find("vertex 1 0 1"), 12, "vertex 1 x 1");
+	STLASCIIReader reader = readText(str);
+	EXPECT_EQ("5:14: expected a number", reader.getError());
+	EXPECT_EQ(5, reader.getErrorLine());
+	EXPECT_EQ(14, reader.getErrorColumn());
+	EXPECT_EQ(0, reader.getTriangleCount());
+
+	str = text;
+	str.replace(str.find("endfacet"), 8, "endfacte");
+	EXPECT_EQ("8:1: expected 'endfacet'", readText(str).getError());
+
+	str = text;
+	str.resize(str.find("endsolid cube"));
+	EXPECT_EQ("17:1: expected 'endsolid' before the end of the file", readText(str).getError());
+
+	EXPECT_EQ("1:1: expected 'solid'", readText("facet").getError());
+
+	str = "solid\nfacet normal 0 0 1\nouter loop\nvertex 0 0 0\nendloop\nendfacet\nendsolid\n";
+	EXPECT_EQ("5:1: a facet needs at least 3 vertices", readText(str).getError());
+}
+
+TEST_F(STLASCIIReaderTest, TestReadByFileSize)
+{
+	const std::string filename = "STLASCIIReaderTest.stl";
+	{
+		std::ofstream stream(filename);
+		stream << text;
+	}
+	STLFile ascii;
+	EXPECT_TRUE(ascii.read(filename));
+	EXPECT_EQ(3, ascii.getCells().size());
+
+	// a binary file whose header starts with "solid" as many exporters write it.
+	STLBinaryFile binary;
+	binary.setTitle("solid cube facet");
+	binary.setCells(ascii.getCells());
+	EXPECT_TRUE(binary.write(filename));
+	STLFile file;
+	EXPECT_TRUE(file.read(filename));
+	EXPECT_EQ(ascii.getCells(), file.getCells());
+	EXPECT_EQ("solid cube facet", file.getTitle());
+	std::remove(filename.c_str());
+
+	EXPECT_FALSE(file.read("NotExisting.stl"));
+}
@@ -0,0 +1,156 @@
+#include "STLBinaryFile.h"
+
+#include "MappedFile.h"
+#include "../Util/Parallel.h"
+
+#include <fstream>
+#include <iterator>
+#include <cstring>
+#include <algorithm>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+const size_t STLBinaryFile::HeaderSize;
+
+namespace {
+	const size_t RecordBlockSize = 16 * 1024;
+
+	Vector3d<float> toVector(const float v[3]) { return Vector3d<float>(v[0], v[1], v[2]); }
+
+	void toArray(const Vector3d<float>& v, float a[3])
+	{
+		a[0] = v.getX();
+		a[1] = v.getY();
+		a[2] = v.getZ();
+	}
+}
+
+bool STLBinaryFile::read(const std::string& filename)
+{
+	MappedFile file;
+	if (!file.open(filename)) {
+		return false;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.getData());
+	return read(begin, begin + file.getSize());
+}
+
+bool STLBinaryFile::read(std::istream& stream)
+{
+	const std::vector<char> buffer((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+	return read(buffer.data(), buffer.data() + buffer.size());
+}
+
+bool STLBinaryFile::read(const char* begin, const char* end)
+{
+	clear();
+	const size_t size = end - begin;
+	if (size < HeaderSize + sizeof(unsigned int)) {
+		return false;
+	}
+	unsigned int count = 0;
+	std::memcpy(&count, begin + HeaderSize, sizeof(count));
+	if (size != HeaderSize + sizeof(unsigned int) + count * sizeof(STLRecord)) {
+		return false;
+	}
+	const char* head = begin;
+	title.assign(head, std::find(head, head + HeaderSize, '\0'));
+
+	normals.resize(count);
+	positions.resize(count * size_t(3));
+	attributes.resize(count);
+	const STLRecord* records = reinterpret_cast<const STLRecord*>(begin + HeaderSize + sizeof(unsigned int));
+	Util::parallelForBlocks(count, RecordBlockSize, [&](const size_t first, const size_t last) {
+		for (size_t i = first; i < last; ++i) {
+			const STLRecord& r = records[i];
+			normals[i] = toVector(r.normal);
+			positions[i * 3] = toVector(r.positions[0]);
+			positions[i * 3 + 1] = toVector(r.positions[1]);
+			positions[i * 3 + 2] = toVector(r.positions[2]);
+			attributes[i] = r.attribute;
+		}
+	}, threadCount);
+	return true;
+}
+
+bool STLBinaryFile::write(const std::string& filename) const
+{
+	std::ofstream stream(filename.c_str(), std::ios::binary);
+	if (!stream.is_open()) {
+		return false;
+	}
+	return write(stream);
+}
+
+// records are packed a block per thread at a time into one reused buffer.
+bool STLBinaryFile::write(std::ostream& stream) const
+{
+	char head[HeaderSize] = {};
+	std::memcpy(head, title.data(), std::min(title.size(), HeaderSize));
+	stream.write(head, HeaderSize);
+	const unsigned int count = static_cast<unsigned int>(getTriangleCount());
+	stream.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+	const size_t windowSize = RecordBlockSize * ((threadCount == 0) ? Util::getThreadCount() : threadCount);
+	std::vector<STLRecord> records(std::min<size_t>(count, windowSize));
+	for (size_t first = 0; first < count; first += windowSize) {
+		const size_t n = std::min<size_t>(windowSize, count - first);
+		Util::parallelForBlocks(n, RecordBlockSize, [&](const size_t b, const size_t e) {
+			for (size_t i = b; i < e; ++i) {
+				STLRecord& r = records[i];
+				const size_t t = first + i;
+				toArray(normals[t], r.normal);
+				toArray(positions[t * 3], r.positions[0]);
+				toArray(positions[t * 3 + 1], r.positions[1]);
+				toArray(positions[t * 3 + 2], r.positions[2]);
+				r.attribute = attributes[t];
+			}
+		}, threadCount);
+		stream.write(reinterpret_cast<const char*>(records.data()), n * sizeof(STLRecord));
+	}
+	stream.flush();
+	return stream.good();
+}
+
+void STLBinaryFile::clear()
+{
+	title.clear();
+	normals.clear();
+	positions.clear();
+	attributes.clear();
+}
+
+void STLBinaryFile::setTriangles(const Vector3dVector<float>& normals, const Vector3dVector<float>& positions)
+{
+	this->normals = normals;
+	this->positions = positions;
+	this->attributes.assign(normals.size(), 0);
+}
+
+void STLBinaryFile::setCells(const STLCellVector& cells)
+{
+	normals.clear();
+	positions.clear();
+	for (const auto& c : cells) {
+		const auto& ps = c.getPositions();
+		for (size_t i = 1; i + 1 < ps.size(); ++i) {
+			normals.push_back(c.getNormal());
+			positions.push_back(ps[0]);
+			positions.push_back(ps[i]);
+			positions.push_back(ps[i + 1]);
+		}
+	}
+	attributes.assign(normals.size(), 0);
+}
+
+STLCellVector STLBinaryFile::toCells() const
+{
+	STLCellVector cells;
+	cells.reserve(getTriangleCount());
+	for (size_t i = 0; i < getTriangleCount(); ++i) {
+		const Vector3dVector<float> ps(positions.begin() + i * 3, positions.begin() + i * 3 + 3);
+		cells.push_back(STLCell(ps, normals[i]));
+	}
+	return cells;
+}
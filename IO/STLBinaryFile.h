@@ -0,0 +1,88 @@
+#ifndef __CRYSTAL_IO_STL_BINARY_FILE_H__
+#define __CRYSTAL_IO_STL_BINARY_FILE_H__
+
+#include "STLFile.h"
+
+#include <string>
+#include <vector>
+#include <istream>
+#include <ostream>
+
+namespace Crystal {
+	namespace IO {
+
+#pragma pack(push, 1)
+// One little-endian binary STL triangle as stored in the file.
+struct STLRecord
+{
+	float normal[3];
+	float positions[3][3];
+	unsigned short attribute;
+};
+#pragma pack(pop)
+
+static_assert(sizeof(STLRecord) == 50, "STLRecord must be packed");
+
+// Binary STL held as flat arrays: one normal and attribute per triangle, three positions per triangle.
+// Files are memory-mapped and the records are converted in place in parallel, with no per-triangle allocation.
+class STLBinaryFile final
+{
+public:
+	static const size_t HeaderSize = 80;
+
+	STLBinaryFile() :
+		threadCount(0)
+	{}
+
+	~STLBinaryFile() = default;
+
+	bool read(const std::string& filename);
+
+	bool read(std::istream& stream);
+
+	// false unless the range is an 84 byte header followed by exactly the triangles it counts.
+	bool read(const char* begin, const char* end);
+
+	bool write(const std::string& filename) const;
+
+	bool write(std::ostream& stream) const;
+
+	void clear();
+
+	// 0: one thread per core.
+	void setThreadCount(const unsigned int count) { this->threadCount = count; }
+
+	unsigned int getThreadCount() const { return threadCount; }
+
+	// at most HeaderSize characters are written.
+	void setTitle(const std::string& title) { this->title = title; }
+
+	std::string getTitle() const { return title; }
+
+	void setTriangles(const Math::Vector3dVector<float>& normals, const Math::Vector3dVector<float>& positions);
+
+	size_t getTriangleCount() const { return normals.size(); }
+
+	const Math::Vector3dVector<float>& getNormals() const { return normals; }
+
+	const Math::Vector3dVector<float>& getPositions() const { return positions; }
+
+	const std::vector<unsigned short>& getAttributes() const { return attributes; }
+
+	// polygons are fan-triangulated.
+	void setCells(const STLCellVector& cells);
+
+	STLCellVector toCells() const;
+
+private:
+	unsigned int threadCount;
+	std::string title;
+	Math::Vector3dVector<float> normals;
+	Math::Vector3dVector<float> positions;
+	std::vector<unsigned short> attributes;
+};
+
+	}
+}
+
+#endif
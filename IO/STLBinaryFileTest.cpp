@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include "STLBinaryFile.h"
+
+#include <sstream>
+#include <cstdio>
+
+using namespace Crystal::Math;
+using namespace Crystal::IO;
+
+class STLBinaryFileTest : public testing::Test {
+protected:
+	STLBinaryFileTest() :
+		cells({
+			STLCell({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 0, 0), Vector3d<float>(1, 1, 0) }, Vector3d<float>(0, 0, 1)),
+			STLCell({ Vector3d<float>(0, 0, 0), Vector3d<float>(1, 1, 0), Vector3d<float>(0, 1, 0) }, Vector3d<float>(0, 0, -1))
+		})
+	{}
+
+	const STLCellVector cells;
+};
+
+TEST_F(STLBinaryFileTest, TestReadLegacy)
+{
+	STLFile legacy;
+	legacy.setTitle("cube");
+	legacy.setCells(cells);
+	std::stringstream stream;
+	legacy.writeBinary(stream);
+
+	STLBinaryFile file;
+	EXPECT_TRUE(file.read(stream));
+	EXPECT_EQ("cube", file.getTitle());
+	EXPECT_EQ(2, file.getTriangleCount());
+	EXPECT_EQ(Vector3d<float>(0, 0, -1), file.getNormals()[1]);
+	EXPECT_EQ(Vector3d<float>(0, 1, 0), file.getPositions()[5]);
+	EXPECT_EQ(std::vector<unsigned short>(2, 0), file.getAttributes());
+	EXPECT_EQ(cells, file.toCells());
+}
+
+TEST_F(STLBinaryFileTest, TestWrite)
+{
+	STLFile legacy;
+	legacy.setTitle("cube");
+	legacy.setCells(cells);
+	std::stringstream expected;
+	legacy.writeBinary(expected);
+
+	STLBinaryFile file;
+	file.setTitle("cube");
+	file.setCells(cells);
+	std::stringstream stream;
+	EXPECT_TRUE(file.write(stream));
+	EXPECT_EQ(expected.str(), stream.str());
+}
+
+TEST_F(STLBinaryFileTest, TestWriteAndReadInBlocks)
+{
+	Vector3dVector<float> normals;
+	Vector3dVector<float> positions;
+	for (int i = 0; i < 50000; ++i) {
+		normals.push_back(Vector3d<float>(0, 0, float(i)));
+		positions.push_back(Vector3d<float>(float(i), 0, 0));
+		positions.push_back(Vector3d<float>(0, float(i), 0));
+		positions.push_back(Vector3d<float>(0, 0, float(i)));
+	}
+	STLBinaryFile file;
+	file.setThreadCount(2);
+	file.setTitle(std::string(100, 'x'));
+	file.setTriangles(normals, positions);
+
+	const std::string filename = "STLBinaryFileTest.stl";
+	EXPECT_TRUE(file.write(filename));
+
+	STLBinaryFile actual;
+	actual.setThreadCount(4);
+	EXPECT_TRUE(actual.read(filename));
+	EXPECT_EQ(std::string(80, 'x'), actual.getTitle());
+	EXPECT_EQ(normals, actual.getNormals());
+	EXPECT_EQ(positions, actual.getPositions());
+	std::remove(filename.c_str());
+}
+
+TEST_F(STLBinaryFileTest, TestReadInvalid)
+{
+	STLBinaryFile file;
+	file.setCells(cells);
+	std::stringstream stream;
+	EXPECT_TRUE(file.write(stream));
+	const std::string str = stream.str();
+
+	STLBinaryFile actual;
+	EXPECT_FALSE(actual.read(str.data(), str.data() + str.size() - 1));
+	EXPECT_FALSE(actual.read(str.data(), str.data() + 83));
+	EXPECT_EQ(0, actual.getTriangleCount());
+	EXPECT_FALSE(actual.read("NotExisting.stl"));
+}
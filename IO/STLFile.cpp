@@ -1,83 +1,63 @@
 #include "STLFile.h"
 
-#include "Helper.h"
+#include "STLASCIIReader.h"
+#include "STLBinaryFile.h"
+#include "MappedFile.h"
 
 using namespace Crystal::Math;
 using namespace Crystal::IO;
 
 #include <string>
-#include <cassert>
+#include <cstring>
 
+// binary when the size is exactly the 84 byte header plus the 50 byte records it counts, ASCII otherwise.
 bool STLFile::read( const std::string& filename ) {
-	std::ifstream stream( filename );
-
-	std::string str0, str1,str2;
-	stream >> str0;
-	stream >> str1;
-	stream >> str2;
-	stream.close();
-
-	if( str0 == "solid" && str2 == "facet" ) {
-		return readASCII( filename );
+	MappedFile file;
+	if (!file.open(filename)) {
+		return false;
+	}
+	const char* begin = reinterpret_cast<const char*>(file.getData());
+	const char* end = begin + file.getSize();
+	unsigned int count = 0;
+	if (file.getSize() >= 84) {
+		std::memcpy(&count, begin + 80, sizeof(count));
 	}
-	else {
-		return readBinary( filename );
+	if (file.getSize() >= 84 && file.getSize() == 84 + count * size_t(50)) {
+		STLBinaryFile binary;
+		if (!binary.read(begin, end)) {
+			return false;
+		}
+		title = binary.getTitle();
+		cells = binary.toCells();
+		return true;
+	}
+	STLASCIIReader reader;
+	if (!reader.read(begin, end)) {
+		return false;
 	}
+	title = reader.getTitle();
+	cells = reader.toCells();
+	return true;
 }
 
 bool STLFile::readASCII(const std::string& filename) {
-	std::ifstream stream;
-	stream.open(filename);
-	if (!stream.is_open()) {
+	STLASCIIReader reader;
+	if (!reader.read(filename)) {
 		return false;
 	}
-	return readASCII(stream);
+	title = reader.getTitle();
+	cells = reader.toCells();
+	return true;
 }
 
 bool STLFile::readASCII(std::istream& stream)
 {
-	std::string str = Helper::read<std::string>(stream);
-
-	assert( str == "solid" );
-
-	std::getline(stream, str);
-
-	title = str;
-
-	str = Helper::read<std::string>(stream);
-	while( str != "endsolid" ) {
-		assert( str == "facet" );
-		str = Helper::read<std::string>(stream);
-		assert(str == "normal");
-
-		STLCell cell;
-		const Vector3d<float>& normal = Helper::readVector(stream);
-		cell.setNormal( normal );
-			
-		stream >> str;
-		assert( str == "outer" );
-
-		stream >> str;
-		assert( str == "loop" );
-
-		for( int i = 0; i < 3; ++i ) {
-			stream >> str;
-			assert( str == "vertex" );
-				
-			const Vector3d<float>& position = Helper::readVector(stream);
-			cell.addPosition( position );
-		}
-		cells.push_back( cell );
-
-		str = Helper::read<std::string>(stream);
-		assert( str == "endloop" );
-
-		str = Helper::read<std::string>(stream);
-		assert(str == "endfacet");
-
-		str = Helper::read<std::string>(stream);
+	STLASCIIReader reader;
+	if (!reader.read(stream)) {
+		return false;
 	}
-
+	title = reader.getTitle();
+	cells = reader.toCells();
 	return true;
 }
 
@@ -116,7 +96,7 @@ bool STLFile::writeASCII(std::ostream& stream)
 
 bool STLFile::readBinary(const std::string& filename) {
 	std::ifstream stream;
-	stream.open(filename);
+	stream.open(filename, std::ios::binary);
 	if (!stream.is_open()) {
 		return false;
 	}
@@ -155,20 +135,22 @@ bool STLFile::readBinary(std::istream& stream) {
 
 bool STLFile::writeBinary(std::ostream& stream)
 {
-	const char* head = title.c_str();
-	stream.write(head, 80);
+	char head[80] = {};
+	title.copy(head, sizeof(head));
+	stream.write(head, sizeof(head));
 
-	const unsigned int howMany = cells.size();
+	const unsigned int howMany = static_cast<unsigned int>(cells.size());
 	stream.write( (char *)&howMany, sizeof(unsigned int) );
 
 	for (const STLCell& cell : cells) {
-		const std::vector<float>& normal = cell.getNormal().toArray();
-		stream.write((char *)&(normal.front()), sizeof(float) * 3);
+		const Vector3d<float>& normal = cell.getNormal();
+		const float n[3] = { normal.getX(), normal.getY(), normal.getZ() };
+		stream.write((char *)n, sizeof(float) * 3);
 		for (const Vector3d<float>& pos : cell.getPositions()) {
-			const std::vector<float>& p = pos.toArray();
-			stream.write((char *)&(p.front()), sizeof(float) * 3);
+			const float p[3] = { pos.getX(), pos.getY(), pos.getZ() };
+			stream.write((char *)p, sizeof(float) * 3);
 		}
-		char padding[2];
+		const char padding[2] = { 0, 0 };
 		stream.write(padding, sizeof( char ) * 2);
 	}
 
@@ -111,5 +111,6 @@ TEST(STLFileTest, TestWriteBinary)
 	file.setTitle("Test");
 	file.writeBinary(stream);
 	const std::string& actual = stream.str();
-	//EXPECT_EQ(80, actual.size());
+	ASSERT_EQ(84, actual.size());
+	EXPECT_EQ(std::string("Test") + std::string(80, '\0'), actual.substr(0, 84));
 }
\ No newline at end of file
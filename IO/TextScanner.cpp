@@ -0,0 +1,203 @@
+#include "TextScanner.h"
+
+#include <cstring>
+#include <cstdlib>
+#include <cctype>
+#include <climits>
+#include <algorithm>
+
+using namespace Crystal::IO;
+
+namespace {
+	bool isSpace(const char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == '\f' || c == '\v'; }
+
+	bool isDigit(const char c) { return c >= '0' && c <= '9'; }
+}
+
+bool TextScanner::isEnd()
+{
+	skipSpaces();
+	return p >= end;
+}
+
+bool TextScanner::readToken(std::string& token)
+{
+	if (isEnd()) {
+		return false;
+	}
+	const char* e = toTokenEnd();
+	token.assign(p, e);
+	p = e;
+	return true;
+}
+
+bool TextScanner::readKeyword(const char* keyword)
+{
+	if (isEnd()) {
+		return false;
+	}
+	const char* e = toTokenEnd();
+	const size_t length = std::strlen(keyword);
+	if (static_cast<size_t>(e - p) != length) {
+		return false;
+	}
+	for (size_t i = 0; i < length; ++i) {
+		if (std::tolower(static_cast<unsigned char>(p[i])) != std::tolower(static_cast<unsigned char>(keyword[i]))) {
+			return false;
+		}
+	}
+	p = e;
+	return true;
+}
+
+bool TextScanner::readFloat(float& value)
+{
+	if (isEnd()) {
+		return false;
+	}
+	const char* q = p;
+	if (!parseFloat(q, end, value) || q != toTokenEnd()) {
+		return false;
+	}
+	p = q;
+	return true;
+}
+
+bool TextScanner::readInt(int& value)
+{
+	if (isEnd()) {
+		return false;
+	}
+	const char* q = p;
+	if (!parseInt(q, end, value) || q != toTokenEnd()) {
+		return false;
+	}
+	p = q;
+	return true;
+}
+
+std::string TextScanner::readLine()
+{
+	tokenLine = line;
+	tokenColumn = static_cast<unsigned int>(p - lineBegin) + 1;
+	const char* e = static_cast<const char*>(std::memchr(p, '\n', end - p));
+	if (e == nullptr) {
+		e = end;
+	}
+	const char* last = (e > p && e[-1] == '\r') ? e - 1 : e;
+	const std::string str(p, last);
+	p = e;
+	return str;
+}
+
+void TextScanner::skipSpaces()
+{
+	for (; p < end && isSpace(*p); ++p) {
+		if (*p == '\n') {
+			++line;
+			lineBegin = p + 1;
+		}
+	}
+	tokenLine = line;
+	tokenColumn = static_cast<unsigned int>(p - lineBegin) + 1;
+}
+
+const char* TextScanner::toTokenEnd() const
+{
+	const char* e = p;
+	while (e < end && !isSpace(*e)) {
+		++e;
+	}
+	return e;
+}
+
+bool TextScanner::parseInt(const char*& p, const char* end, int& value)
+{
+	bool isNegative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		isNegative = (*p == '-');
+		++p;
+	}
+	if (p >= end || !isDigit(*p)) {
+		return false;
+	}
+	int v = 0;
+	while (p < end && isDigit(*p)) {
+		const int d = *p - '0';
+		if (v > (INT_MAX - d) / 10) {
+			return false;
+		}
+		v = v * 10 + d;
+		++p;
+	}
+	value = isNegative ? -v : v;
+	return true;
+}
+
+// mantissas that fit a double exactly with small exponents take one multiply or divide by an exact power of ten,
+// which gives the correctly rounded double; anything else goes through strtod. either way the double is rounded
+// again to float, so a value just beside a halfway point between two floats can come out one ulp off.
+bool TextScanner::parseFloat(const char*& p, const char* end, float& value)
+{
+	static const double powers[] = {
+		1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+		1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+	};
+	const char* begin = p;
+	bool isNegative = false;
+	if (p < end && (*p == '-' || *p == '+')) {
+		isNegative = (*p == '-');
+		++p;
+	}
+	unsigned long long mantissa = 0;
+	int digits = 0;
+	int exponent = 0;
+	bool hasDigits = false;
+	for (; p < end && isDigit(*p); ++p) {
+		hasDigits = true;
+		if (digits < 19) {
+			mantissa = mantissa * 10 + (*p - '0');
+			digits += (mantissa != 0) ? 1 : 0;
+		}
+		else {
+			++exponent;
+		}
+	}
+	if (p < end && *p == '.') {
+		for (++p; p < end && isDigit(*p); ++p) {
+			hasDigits = true;
+			if (digits < 19) {
+				mantissa = mantissa * 10 + (*p - '0');
+				digits += (mantissa != 0) ? 1 : 0;
+				--exponent;
+			}
+		}
+	}
+	if (hasDigits && p < end && (*p == 'e' || *p == 'E')) {
+		int e = 0;
+		if (!parseInt(++p, end, e)) {
+			return false;
+		}
+		// far beyond the float range either way; only keeps the sum from overflowing.
+		exponent += std::max(-100000, std::min(e, 100000));
+	}
+	if (!hasDigits) {
+		// nan, inf and other spellings.
+		while (p < end && !isSpace(*p) && *p != '/') {
+			++p;
+		}
+		const std::string token(begin, p);
+		char* last = nullptr;
+		value = static_cast<float>(std::strtod(token.c_str(), &last));
+		return !token.empty() && last == token.c_str() + token.size();
+	}
+	if (mantissa < (1ULL << 53) && exponent >= -22 && exponent <= 22) {
+		double d = static_cast<double>(mantissa);
+		d = (exponent < 0) ? d / powers[-exponent] : d * powers[exponent];
+		value = static_cast<float>(isNegative ? -d : d);
+		return true;
+	}
+	const std::string token(begin, p);
+	value = static_cast<float>(std::strtod(token.c_str(), nullptr));
+	return true;
+}
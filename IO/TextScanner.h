@@ -0,0 +1,67 @@
+#ifndef __CRYSTAL_IO_TEXT_SCANNER_H__
+#define __CRYSTAL_IO_TEXT_SCANNER_H__
+
+#include <string>
+
+namespace Crystal {
+	namespace IO {
+
+// Reads whitespace-separated tokens and numbers straight from a character range, keeping the line and column of
+// the last token so parsers can report where the input went wrong.
+class TextScanner final
+{
+public:
+	TextScanner(const char* begin, const char* end) :
+		p(begin),
+		end(end),
+		lineBegin(begin),
+		line(1),
+		tokenLine(1),
+		tokenColumn(1)
+	{}
+
+	~TextScanner() = default;
+
+	// true when only whitespace is left.
+	bool isEnd();
+
+	// the next token, or false at the end.
+	bool readToken(std::string& token);
+
+	// true when the next token is the keyword, ignoring case.
+	bool readKeyword(const char* keyword);
+
+	bool readFloat(float& value);
+
+	bool readInt(int& value);
+
+	// the rest of the current line without its line break.
+	std::string readLine();
+
+	// 1-based position of the last token read or attempted.
+	unsigned int getLine() const { return tokenLine; }
+
+	unsigned int getColumn() const { return tokenColumn; }
+
+	// parses a number at p and moves p past it.
+	static bool parseInt(const char*& p, const char* end, int& value);
+
+	static bool parseFloat(const char*& p, const char* end, float& value);
+
+private:
+	const char* p;
+	const char* end;
+	const char* lineBegin;
+	unsigned int line;
+	unsigned int tokenLine;
+	unsigned int tokenColumn;
+
+	void skipSpaces();
+
+	const char* toTokenEnd() const;
+};
+
+	}
+}
+
+#endif
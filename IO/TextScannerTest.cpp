@@ -0,0 +1,83 @@
+#include "gtest/gtest.h"
+
+#include "TextScanner.h"
+
+#include <string>
+
+using namespace Crystal::IO;
+
+TEST(TextScannerTest, TestReadTokens)
+{
+	const std::string str = "solid  name\r\n  Facet 1.5 -2e1\n\tx";
+	TextScanner scanner(str.data(), str.data() + str.size());
+	EXPECT_TRUE(scanner.readKeyword("solid"));
+	EXPECT_EQ("  name", scanner.readLine());
+	EXPECT_FALSE(scanner.readKeyword("endfacet"));
+	EXPECT_EQ(2, scanner.getLine());
+	EXPECT_EQ(3, scanner.getColumn());
+	EXPECT_TRUE(scanner.readKeyword("facet"));
+	float f = 0.0f;
+	EXPECT_TRUE(scanner.readFloat(f));
+	EXPECT_FLOAT_EQ(1.5f, f);
+	EXPECT_TRUE(scanner.readFloat(f));
+	EXPECT_FLOAT_EQ(-20.0f, f);
+	EXPECT_FALSE(scanner.readFloat(f));
+	EXPECT_EQ(3, scanner.getLine());
+	EXPECT_EQ(2, scanner.getColumn());
+	std::string token;
+	EXPECT_TRUE(scanner.readToken(token));
+	EXPECT_EQ("x", token);
+	EXPECT_TRUE(scanner.isEnd());
+	EXPECT_FALSE(scanner.readToken(token));
+}
+
+TEST(TextScannerTest, TestParseNumbers)
+{
+	const std::string str = "-12/0.000001 3.4028235e38 1e-40";
+	const char* p = str.data();
+	const char* end = str.data() + str.size();
+	int i = 0;
+	EXPECT_TRUE(TextScanner::parseInt(p, end, i));
+	EXPECT_EQ(-12, i);
+	++p;
+	float f = 0.0f;
+	EXPECT_TRUE(TextScanner::parseFloat(p, end, f));
+	EXPECT_EQ(0.000001f, f);
+	++p;
+	EXPECT_TRUE(TextScanner::parseFloat(p, end, f));
+	EXPECT_EQ(3.4028235e38f, f);
+	++p;
+	EXPECT_TRUE(TextScanner::parseFloat(p, end, f));
+	EXPECT_EQ(1e-40f, f);
+	EXPECT_EQ(end, p);
+}
+
+TEST(TextScannerTest, TestParseOutOfRange)
+{
+	const std::string ints[] = { "2147483647", "2147483648", "4294967297", "99999999999" };
+	int i = 0;
+	const char* p = ints[0].data();
+	EXPECT_TRUE(TextScanner::parseInt(p, ints[0].data() + ints[0].size(), i));
+	EXPECT_EQ(2147483647, i);
+	for (int n = 1; n < 4; ++n) {
+		p = ints[n].data();
+		EXPECT_FALSE(TextScanner::parseInt(p, ints[n].data() + ints[n].size(), i));
+	}
+
+	float f = 0.0f;
+	const std::string exponent = "1e4294967296";
+	p = exponent.data();
+	EXPECT_FALSE(TextScanner::parseFloat(p, exponent.data() + exponent.size(), f));
+
+	// longer than any fixed buffer, with the exponent at the very end.
+	const std::string digits = "0." + std::string(200, '0') + "1e230";
+	p = digits.data();
+	EXPECT_TRUE(TextScanner::parseFloat(p, digits.data() + digits.size(), f));
+	EXPECT_FLOAT_EQ(1e29f, f);
+	EXPECT_EQ(digits.data() + digits.size(), p);
+
+	const std::string face = "f 4294967297";
+	TextScanner scanner(face.data(), face.data() + face.size());
+	EXPECT_TRUE(scanner.readKeyword("f"));
+	EXPECT_FALSE(scanner.readInt(i));
+}
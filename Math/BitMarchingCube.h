@@ -12,10 +12,7 @@ template<typename GeomType>
 class BitMarchingCube
 {
 public:
-	BitMarchingCube() {
-		table.buildEdgeTable();
-		table.buildTriangleTable();
-	}
+	BitMarchingCube() = default;
 
 	TriangleVector<GeomType> march(const BitSpace3d<GeomType>& bs)
 	{
@@ -37,15 +34,13 @@ public:
 	}
 
 private:
-	MarchingCubeTable table;
-
 	TriangleVector<GeomType> build(const int cubeindex, const std::array<Vector3d<GeomType>, 12>& vertices) const {
 		TriangleVector<GeomType> triangles;
-		const auto& triTable = table.getTriangleTable();
-		for (int i = 0; triTable[cubeindex][i] != -1; i += 3) {
-			const auto& v1 = vertices[triTable[cubeindex][i]];
-			const auto& v2 = vertices[triTable[cubeindex][i + 1]];
-			const auto& v3 = vertices[triTable[cubeindex][i + 2]];
+		const signed char* tris = MarchingCubeTable::getTriangles(cubeindex);
+		for (int i = 0; tris[i] != -1; i += 3) {
+			const auto& v1 = vertices[tris[i]];
+			const auto& v2 = vertices[tris[i + 1]];
+			const auto& v3 = vertices[tris[i + 2]];
 			const Triangle<GeomType> t(v1, v2, v3);
 			triangles.emplace_back(t);
 		}
@@ -55,44 +50,12 @@ private:
 
 	std::array< Vector3d<GeomType>, 12 > getPositions(const int cubeindex, const std::array< Vector3d<GeomType>, 8 > p) const {
 		std::array< Vector3d<GeomType>, 12 > vertices;
-		const auto& edgeTable = table.getEdgeTable();
-		//		if (edgeTable[cubeindex] & 1) {
-		if (edgeTable[cubeindex][0]) {
-			vertices[0] = getCenter(p[0], p[1]);
-		}
-		//if (edgeTable[cubeindex] & 2) {
-		if (edgeTable[cubeindex][1]) {
-			vertices[1] = getCenter(p[1], p[2]);
-		}
-		if (edgeTable[cubeindex][2]) {
-			vertices[2] = getCenter(p[2], p[3]);
-		}
-		if (edgeTable[cubeindex][3]) {
-			vertices[3] = getCenter(p[3], p[0]);
-		}
-		if (edgeTable[cubeindex][4]) {
-			vertices[4] = getCenter(p[4], p[5]);
-		}
-		if (edgeTable[cubeindex][5]) {
-			vertices[5] = getCenter(p[5], p[6]);
-		}
-		if (edgeTable[cubeindex][6]) {
-			vertices[6] = getCenter(p[6], p[7]);
-		}
-		if (edgeTable[cubeindex][7]) {
-			vertices[7] = getCenter(p[7], p[4]);
-		}
-		if (edgeTable[cubeindex][8]) {
-			vertices[8] = getCenter(p[0], p[4]);
-		}
-		if (edgeTable[cubeindex][9]) {
-			vertices[9] = getCenter(p[1], p[5]);
-		}
-		if (edgeTable[cubeindex][10]) {
-			vertices[10] = getCenter(p[2], p[6]);
-		}
-		if (edgeTable[cubeindex][11]) {
-			vertices[11] = getCenter(p[3], p[7]);
+		const unsigned short edges = MarchingCubeTable::getEdgeFlags(cubeindex);
+		for (int e = 0; e < 12; ++e) {
+			if (edges & (1 << e)) {
+				const unsigned char* corners = MarchingCubeTable::getEdgeCorners(e);
+				vertices[e] = getCenter(p[corners[0]], p[corners[1]]);
+			}
 		}
 		return vertices;
 	}
@@ -106,4 +69,4 @@ private:
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
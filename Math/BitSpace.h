@@ -128,6 +128,19 @@ public:
 		return results;
 	}
 
+	// sets the voxels holding the points and returns how many points landed inside; the rest are ignored.
+	size_t setPoints(const Vector3dVector<T>& points) {
+		size_t count = 0;
+		Index3d i;
+		for (const auto& p : points) {
+			if (toVoxel(p, i)) {
+				bmp.set(i[0], i[1], i[2]);
+				++count;
+			}
+		}
+		return count;
+	}
+
 	Vector3dVector<T> toEnabledPositions() const {
 		Vector3dVector<T> positions;
 		const auto& spaces = toEnabledSpaces();
@@ -161,15 +174,16 @@ public:
 	}
 	*/
 
+	// combined over the overlap of both spaces.
 	BitSpace3d and(const BitSpace3d<T>& rhs) const {
-		const BitSpace3d& bs = getOverlapped(rhs);
-		bs.getBitmap().and(rhs.getBitmap());
+		BitSpace3d bs = getCombinable(rhs);
+		bs.bmp.and(isSameGrid(rhs) ? rhs.bmp : rhs.getOverlappedBitmap(getSpace()));
 		return bs;
 	}
 
 	BitSpace3d or(const BitSpace3d<T>& rhs) const {
-		const BitSpace3d& bs = getOverlapped(rhs);
-		bs.getBitmap().or(rhs.getBitmap());
+		BitSpace3d bs = getCombinable(rhs);
+		bs.bmp.or(isSameGrid(rhs) ? rhs.bmp : rhs.getOverlappedBitmap(getSpace()));
 		return bs;
 	}
 
@@ -211,6 +225,15 @@ private:
 		return bmp.getSub(startIndex, endIndex);
 	}
 
+	bool isSameGrid(const BitSpace3d<T>& rhs) const {
+		return getSpace() == rhs.getSpace() && bmp.getSizes() == rhs.bmp.getSizes();
+	}
+
+	// the same grid is copied whole, so the packed words are combined without extracting a sub bitmap.
+	BitSpace3d getCombinable(const BitSpace3d<T>& rhs) const {
+		return isSameGrid(rhs) ? (*this) : getOverlapped(rhs);
+	}
+
 
 };
 
@@ -67,9 +67,52 @@ TEST(BitSpaceTest, TestAnd)
 	EXPECT_EQ( Bitmap3d(1, 1, 1), actual.getBitmap() );
 }
 
+TEST(BitSpaceTest, TestAndOr)
+{
+	using T = float;
+	const Space3d<T> space(Vector3d<T>(0, 0, 0), Vector3d<T>(2, 2, 2));
+	Bitmap3d lbmp(2, 2, 2);
+	lbmp.set(0, 0, 0);
+	lbmp.set(1, 0, 0);
+	Bitmap3d rbmp(2, 2, 2);
+	rbmp.set(1, 0, 0);
+	rbmp.set(1, 1, 1);
+	const BitSpace3d<T> lhs(space, lbmp);
+	const BitSpace3d<T> rhs(space, rbmp);
+
+	const BitSpace3d<T> a = lhs.and(rhs);
+	EXPECT_EQ(space, a.getSpace());
+	EXPECT_EQ(1, a.getBitmap().getCount());
+	EXPECT_TRUE(a.getBitmap().get(1, 0, 0));
+
+	const BitSpace3d<T> o = lhs.or(rhs);
+	EXPECT_EQ(3, o.getBitmap().getCount());
+	EXPECT_TRUE(o.getBitmap().get(0, 0, 0));
+	EXPECT_TRUE(o.getBitmap().get(1, 1, 1));
+	EXPECT_FALSE(o.getBitmap().get(0, 1, 0));
+
+	// only the overlap (1, 1, 1) of lhs and (0, 0, 0) of the shifted rhs are combined.
+	Bitmap3d sbmp(2, 2, 2);
+	sbmp.set(0, 0, 0);
+	const BitSpace3d<T> shifted(Space3d<T>(Vector3d<T>(1, 1, 1), Vector3d<T>(2, 2, 2)), sbmp);
+	EXPECT_EQ(Bitmap3d(1, 1, 1), lhs.and(shifted).getBitmap());
+	EXPECT_EQ(Bitmap3d(1, 1, 1, true), lhs.or(shifted).getBitmap());
+	EXPECT_EQ(Bitmap3d(1, 1, 1, true), rhs.and(shifted).getBitmap());
+}
+
 TEST(BitSpaceTest, TestNot)
 {
 	using T = float;
 	BitSpace3d<T> bs(Space3d<T>(Vector3d<T>(0, 0, 0), Vector3d<T>(2, 2, 2)), Bitmap3d(2, 2, 2));
 	EXPECT_EQ(8, bs.not().getBitmap().getCount());
-}
\ No newline at end of file
+}
+
+TEST(BitSpaceTest, TestSetPoints)
+{
+	using T = float;
+	BitSpace3d<T> bs(Space3d<T>(Vector3d<T>(0, 0, 0), Vector3d<T>(4, 4, 4)), Bitmap3d(4, 4, 4));
+	const Vector3dVector<T> points = { Vector3d<T>(0.5, 0.5, 0.5), Vector3d<T>(0.7f, 0.2f, 0.9f), Vector3d<T>(3.5, 1.5, 2.5), Vector3d<T>(5, 0, 0) };
+	EXPECT_EQ(3, bs.setPoints(points));
+	EXPECT_EQ(2, bs.getBitmap().getCount());
+	EXPECT_TRUE(bs.getBitmap().get(3, 1, 2));
+}
@@ -5,112 +5,164 @@
 #include <vector>
 #include <array>
 #include <numeric>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
 
 namespace Crystal {
 	namespace Math {
 
+// bits are packed 64 per word. bits past getSize() in the last word are always kept zero.
 class Bitmap1d final
 {
 public:
-	Bitmap1d()
+	using Word = std::uint64_t;
+
+	Bitmap1d() :
+		size(0)
 	{}
 
 	explicit Bitmap1d(const size_t size) :
-		bits(size)
+		size(size),
+		words(toWordCount(size), 0)
 	{}
 
 	explicit Bitmap1d(const std::vector<bool>& b) :
-		bits(b)
-	{}
+		size(b.size()),
+		words(toWordCount(b.size()), 0)
+	{
+		for (size_t i = 0; i < b.size(); ++i) {
+			if (b[i]) {
+				set(i);
+			}
+		}
+	}
 
 	static Bitmap1d TRUE(const size_t size) {
-		std::vector<bool> values(size, true);
-		return Bitmap1d(values);
+		Bitmap1d bmp(size);
+		bmp.setAll(true);
+		return bmp;
 	}
 
 	static Bitmap1d FALSE(const size_t size) {
-		std::vector<bool> values(size, false);
-		return Bitmap1d(values);
+		return Bitmap1d(size);
 	}
 
 
-	void set( const size_t i, const bool b = true) { bits[i] = b; }
+	void set( const size_t i, const bool b = true) {
+		const Word mask = Word(1) << (i % 64);
+		if (b) {
+			words[i / 64] |= mask;
+		}
+		else {
+			words[i / 64] &= ~mask;
+		}
+	}
 
 	void setAll(const bool b = true) {
-		for (size_t i = 0; i < bits.size(); ++i) {
-			bits[i] = b;
-		}
+		std::fill(words.begin(), words.end(), b ? ~Word(0) : Word(0));
+		clearTail();
 	}
 
-	int getCount() const { return std::count(bits.begin(), bits.end(), true); }
+	int getCount() const {
+		int count = 0;
+		for (const auto w : words) {
+			count += countBits(w);
+		}
+		return count;
+	}
 
-	bool operator[](const size_t i) const { return bits[i]; }
+	bool operator[](const size_t i) const { return get(i); }
 
-	bool get(const size_t i) const { return bits[i]; }
+	bool get(const size_t i) const { return ((words[i / 64] >> (i % 64)) & 1) != 0; }
 
-	Bitmap1d and(const Bitmap1d& rhs) {
-		for (size_t i = 0; i < bits.size(); ++i) {
-			bits[i] = bits[i] & rhs.bits[i];
+	Bitmap1d& and(const Bitmap1d& rhs) {
+		for (size_t i = 0; i < words.size(); ++i) {
+			words[i] &= (i < rhs.words.size()) ? rhs.words[i] : 0;
 		}
+		clearTail();
 		return (*this);
 	}
 
 	Bitmap1d& or(const Bitmap1d& rhs) {
-		for (size_t i = 0; i < bits.size(); ++i) {
-			bits[i] = bits[i] | rhs.bits[i];
+		for (size_t i = 0; i < words.size(); ++i) {
+			words[i] |= (i < rhs.words.size()) ? rhs.words[i] : 0;
 		}
+		clearTail();
 		return *(this);
 	}
 
 	Bitmap1d& xor(const Bitmap1d& rhs) {
-		for (size_t i = 0; i < bits.size(); ++i) {
-			bits[i] = bits[i] ^ rhs.bits[i];
+		for (size_t i = 0; i < words.size(); ++i) {
+			words[i] ^= (i < rhs.words.size()) ? rhs.words[i] : 0;
 		}
+		clearTail();
 		return *(this);
 	}
 
-	Bitmap1d not() {
-		for (size_t i = 0; i < bits.size(); ++i) {
-			bits[i] = !bits[i];
+	Bitmap1d& not() {
+		for (auto& w : words) {
+			w = ~w;
 		}
+		clearTail();
 		return *(this);
 	}
 
-	size_t getSize() const { return bits.size(); }
+	size_t getSize() const { return size; }
 
-	bool isAll() const { return getCount() == getSize(); }
+	bool isAll() const {
+		if (words.empty()) {
+			return true;
+		}
+		for (size_t i = 0; i + 1 < words.size(); ++i) {
+			if (words[i] != ~Word(0)) {
+				return false;
+			}
+		}
+		return words.back() == getTailMask();
+	}
 
 	bool isAny() const { return !isNone(); }
 
-	bool isNone() const { return getCount() == 0; }
-
-	bool operator==(const Bitmap1d& rhs) const { return bits == rhs.bits; }
+	bool isNone() const {
+		for (const auto w : words) {
+			if (w != 0) {
+				return false;
+			}
+		}
+		return true;
+	}
 
-	bool operator!=(const Bitmap1d& rhs) const { return bits != rhs.bits; }
+	bool operator==(const Bitmap1d& rhs) const { return size == rhs.size && words == rhs.words; }
 
-	Bitmap1d& operator=(const Bitmap1d& rhs) {
-		bits = rhs.bits;
-		return *this;
-	}
+	bool operator!=(const Bitmap1d& rhs) const { return !(*this == rhs); }
 
 	std::bitset<2> to2Bit(const size_t i) const {
 		std::bitset<2> b;
-		b.set( bits[i] );
-		b.set( bits[i+1] );
+		b.set( get(i) );
+		b.set( get(i+1) );
 		return b;
 	}
 
 	std::vector< std::bitset<2> > to2Bits() const {
 		std::vector< std::bitset<2> > b;
-		for (size_t i = 1; i < bits.size(); ++i) {
+		for (size_t i = 1; i < size; ++i) {
 			b.push_back(to2Bit(i));
 		}
 		return b;
 	}
 
 	Bitmap1d getSub(const size_t startIndex, const size_t endIndex) const {
-		std::vector<bool> bs(bits.begin() + startIndex, bits.begin() + endIndex);
-		return Bitmap1d( bs );
+		Bitmap1d sub(endIndex - startIndex);
+		for (size_t i = 0; i < sub.words.size(); ++i) {
+			sub.words[i] = getWord(startIndex + i * 64);
+		}
+		sub.clearTail();
+		return sub;
 	}
 
 	void set(const unsigned int start, const Bitmap1d& rhs) {
@@ -120,9 +172,50 @@ public:
 		}
 	}
 
+	size_t getWordCount() const { return words.size(); }
+
+	const Word* getWords() const { return words.data(); }
+
+	static int countBits(const Word w) {
+#if defined(_MSC_VER) && defined(_M_X64)
+		return static_cast<int>( __popcnt64(w) );
+#elif defined(_MSC_VER)
+		return static_cast<int>( __popcnt(static_cast<unsigned int>(w)) + __popcnt(static_cast<unsigned int>(w >> 32)) );
+#else
+		return __builtin_popcountll(w);
+#endif
+	}
 
 private:
-	std::vector<bool> bits;
+	size_t size;
+	std::vector<Word> words;
+
+	static size_t toWordCount(const size_t size) { return (size + 63) / 64; }
+
+	Word getTailMask() const {
+		const size_t rest = size % 64;
+		return (rest == 0) ? ~Word(0) : ((Word(1) << rest) - 1);
+	}
+
+	void clearTail() {
+		if (!words.empty()) {
+			words.back() &= getTailMask();
+		}
+	}
+
+	// 64 bits starting at an arbitrary bit position. bits past the end read as zero.
+	Word getWord(const size_t bit) const {
+		const size_t i = bit / 64;
+		const size_t shift = bit % 64;
+		if (i >= words.size()) {
+			return 0;
+		}
+		Word w = words[i] >> shift;
+		if (shift != 0 && i + 1 < words.size()) {
+			w |= words[i + 1] << (64 - shift);
+		}
+		return w;
+	}
 
 };
 
@@ -131,23 +224,36 @@ using Bitmap1dVector = std::vector < Bitmap1d >;
 class Bitmap2d final
 {
 public:
-	Bitmap2d() = default;
+	Bitmap2d() :
+		sizex(0),
+		sizey(0)
+	{}
 
 	explicit Bitmap2d(const Bitmap1dVector& bmps) :
-		bmps(bmps)
-	{}
+		sizex(bmps.empty() ? 0 : bmps.front().getSize()),
+		sizey(bmps.size()),
+		bits(sizex * sizey)
+	{
+		for (size_t y = 0; y < sizey; ++y) {
+			for (size_t x = 0; x < sizex; ++x) {
+				set(x, y, bmps[y].get(x));
+			}
+		}
+	}
 
 	Bitmap2d(const size_t xSize, const size_t ySize) :
-		bmps(ySize, Bitmap1d(xSize))
+		sizex(xSize),
+		sizey(ySize),
+		bits(xSize * ySize)
 	{
 	}
 
 	Bitmap2d(const size_t xSize, const size_t ySize, const bool b) :
-		bmps(ySize, Bitmap1d(xSize))
+		sizex(xSize),
+		sizey(ySize),
+		bits(xSize * ySize)
 	{
-		for (auto& bm : bmps) {
-			bm.setAll(b);
-		}
+		bits.setAll(b);
 	}
 
 	~Bitmap2d() = default;
@@ -161,63 +267,76 @@ public:
 	}
 
 
-	size_t getSizeX() const { return bmps.front().getSize(); }
+	size_t getSizeX() const { return sizex; }
 
-	size_t getSizeY() const { return bmps.size(); }
+	size_t getSizeY() const { return sizey; }
 
 	size_t getSize() const { return getSizeX() * getSizeY(); }
 
 	void setAll() {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].setAll();
-		}
+		bits.setAll();
 	}
 
-	bool get(const size_t x, const size_t y) const { return bmps[y][x]; }
+	bool get(const size_t x, const size_t y) const { return bits.get(x + sizex * y); }
 
-	bool isAll() const { return getCount() == getSize(); }
+	bool isAll() const { return bits.isAll(); }
 
 	bool isAny() const { return !isNone(); }
 
-	bool isNone() const { return getCount() == 0; }
+	bool isNone() const { return bits.isNone(); }
+
+	// rows share packed words, so a row is a copy; write it back with setRow().
+	Bitmap1d getRow(const size_t y) const {
+		return bits.getSub(sizex * y, sizex * (y + 1));
+	}
 
-	Bitmap1d& get(const size_t y) {
-		return bmps[y];
+	void setRow(const size_t y, const Bitmap1d& row) {
+		assert(row.getSize() == sizex);
+		bits.set(static_cast<unsigned int>(sizex * y), row);
 	}
 
-	void set(const size_t x, const size_t y, const bool b = true) { bmps[y].set(x, b); }
+	void set(const size_t x, const size_t y, const bool b = true) { bits.set(x + sizex * y, b); }
 
 	Bitmap2d& and(const Bitmap2d& rhs) {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].and(rhs.bmps[i]);
+		if (sizex == rhs.sizex && sizey == rhs.sizey) {
+			bits.and(rhs.bits);
+		}
+		else {
+			combine(rhs, [](const bool l, const bool r) { return l && r; });
 		}
 		return (*this);
 	}
 
 	Bitmap2d& or(const Bitmap2d& rhs) {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].or(rhs.bmps[i]);
+		if (sizex == rhs.sizex && sizey == rhs.sizey) {
+			bits.or(rhs.bits);
+		}
+		else {
+			combine(rhs, [](const bool l, const bool r) { return l || r; });
 		}
 		return (*this);
 	}
 
 	Bitmap2d& xor(const Bitmap2d& rhs) {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].xor(rhs.bmps[i]);
+		if (sizex == rhs.sizex && sizey == rhs.sizey) {
+			bits.xor(rhs.bits);
+		}
+		else {
+			combine(rhs, [](const bool l, const bool r) { return l != r; });
 		}
 		return (*this);
 	}
 
-	Bitmap2d not() {
-		Bitmap1dVector bs;
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bs.push_back( bmps[i].not() );
-		}
-		return Bitmap2d(bs);
+	Bitmap2d& not() {
+		bits.not();
+		return (*this);
 	}
 
 	bool equals(const Bitmap2d& rhs) const {
-		return bmps == rhs.bmps;
+		return
+			sizex == rhs.sizex &&
+			sizey == rhs.sizey &&
+			bits == rhs.bits;
 	}
 
 	bool operator==(const Bitmap2d& rhs) const {
@@ -229,24 +348,22 @@ public:
 	}
 
 	int getCount() const {
-		int count = 0;
-		for (const auto& b : bmps) {
-			count += b.getCount();
-		}
-		return count;
+		return bits.getCount();
 	}
 
 	Bitmap2d getSub(const size_t startx, const size_t endx, const size_t starty, const size_t endy) const {
-		Bitmap1dVector bs( bmps.begin() + starty, bmps.begin() + endy );
-		for (auto& bm : bs) {
-			bm = bm.getSub(startx, endx);
+		Bitmap2d sub(endx - startx, endy - starty);
+		for (size_t y = 0; y < sub.getSizeY(); ++y) {
+			for (size_t x = 0; x < sub.getSizeX(); ++x) {
+				sub.set(x, y, get(x + startx, y + starty));
+			}
 		}
-		return Bitmap2d(bs);
+		return sub;
 	}
 
 	Bitmap2d& set(const std::array<unsigned int, 2>& start, const Bitmap2d& rhs) {
-		for (size_t x = 0; x < rhs.getSizeX(); ++x) {
-			for (size_t y = 0; y < rhs.getSizeY(); ++y) {
+		for (size_t y = 0; y < rhs.getSizeY(); ++y) {
+			for (size_t x = 0; x < rhs.getSizeX(); ++x) {
 				const bool b = rhs.get(x, y);
 				set(x + start[0], y + start[1], b);
 			}
@@ -255,27 +372,58 @@ public:
 	}
 
 private:
-	Bitmap1dVector bmps;
+	// element-wise fallback for mismatched sizes. rhs bits outside its extent read as false.
+	template<typename Op>
+	void combine(const Bitmap2d& rhs, const Op& op) {
+		for (size_t y = 0; y < sizey; ++y) {
+			for (size_t x = 0; x < sizex; ++x) {
+				const bool r = (x < rhs.sizex && y < rhs.sizey) && rhs.get(x, y);
+				set(x, y, op(get(x, y), r));
+			}
+		}
+	}
+
+	size_t sizex;
+	size_t sizey;
+	Bitmap1d bits;
 };
 
 using Bitmap2dVector = std::vector < Bitmap2d > ;
 
+// a single x-fastest bit buffer: bit index = x + sizex * (y + sizey * z).
 class Bitmap3d final
 {
 public:
 	explicit Bitmap3d(const Bitmap2dVector& bmps) :
-	bmps(bmps)
+		sizex(bmps.empty() ? 0 : static_cast<unsigned int>(bmps.front().getSizeX())),
+		sizey(bmps.empty() ? 0 : static_cast<unsigned int>(bmps.front().getSizeY())),
+		sizez(static_cast<unsigned int>(bmps.size())),
+		bits(getSize())
 	{
+		for (size_t z = 0; z < sizez; ++z) {
+			for (size_t y = 0; y < sizey; ++y) {
+				for (size_t x = 0; x < sizex; ++x) {
+					set(x, y, z, bmps[z].get(x, y));
+				}
+			}
+		}
 	}
 
 	Bitmap3d(const unsigned int x, const unsigned int y, const unsigned int z):
-		bmps( z, Bitmap2d(x,y) )
+		sizex(x),
+		sizey(y),
+		sizez(z),
+		bits(getSize())
 	{
 	}
 
 	Bitmap3d(const size_t xSize, const size_t ySize, const size_t zSize, const bool b) :
-		bmps(zSize, Bitmap2d(xSize, ySize, b))
+		sizex(static_cast<unsigned int>(xSize)),
+		sizey(static_cast<unsigned int>(ySize)),
+		sizez(static_cast<unsigned int>(zSize)),
+		bits(getSize())
 	{
+		bits.setAll(b);
 	}
 
 	~Bitmap3d() = default;
@@ -289,15 +437,15 @@ public:
 	}
 
 	unsigned int getSizeX() const {
-		return bmps.front().getSizeX();
+		return sizex;
 	}
 
 	unsigned int getSizeY() const {
-		return bmps.front().getSizeY();
+		return sizey;
 	}
 
 	unsigned int getSizeZ() const {
-		return bmps.size();
+		return sizez;
 	}
 
 	unsigned int getSize() const {
@@ -308,57 +456,65 @@ public:
 		return { getSizeX(), getSizeY(), getSizeZ() };
 	}
 
-	bool isAll() const { return getCount() == getSize(); }
+	bool isAll() const { return bits.isAll(); }
 
 	bool isAny() const { return !isNone(); }
 
-	bool isNone() const { return getCount() == 0; }
+	bool isNone() const { return bits.isNone(); }
 
 
-	Bitmap3d& setAll() {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].setAll();
-		}
+	Bitmap3d& setAll(const bool b = true) {
+		bits.setAll(b);
 		return (*this);
 	}
 
-	bool get(const size_t x, const size_t y, const size_t z) const { return bmps[z].get(x,y); }
+	size_t getIndex(const size_t x, const size_t y, const size_t z) const { return x + sizex * (y + sizey * static_cast<size_t>(z)); }
 
-	void set(const size_t x, const size_t y, const size_t z, const bool b = true) { bmps[z].set(x, y, b); }
+	bool get(const size_t x, const size_t y, const size_t z) const { return bits.get(getIndex(x, y, z)); }
 
-	//Bitmap2d& operator[](const size_t i) { return bmps[i]; }
+	void set(const size_t x, const size_t y, const size_t z, const bool b = true) { bits.set(getIndex(x, y, z), b); }
+
+	const Bitmap1d& getBits() const { return bits; }
 
 	Bitmap3d& and(const Bitmap3d& rhs) {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].and(rhs.bmps[i]);
+		if (getSizes() == rhs.getSizes()) {
+			bits.and(rhs.bits);
+		}
+		else {
+			combine(rhs, [](const bool l, const bool r) { return l && r; });
 		}
 		return (*this);
 	}
 
 	Bitmap3d& or(const Bitmap3d& rhs) {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].or(rhs.bmps[i]);
+		if (getSizes() == rhs.getSizes()) {
+			bits.or(rhs.bits);
+		}
+		else {
+			combine(rhs, [](const bool l, const bool r) { return l || r; });
 		}
 		return (*this);
 	}
 
 	Bitmap3d& xor(const Bitmap3d& rhs) {
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bmps[i].xor(rhs.bmps[i]);
+		if (getSizes() == rhs.getSizes()) {
+			bits.xor(rhs.bits);
+		}
+		else {
+			combine(rhs, [](const bool l, const bool r) { return l != r; });
 		}
 		return (*this);
 	}
 
-	Bitmap3d not() {
-		Bitmap2dVector bs;
-		for (size_t i = 0; i < bmps.size(); ++i) {
-			bs.push_back(bmps[i].not());
-		}
-		return Bitmap3d(bs);
+	Bitmap3d& not() {
+		bits.not();
+		return (*this);
 	}
 
 	bool equals(const Bitmap3d& rhs) const {
-		return bmps == rhs.bmps;
+		return
+			getSizes() == rhs.getSizes() &&
+			bits == rhs.bits;
 	}
 
 	bool operator==(const Bitmap3d& rhs) const {
@@ -370,41 +526,42 @@ public:
 	}
 
 	int getCount() const {
-		int count = 0;
-		for (const auto& b : bmps) {
-			count += b.getCount();
-		}
-		return count;
+		return bits.getCount();
 	}
 
 
-	//void set(const size_t i, const size_t j) { bmp2ds[i].set(j,k); }
-
 	std::bitset<8> to8Bit(const size_t i, const size_t j, const size_t k) const {
-		std::bitset<8> b;
-		if(get(  i,  j,  k))	{ b.set(0); }
-		if(get(i+1,  j,  k))	{ b.set(1); }
-		if(get(i+1,j+1,  k))	{ b.set(2); }
-		if(get(  i,j+1,  k))	{ b.set(3); }
-		if(get(  i,  j,k+1))	{ b.set(4); }
-		if(get(i+1,  j,k+1))	{ b.set(5); }
-		if(get(i+1,j+1,k+1))	{ b.set(6); }
-		if(get(  i,j+1,k+1))	{ b.set(7); }
-		return b;
+		const size_t i0 = getIndex(i, j, k);
+		const size_t dy = sizex;
+		const size_t dz = static_cast<size_t>(sizex) * sizey;
+		const unsigned long code =
+			(bits.get(i0)                ? 0x01 : 0) |
+			(bits.get(i0 + 1)            ? 0x02 : 0) |
+			(bits.get(i0 + 1 + dy)       ? 0x04 : 0) |
+			(bits.get(i0 + dy)           ? 0x08 : 0) |
+			(bits.get(i0 + dz)           ? 0x10 : 0) |
+			(bits.get(i0 + 1 + dz)       ? 0x20 : 0) |
+			(bits.get(i0 + 1 + dy + dz)  ? 0x40 : 0) |
+			(bits.get(i0 + dy + dz)      ? 0x80 : 0);
+		return std::bitset<8>(code);
 	}
 
 	Bitmap3d getSub(const std::array<unsigned int, 3>& start, const std::array<unsigned int, 3>& end) const {
-		Bitmap2dVector bs(bmps.begin() + start[2], bmps.begin() + end[2]);
-		for (auto& bm : bs) {
-			bm = bm.getSub(start[0], end[0], start[1], end[1]);
+		Bitmap3d sub(end[0] - start[0], end[1] - start[1], end[2] - start[2]);
+		for (size_t z = 0; z < sub.getSizeZ(); ++z) {
+			for (size_t y = 0; y < sub.getSizeY(); ++y) {
+				for (size_t x = 0; x < sub.getSizeX(); ++x) {
+					sub.set(x, y, z, get(x + start[0], y + start[1], z + start[2]));
+				}
+			}
 		}
-		return Bitmap3d(bs);
+		return sub;
 	}
 
 	void set(const std::array<unsigned int, 3>& start, const Bitmap3d& rhs) {
-		for (size_t x = 0; x < rhs.getSizeX(); ++x) {
+		for (size_t z = 0; z < rhs.getSizeZ(); ++z) {
 			for (size_t y = 0; y < rhs.getSizeY(); ++y) {
-				for (size_t z = 0; z < rhs.getSizeZ(); ++z) {
+				for (size_t x = 0; x < rhs.getSizeX(); ++x) {
 					const bool b = rhs.get(x, y, z);
 					set(x + start[0], y + start[1], z + start[2], b);
 				}
@@ -413,9 +570,25 @@ public:
 	}
 
 private:
-	Bitmap2dVector bmps;
+	// element-wise fallback for mismatched sizes. rhs bits outside its extent read as false.
+	template<typename Op>
+	void combine(const Bitmap3d& rhs, const Op& op) {
+		for (size_t z = 0; z < sizez; ++z) {
+			for (size_t y = 0; y < sizey; ++y) {
+				for (size_t x = 0; x < sizex; ++x) {
+					const bool r = (x < rhs.sizex && y < rhs.sizey && z < rhs.sizez) && rhs.get(x, y, z);
+					set(x, y, z, op(get(x, y, z), r));
+				}
+			}
+		}
+	}
+
+	unsigned int sizex;
+	unsigned int sizey;
+	unsigned int sizez;
+	Bitmap1d bits;
 };
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -93,6 +93,17 @@ TEST(Bitmap1dTest, TestNot)
 	EXPECT_EQ(Bitmap1d({ 0, 0 }), Bitmap1d({ 1, 1 }).not() );
 }
 
+TEST(Bitmap1dTest, TestNotLarge)
+{
+	Bitmap1d bmp(130);
+	bmp.set(0);
+	bmp.set(129);
+	EXPECT_EQ(2, bmp.getCount());
+	EXPECT_EQ(128, bmp.not().getCount());
+	EXPECT_FALSE(bmp.isAll());
+	EXPECT_TRUE(Bitmap1d::TRUE(130).isAll());
+}
+
 TEST(Bitmap1dTest, TestGetSub)
 {
 	EXPECT_EQ(Bitmap1d({ 1, 1 }), Bitmap1d({ 1, 1, 1 }).getSub(0,2) );
@@ -100,6 +111,20 @@ TEST(Bitmap1dTest, TestGetSub)
 	//EXPECT_EQ(Bitmap1d(std::vector<bool>{ 1 }), Bitmap1d({ 1, 1, 1 }).getSub(2));
 }
 
+TEST(Bitmap1dTest, TestGetSubAcrossWords)
+{
+	Bitmap1d bmp(200);
+	bmp.set(63);
+	bmp.set(64);
+	bmp.set(150);
+	const Bitmap1d sub = bmp.getSub(60, 160);
+	EXPECT_EQ(100, sub.getSize());
+	EXPECT_EQ(3, sub.getCount());
+	EXPECT_TRUE(sub[3]);
+	EXPECT_TRUE(sub[4]);
+	EXPECT_TRUE(sub[90]);
+}
+
 TEST(Bitmap1dTest, TestSetBitmap)
 {
 	Bitmap1d actual({ 1, 1, 1 });
@@ -175,9 +200,20 @@ TEST(Bitmap2dTest, TestGetSub)
 	EXPECT_EQ( Bitmap2d(1,1), Bitmap2d(2, 2).getSub(0, 1, 0, 1) );
 }
 
-TEST(Bitmap2dTest, TestGet)
+TEST(Bitmap2dTest, TestGetRow)
 {
-	EXPECT_EQ(Bitmap1d(2), Bitmap2d(2, 2, false).get(1));
+	EXPECT_EQ(Bitmap1d(2), Bitmap2d(2, 2, false).getRow(1));
+}
+
+TEST(Bitmap2dTest, TestSetRow)
+{
+	Bitmap2d bmp(3, 2, false);
+	Bitmap1d row = bmp.getRow(1);
+	row.set(2);
+	EXPECT_FALSE(bmp.get(2, 1));
+	bmp.setRow(1, row);
+	EXPECT_TRUE(bmp.get(2, 1));
+	EXPECT_FALSE(bmp.get(2, 0));
 }
 
 TEST(Bitmap2dTest, TestSetBitmap)
@@ -412,6 +448,15 @@ TEST(Bitmap3dTest, TestTo8Bit)
 	EXPECT_EQ( std::bitset<8>("11111111"), Bitmap3d::TRUE(2,2,2).to8Bit(0,0,0) );
 }
 
+TEST(Bitmap3dTest, TestTo8BitCorner)
+{
+	Bitmap3d bmp(3, 3, 3);
+	bmp.set(2, 2, 2);
+	EXPECT_EQ(std::bitset<8>("01000000"), bmp.to8Bit(1, 1, 1));
+	bmp.set(1, 1, 1);
+	EXPECT_EQ(std::bitset<8>("01000001"), bmp.to8Bit(1, 1, 1));
+}
+
 TEST(Bitmap3dTest, TestGetSub)
 {
 	EXPECT_EQ(Bitmap3d(1, 1, 1), Bitmap3d(3, 3, 3).getSub({ 0, 0, 0 }, { 1, 1, 1 }));
@@ -433,4 +478,4 @@ TEST(Bitmap3dTest, TestSetSphere)
 {
 	const auto c  = Bitmap3d(3, 3, 3).setSphere().getCount();
 }
-*/
\ No newline at end of file
+*/
\ No newline at end of file
@@ -0,0 +1,140 @@
+#ifndef __CRYSTAL_MATH_CHUNKED_MARCHING_CUBE_H__
+#define __CRYSTAL_MATH_CHUNKED_MARCHING_CUBE_H__
+
+#include "MarchingCube.h"
+#include "IndexedMesh.h"
+#include "Volume.h"
+#include "../Util/UnCopyable.h"
+#include "../Util/Parallel.h"
+
+#include <vector>
+
+namespace Crystal {
+	namespace Math {
+
+// Keeps one mesh per ChunkSize^3 block of cells and re-extracts only the chunks whose voxels were written since the
+// last update. Chunks do not share vertices with each other. Chunks line up with the volume's range pyramid blocks, so
+// with the pyramid enabled, chunks whose range excludes the isolevel are emptied without marching.
+template<typename GeomType, typename ValueType>
+class ChunkedMarchingCube final : UnCopyable
+{
+public:
+	static const unsigned int ChunkSize = Volume3d<GeomType, ValueType>::BlockSize;
+
+	explicit ChunkedMarchingCube(const ValueType isolevel) :
+		isolevel(isolevel),
+		chunkCounts({ 0, 0, 0 }),
+		updatedCount(0)
+	{}
+
+	~ChunkedMarchingCube() = default;
+
+	// re-meshes the dirty chunks and clears the volume's dirty blocks.
+	void update(Volume3d<GeomType, ValueType>& volume) {
+		const auto& res = volume.getResolutions();
+		const Index3d counts = {
+			toChunkCount(res[0]),
+			toChunkCount(res[1]),
+			toChunkCount(res[2])
+		};
+		if (counts != chunkCounts) {
+			chunkCounts = counts;
+			chunks.assign(counts[0] * counts[1] * counts[2], IndexedMesh<GeomType>());
+			volume.markAllDirty();
+		}
+
+		const auto& dirtyChunks = getDirtyChunks(volume.getDirtyBlocks());
+		updatedCount = dirtyChunks.size();
+		Util::parallelFor(dirtyChunks.size(), [&](const size_t i) {
+			const auto& c = dirtyChunks[i];
+			if (!volume.mayHaveBoundary(c[0], c[1], c[2], isolevel)) {
+				chunks[getChunkIndex(c)].clear();
+				return;
+			}
+			const Index3d start = { c[0] * ChunkSize, c[1] * ChunkSize, c[2] * ChunkSize };
+			const Index3d end = {
+				std::min<unsigned int>(start[0] + ChunkSize, res[0] - 1),
+				std::min<unsigned int>(start[1] + ChunkSize, res[1] - 1),
+				std::min<unsigned int>(start[2] + ChunkSize, res[2] - 1)
+			};
+			chunks[getChunkIndex(c)] = mc.marchIndexed(volume, isolevel, start, end);
+		});
+		volume.clearDirty();
+	}
+
+	IndexedMesh<GeomType> getMesh() const {
+		IndexedMesh<GeomType> mesh;
+		for (const auto& c : chunks) {
+			mesh.add(c);
+		}
+		return mesh;
+	}
+
+	const IndexedMesh<GeomType>& getChunk(const Index3d& c) const { return chunks[getChunkIndex(c)]; }
+
+	Index3d getChunkCounts() const { return chunkCounts; }
+
+	// number of chunks re-extracted by the last update.
+	size_t getUpdatedCount() const { return updatedCount; }
+
+private:
+	MarchingCube<GeomType, ValueType> mc;
+	ValueType isolevel;
+	Index3d chunkCounts;
+	std::vector< IndexedMesh<GeomType> > chunks;
+	size_t updatedCount;
+
+	// cells span two grid points, so a voxel change reaches back one cell.
+	static unsigned int toChunkCount(const unsigned int resolution) {
+		return (resolution < 2) ? 0 : (resolution - 1 + ChunkSize - 1) / ChunkSize;
+	}
+
+	size_t getChunkIndex(const Index3d& c) const {
+		return c[0] + chunkCounts[0] * (c[1] + static_cast<size_t>(chunkCounts[1]) * c[2]);
+	}
+
+	// a dirty voxel block dirties the chunk at the same index and the chunks just below it.
+	std::vector< Index3d > getDirtyChunks(const Bitmap3d& dirtyBlocks) const {
+		Bitmap3d dirty(chunkCounts[0], chunkCounts[1], chunkCounts[2]);
+		for (unsigned int z = 0; z < dirtyBlocks.getSizeZ(); ++z) {
+			for (unsigned int y = 0; y < dirtyBlocks.getSizeY(); ++y) {
+				for (unsigned int x = 0; x < dirtyBlocks.getSizeX(); ++x) {
+					if (!dirtyBlocks.get(x, y, z)) {
+						continue;
+					}
+					for (unsigned int i = 0; i < 8; ++i) {
+						const unsigned int dx = i & 1;
+						const unsigned int dy = (i >> 1) & 1;
+						const unsigned int dz = (i >> 2) & 1;
+						if (x < dx || y < dy || z < dz) {
+							continue;
+						}
+						const unsigned int cx = x - dx;
+						const unsigned int cy = y - dy;
+						const unsigned int cz = z - dz;
+						if (cx < chunkCounts[0] && cy < chunkCounts[1] && cz < chunkCounts[2]) {
+							dirty.set(cx, cy, cz);
+						}
+					}
+				}
+			}
+		}
+
+		std::vector< Index3d > results;
+		for (unsigned int z = 0; z < chunkCounts[2]; ++z) {
+			for (unsigned int y = 0; y < chunkCounts[1]; ++y) {
+				for (unsigned int x = 0; x < chunkCounts[0]; ++x) {
+					if (dirty.get(x, y, z)) {
+						results.push_back({ x, y, z });
+					}
+				}
+			}
+		}
+		return results;
+	}
+};
+
+	}
+}
+
+#endif
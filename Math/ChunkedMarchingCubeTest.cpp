@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "../Math/ChunkedMarchingCube.h"
+
+using namespace Crystal::Math;
+
+using TestTypes = ::testing::Types <
+	std::tuple< float, float >,
+	std::tuple< float, unsigned char >
+>;
+
+template<class T>
+class ChunkedMarchingCubeTest : public testing::Test {
+};
+
+TYPED_TEST_CASE(ChunkedMarchingCubeTest, TestTypes);
+
+TYPED_TEST(ChunkedMarchingCubeTest, TestUpdate)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(10, 10, 10)), Grid3d<ValueType>(40, 40, 40));
+	const Vector3d<GeomType> center(5, 5, 5);
+	for (unsigned int x = 0; x < 40; ++x) {
+		for (unsigned int y = 0; y < 40; ++y) {
+			for (unsigned int z = 0; z < 40; ++z) {
+				if (volume.toCenterPosition(x, y, z).getDistance(center) < 3) {
+					volume.setValue(x, y, z, 2);
+				}
+			}
+		}
+	}
+
+	MarchingCube<GeomType, ValueType> mc;
+	ChunkedMarchingCube<GeomType, ValueType> chunked(1);
+	chunked.update(volume);
+	EXPECT_EQ(125, chunked.getUpdatedCount());
+	EXPECT_FALSE(volume.isDirty());
+	EXPECT_EQ(mc.marchIndexed(volume, 1).getTriangleCount(), chunked.getMesh().getTriangleCount());
+
+	volume.setValue(8, 8, 8, 2);
+	chunked.update(volume);
+	EXPECT_EQ(8, chunked.getUpdatedCount());
+	EXPECT_EQ(mc.marchIndexed(volume, 1).getTriangleCount(), chunked.getMesh().getTriangleCount());
+
+	chunked.update(volume);
+	EXPECT_EQ(0, chunked.getUpdatedCount());
+}
+
+TYPED_TEST(ChunkedMarchingCubeTest, TestUpdateWithRangePyramid)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(10, 10, 10)), Grid3d<ValueType>(40, 40, 40));
+	volume.enableRangePyramid();
+	const Vector3d<GeomType> center(5, 5, 5);
+	for (unsigned int x = 0; x < 40; ++x) {
+		for (unsigned int y = 0; y < 40; ++y) {
+			for (unsigned int z = 0; z < 40; ++z) {
+				if (volume.toCenterPosition(x, y, z).getDistance(center) < 3) {
+					volume.setValue(x, y, z, 2);
+				}
+			}
+		}
+	}
+
+	MarchingCube<GeomType, ValueType> mc;
+	ChunkedMarchingCube<GeomType, ValueType> chunked(1);
+	chunked.update(volume);
+	EXPECT_EQ(mc.marchIndexed(volume, 1).getTriangleCount(), chunked.getMesh().getTriangleCount());
+	EXPECT_TRUE(chunked.getChunk({ 0, 0, 0 }).isEmpty());
+}
@@ -3,7 +3,9 @@
 
 #include <vector>
 #include <array>
-#include <bitset>
+#include <algorithm>
+#include <cassert>
+#include <utility>
 
 namespace Crystal {
 	namespace Math{
@@ -120,66 +122,148 @@ template<typename T>
 class Grid3d final
 {
 public:
-	Grid3d() = default;
+	Grid3d() :
+		sizex(0),
+		sizey(0),
+		sizez(0)
+	{}
 
 	~Grid3d() = default;
 
 	Grid3d(const size_t sizex, const size_t sizey, const size_t sizez) :
-		grids( sizez, Grid2d<T>(sizex, sizey) )
+		sizex(sizex),
+		sizey(sizey),
+		sizez(sizez),
+		values(sizex * sizey * sizez)
 	{}
 
-	explicit Grid3d(const Grid2dVector<T>& grids) :
-		grids(grids)
+	Grid3d(const size_t sizex, const size_t sizey, const size_t sizez, const T v) :
+		sizex(sizex),
+		sizey(sizey),
+		sizez(sizez),
+		values(sizex * sizey * sizez, v)
 	{}
 
-	T get(const size_t x, const size_t y, const size_t z) const { return grids[z].get(x,y); }
+	Grid3d(const Grid3d& rhs) = default;
+
+	Grid3d(Grid3d&& rhs) :
+		sizex(rhs.sizex),
+		sizey(rhs.sizey),
+		sizez(rhs.sizez),
+		values(std::move(rhs.values))
+	{
+		rhs.sizex = rhs.sizey = rhs.sizez = 0;
+	}
+
+	Grid3d& operator=(const Grid3d& rhs) = default;
+
+	Grid3d& operator=(Grid3d&& rhs) {
+		if (this == &rhs) {
+			return (*this);
+		}
+		sizex = rhs.sizex;
+		sizey = rhs.sizey;
+		sizez = rhs.sizez;
+		values = std::move(rhs.values);
+		rhs.sizex = rhs.sizey = rhs.sizez = 0;
+		return (*this);
+	}
+
+	explicit Grid3d(const Grid2dVector<T>& grids) :
+		sizex(grids.empty() ? 0 : grids.front().getSizeX()),
+		sizey(grids.empty() ? 0 : grids.front().getSizeY()),
+		sizez(grids.size())
+	{
+		values.reserve(sizex * sizey * sizez);
+		for (const auto& g : grids) {
+			for (size_t y = 0; y < sizey; ++y) {
+				for (size_t x = 0; x < sizex; ++x) {
+					values.push_back(g.get(x, y));
+				}
+			}
+		}
+	}
 
-	void set(const size_t x, const size_t y, const size_t z, const T v) { grids[z].set(x, y, v); }
+	T get(const size_t x, const size_t y, const size_t z) const { return values[getIndex(x, y, z)]; }
 
-	size_t getSizeX() const { return grids.front().getSizeX(); }
+	void set(const size_t x, const size_t y, const size_t z, const T v) { values[getIndex(x, y, z)] = v; }
 
-	size_t getSizeY() const { return grids.front().getSizeY(); }
+	void setAll(const T v) { std::fill(values.begin(), values.end(), v); }
 
-	size_t getSizeZ() const { return grids.size(); }
+	size_t getSizeX() const { return sizex; }
+
+	size_t getSizeY() const { return sizey; }
+
+	size_t getSizeZ() const { return sizez; }
+
+	size_t getSize() const { return values.size(); }
 
 	std::array<unsigned int,3> getSizes() const {
-		return { getSizeX(), getSizeY(), getSizeZ() };
+		return { static_cast<unsigned int>(sizex), static_cast<unsigned int>(sizey), static_cast<unsigned int>(sizez) };
 	}
 
+	// values are stored x-fastest: index = x + sizex * (y + sizey * z).
+	size_t getIndex(const size_t x, const size_t y, const size_t z) const { return x + sizex * (y + sizey * z); }
+
+	size_t getStrideY() const { return sizex; }
+
+	size_t getStrideZ() const { return sizex * sizey; }
+
+	T* data() { return values.data(); }
+
+	const T* data() const { return values.data(); }
+
+	// a row holds getSizeX() values.
+	T* getRow(const size_t y, const size_t z) { return values.data() + getIndex(0, y, z); }
+
+	const T* getRow(const size_t y, const size_t z) const { return values.data() + getIndex(0, y, z); }
+
+	// a slice holds getSizeX() * getSizeY() values.
+	T* getSlice(const size_t z) { return values.data() + getIndex(0, 0, z); }
+
+	const T* getSlice(const size_t z) const { return values.data() + getIndex(0, 0, z); }
+
 	Grid3d getSub(const std::array<unsigned int, 3>& start, const std::array<unsigned int, 3>& end) const {
-		Grid2dVector<T> gs(grids.begin() + start[2], grids.begin() + end[2]);
-		for (auto& g : gs) {
-			g = g.getSub(start[0], end[0], start[1], end[1]);
+		Grid3d sub(end[0] - start[0], end[1] - start[1], end[2] - start[2]);
+		for (size_t z = 0; z < sub.getSizeZ(); ++z) {
+			for (size_t y = 0; y < sub.getSizeY(); ++y) {
+				const T* src = getRow(y + start[1], z + start[2]) + start[0];
+				std::copy(src, src + sub.getSizeX(), sub.getRow(y, z));
+			}
 		}
-		return Grid3d(gs);
+		return sub;
 	}
 
 	void add(const size_t x, const size_t y, const size_t z, const T v) {
-		const auto vv = this->get(x, y, z) + v;
-		this->set(x, y, z, vv);
+		values[getIndex(x, y, z)] += v;
 	}
 
 	Grid3d& sub(const size_t x, const size_t y, const size_t z, const T v) {
-		return add( x, y, z, -v );
+		add( x, y, z, -v );
+		return (*this);
 	}
 
 	void add(const Grid3d& rhs) {
-		for (size_t x = 0; x < getSizeX(); ++x) {
-			for (size_t y = 0; y < getSizeY(); ++y) {
-				for (size_t z = 0; z < getSizeZ(); ++z) {
-					const auto v = rhs.get(x, y, z);
-					add(x, y, z, v);
+		assert(rhs.getSizeX() >= sizex && rhs.getSizeY() >= sizey && rhs.getSizeZ() >= sizez);
+		for (size_t z = 0; z < sizez; ++z) {
+			for (size_t y = 0; y < sizey; ++y) {
+				T* dest = getRow(y, z);
+				const T* src = rhs.getRow(y, z);
+				for (size_t x = 0; x < sizex; ++x) {
+					dest[x] += src[x];
 				}
 			}
 		}
 	}
 
 	Grid3d& sub(const Grid3d& rhs) {
-		for (size_t x = 0; x < getSizeX(); ++x) {
-			for (size_t y = 0; y < getSizeY(); ++y) {
-				for (size_t z = 0; z < getSizeZ(); ++z) {
-					const auto v = rhs.get(x, y, z);
-					sub(x, y, z, v);
+		assert(rhs.getSizeX() >= sizex && rhs.getSizeY() >= sizey && rhs.getSizeZ() >= sizez);
+		for (size_t z = 0; z < sizez; ++z) {
+			for (size_t y = 0; y < sizey; ++y) {
+				T* dest = getRow(y, z);
+				const T* src = rhs.getRow(y, z);
+				for (size_t x = 0; x < sizex; ++x) {
+					dest[x] -= src[x];
 				}
 			}
 		}
@@ -187,56 +271,49 @@ public:
 	}
 
 	void set(const std::array<unsigned int, 3>& start, const Grid3d& rhs) {
-		for (size_t x = 0; x < rhs.getSizeX(); ++x) {
+		for (size_t z = 0; z < rhs.getSizeZ(); ++z) {
 			for (size_t y = 0; y < rhs.getSizeY(); ++y) {
-				for (size_t z = 0; z < rhs.getSizeZ(); ++z) {
-					const T v = rhs.get(x, y, z);
-					set(x + start[0], y + start[1], z + start[2], v);
-				}
+				const T* src = rhs.getRow(y, z);
+				std::copy(src, src + rhs.getSizeX(), getRow(y + start[1], z + start[2]) + start[0]);
 			}
 		}
 	}
 
 
 	std::array< T, 8 > toArray8(const size_t i, const size_t j, const size_t k) const {
+		const size_t i0 = getIndex(i, j, k);
+		const size_t dy = getStrideY();
+		const size_t dz = getStrideZ();
 		return std::array < T, 8 > {
-				get(i, j, k),
-				get(i+1, j, k),
-				get(i+1, j+1, k),
-				get(i, j+1, k),
-				get(i, j, k+1),
-				get(i+ 1, j, k+1),
-				get(i+ 1, j+1, k+1),
-				get(i, j+1, k+1)
+				values[i0],
+				values[i0 + 1],
+				values[i0 + 1 + dy],
+				values[i0 + dy],
+				values[i0 + dz],
+				values[i0 + 1 + dz],
+				values[i0 + 1 + dy + dz],
+				values[i0 + dy + dz]
 		};
 	}
 
 	bool isAllLower(const size_t i, const size_t j, const size_t k, const T t) const {
 		assert(i < getSizeX() && j < getSizeY() && k < getSizeZ());
-		std::bitset<8> bs;
-		bs.set(0, isLower(i, j, k, t));
-		bs.set(1, isLower(i + 1, j, k, t));
-		bs.set(2, isLower(i + 1, j + 1, k, t));
-		bs.set(3, isLower(i, j + 1, k, t));
-		bs.set(4, isLower(i, j, k + 1, t));
-		bs.set(5, isLower(i + 1, j, k + 1, t));
-		bs.set(6, isLower(i + 1, j + 1, k + 1, t));
-		bs.set(7, isLower(i, j + 1, k + 1, t));
-		return (bs.all());
+		for (const auto v : toArray8(i, j, k)) {
+			if (!(v < t)) {
+				return false;
+			}
+		}
+		return true;
 	}
 
 	bool isAllHigher(const size_t i, const size_t j, const size_t k, const T t) const {
 		assert(i < getSizeX() && j < getSizeY() && k < getSizeZ());
-		std::bitset<8> bs;
-		bs.set(0, isHigher(i, j, k, t));
-		bs.set(1, isHigher(i + 1, j, k, t));
-		bs.set(2, isHigher(i + 1, j + 1, k, t));
-		bs.set(3, isHigher(i, j + 1, k, t));
-		bs.set(4, isHigher(i, j, k + 1, t));
-		bs.set(5, isHigher(i + 1, j, k + 1, t));
-		bs.set(6, isHigher(i + 1, j + 1, k + 1, t));
-		bs.set(7, isHigher(i, j + 1, k + 1, t));
-		return (bs.all());
+		for (const auto v : toArray8(i, j, k)) {
+			if (v < t) {
+				return false;
+			}
+		}
+		return true;
 	}
 
 	bool isNotBoundary(const size_t i, const size_t j, const size_t k, const T threshold) const {
@@ -249,17 +326,26 @@ public:
 
 	bool isHigher(const size_t i, const size_t j, const size_t k, const T threshold) const { return !isLower(i, j, k, threshold); }
 
-	bool equals(const Grid3d& rhs) const { return grids == rhs.grids; }
+	bool equals(const Grid3d& rhs) const {
+		return
+			sizex == rhs.sizex &&
+			sizey == rhs.sizey &&
+			sizez == rhs.sizez &&
+			values == rhs.values;
+	}
 
 	bool operator==(const Grid3d& rhs) const { return equals(rhs); }
 
 	bool operator!=(const Grid3d& rhs) const { return !equals(rhs); }
 
 private:
-	Grid2dVector<T> grids;
+	size_t sizex;
+	size_t sizey;
+	size_t sizez;
+	std::vector< T > values;
 };
 
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
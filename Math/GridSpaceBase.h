@@ -76,6 +76,23 @@ public:
 		return clamp({ ix, iy, iz });
 	}
 
+	// the voxel holding p; false when p lies outside the space.
+	bool toVoxel(const Vector3d<T>& p, Index3d& index) const {
+		const auto unitLength = getUnitLengths();
+		const T u[] = {
+			(p.getX() - space.getStart().getX()) / unitLength.getX(),
+			(p.getY() - space.getStart().getY()) / unitLength.getY(),
+			(p.getZ() - space.getStart().getZ()) / unitLength.getZ()
+		};
+		for (int a = 0; a < 3; ++a) {
+			if (!(u[a] >= 0) || !(u[a] < sizes[a])) {
+				return false;
+			}
+			index[a] = std::min(static_cast<unsigned int>(u[a]), sizes[a] - 1);
+		}
+		return true;
+	}
+
 
 	Vector3d<T> toCenterPosition(const size_t x, const size_t y, const size_t z) const {
 		const auto unitLengths = getUnitLengths();
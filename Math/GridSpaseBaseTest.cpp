@@ -53,4 +53,17 @@ TEST(GridSpaceBaseTest, TestScale)
 	GridSpaceBase<T> original( Space3d<T>::Unit(), Index3d{ 1, 1, 1 });
 	original.scale(Vector3d<T>(2, 4, 8));
 	EXPECT_EQ( Vector3d<T>(2,4,8), original.getSpace().getLengths());
-}
\ No newline at end of file
+}
+
+TEST(GridSpaceBaseTest, TestToVoxel)
+{
+	using T = float;
+	GridSpaceBase<T> bs(Space3d<T>(Vector3d<T>(0, 0, 0), Vector3d<T>(10, 10, 10)), Index3d{ 2, 5, 10 });
+	Index3d i;
+	EXPECT_TRUE(bs.toVoxel(Vector3d<T>(6, 6, 6), i));
+	EXPECT_EQ(Index3d({ 1, 3, 6 }), i);
+	EXPECT_TRUE(bs.toVoxel(Vector3d<T>(0, 0, 0), i));
+	EXPECT_EQ(Index3d({ 0, 0, 0 }), i);
+	EXPECT_FALSE(bs.toVoxel(Vector3d<T>(10, 5, 5), i));
+	EXPECT_FALSE(bs.toVoxel(Vector3d<T>(-0.1f, 5, 5), i));
+}
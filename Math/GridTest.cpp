@@ -156,4 +156,48 @@ TEST(Grid3dTest, TestIsBoundary)
 	EXPECT_FALSE( grid.isBoundary(0, 0, 0, threshold) );
 	grid.set(0, 0, 0, 10);
 	EXPECT_TRUE(  grid.isBoundary(0, 0, 0, threshold) );
-}
\ No newline at end of file
+}
+
+TEST(Grid3dTest, TestGetIndex)
+{
+	using T = float;
+	const Grid3d<T> grid(2, 3, 4);
+	EXPECT_EQ(0, grid.getIndex(0, 0, 0));
+	EXPECT_EQ(1, grid.getIndex(1, 0, 0));
+	EXPECT_EQ(2, grid.getIndex(0, 1, 0));
+	EXPECT_EQ(6, grid.getIndex(0, 0, 1));
+	EXPECT_EQ(23, grid.getIndex(1, 2, 3));
+}
+
+TEST(Grid3dTest, TestData)
+{
+	using T = float;
+	Grid3d<T> grid(2, 3, 4);
+	grid.set(1, 2, 3, 10);
+	EXPECT_EQ(24, grid.getSize());
+	EXPECT_EQ(10, grid.data()[23]);
+	EXPECT_EQ(10, grid.getRow(2, 3)[1]);
+	EXPECT_EQ(10, grid.getSlice(3)[5]);
+}
+
+TEST(Grid3dTest, TestConstructFromGrid2d)
+{
+	using T = float;
+	Grid2d<T> slice(2, 2);
+	slice.set(1, 0, 5);
+	const Grid3d<T> grid(Grid2dVector<T>{ Grid2d<T>(2, 2), slice });
+	EXPECT_EQ(2, grid.getSizeZ());
+	EXPECT_EQ(5, grid.get(1, 0, 1));
+	EXPECT_EQ(0, grid.get(1, 0, 0));
+}
+
+TEST(Grid3dTest, TestSetGrid)
+{
+	using T = float;
+	Grid3d<T> grid(3, 3, 3);
+	grid.set({ 1, 1, 1 }, Grid3d<T>(2, 2, 2, 7));
+	EXPECT_EQ(0, grid.get(0, 1, 1));
+	EXPECT_EQ(7, grid.get(1, 1, 1));
+	EXPECT_EQ(7, grid.get(2, 2, 2));
+	EXPECT_EQ(Grid3d<T>(2, 2, 2, 7), grid.getSub({ 1, 1, 1 }, { 3, 3, 3 }));
+}
\ No newline at end of file
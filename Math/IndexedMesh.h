@@ -0,0 +1,152 @@
+#ifndef __CRYSTAL_MATH_INDEXED_MESH_H__
+#define __CRYSTAL_MATH_INDEXED_MESH_H__
+
+#include "Vector.h"
+#include "Triangle.h"
+
+#include <vector>
+#include <cassert>
+
+namespace Crystal {
+	namespace Math {
+
+// Vertex buffer + triangle index buffer. Vertices shared by neighbouring triangles are stored once.
+// Normals and texcoords are optional: either empty or one per vertex.
+template<typename T>
+class IndexedMesh final
+{
+public:
+	IndexedMesh() = default;
+
+	IndexedMesh(const Vector3dVector<T>& positions, const std::vector<unsigned int>& indices) :
+		positions(positions),
+		indices(indices)
+	{
+		assert(indices.size() % 3 == 0);
+	}
+
+	IndexedMesh(const Vector3dVector<T>& positions, const Vector3dVector<T>& normals, const Vector3dVector<T>& texCoords, const std::vector<unsigned int>& indices) :
+		positions(positions),
+		normals(normals),
+		texCoords(texCoords),
+		indices(indices)
+	{
+		assert(indices.size() % 3 == 0);
+		assert(normals.empty() || normals.size() == positions.size());
+		assert(texCoords.empty() || texCoords.size() == positions.size());
+	}
+
+	~IndexedMesh() = default;
+
+	// for meshes without normals and texcoords.
+	unsigned int addPosition(const Vector3d<T>& p) {
+		assert(normals.empty() && texCoords.empty());
+		positions.push_back(p);
+		return static_cast<unsigned int>(positions.size() - 1);
+	}
+
+	void addTriangle(const unsigned int i0, const unsigned int i1, const unsigned int i2) {
+		indices.push_back(i0);
+		indices.push_back(i1);
+		indices.push_back(i2);
+	}
+
+	// appends rhs, shifting its indices past the current vertices. normals and texcoords are kept only when both
+	// meshes have them.
+	void add(const IndexedMesh& rhs) {
+		const auto offset = static_cast<unsigned int>(positions.size());
+		append(normals, rhs.normals, rhs.positions.size());
+		append(texCoords, rhs.texCoords, rhs.positions.size());
+		positions.insert(positions.end(), rhs.positions.begin(), rhs.positions.end());
+		indices.reserve(indices.size() + rhs.indices.size());
+		for (const auto i : rhs.indices) {
+			indices.push_back(i + offset);
+		}
+	}
+
+	void clear() {
+		positions.clear();
+		normals.clear();
+		texCoords.clear();
+		indices.clear();
+	}
+
+	const Vector3dVector<T>& getPositions() const { return positions; }
+
+	Vector3dVector<T>& getPositions() { return positions; }
+
+	const std::vector<unsigned int>& getIndices() const { return indices; }
+
+	std::vector<unsigned int>& getIndices() { return indices; }
+
+	const Vector3dVector<T>& getNormals() const { return normals; }
+
+	const Vector3dVector<T>& getTexCoords() const { return texCoords; }
+
+	size_t getVertexCount() const { return positions.size(); }
+
+	size_t getTriangleCount() const { return indices.size() / 3; }
+
+	bool isEmpty() const { return indices.empty(); }
+
+	Triangle<T> getTriangle(const size_t i) const {
+		return Triangle<T>(positions[indices[i * 3]], positions[indices[i * 3 + 1]], positions[indices[i * 3 + 2]]);
+	}
+
+	TriangleVector<T> toTriangles() const {
+		TriangleVector<T> triangles;
+		triangles.reserve(getTriangleCount());
+		for (size_t i = 0; i < getTriangleCount(); ++i) {
+			triangles.push_back(getTriangle(i));
+		}
+		return triangles;
+	}
+
+	// values per vertex in toInterleaved(): position xyz, normal xyz, texcoord uv.
+	static unsigned int getStride() { return 8; }
+
+	// missing normals and texcoords are zero.
+	std::vector<T> toInterleaved() const {
+		std::vector<T> values;
+		values.reserve(positions.size() * getStride());
+		for (size_t i = 0; i < positions.size(); ++i) {
+			const auto& p = positions[i];
+			const auto& n = normals.empty() ? Vector3d<T>() : normals[i];
+			const auto& t = texCoords.empty() ? Vector3d<T>() : texCoords[i];
+			const T v[] = { p.getX(), p.getY(), p.getZ(), n.getX(), n.getY(), n.getZ(), t.getX(), t.getY() };
+			values.insert(values.end(), v, v + 8);
+		}
+		return values;
+	}
+
+	bool operator==(const IndexedMesh& rhs) const {
+		return
+			positions == rhs.positions &&
+			normals == rhs.normals &&
+			texCoords == rhs.texCoords &&
+			indices == rhs.indices;
+	}
+
+private:
+	Vector3dVector<T> positions;
+	Vector3dVector<T> normals;
+	Vector3dVector<T> texCoords;
+	std::vector<unsigned int> indices;
+
+	// values of this mesh stay only when both sides have them; an empty mesh takes rhs's.
+	void append(Vector3dVector<T>& values, const Vector3dVector<T>& rhs, const size_t rhsCount) const {
+		const bool has = values.size() == positions.size();
+		const bool rhsHas = rhs.size() == rhsCount;
+		if (has && rhsHas) {
+			values.insert(values.end(), rhs.begin(), rhs.end());
+		}
+		else {
+			values.clear();
+		}
+	}
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,77 @@
+#include "gtest/gtest.h"
+
+#include "../Math/IndexedMesh.h"
+
+using namespace Crystal::Math;
+
+template<class T>
+class IndexedMeshTest : public testing::Test {
+};
+
+typedef ::testing::Types<float, double> TestTypes;
+
+TYPED_TEST_CASE(IndexedMeshTest, TestTypes);
+
+TYPED_TEST(IndexedMeshTest, TestAddTriangle)
+{
+	using T = TypeParam;
+	IndexedMesh<T> mesh;
+	const auto i0 = mesh.addPosition(Vector3d<T>(0, 0, 0));
+	const auto i1 = mesh.addPosition(Vector3d<T>(1, 0, 0));
+	const auto i2 = mesh.addPosition(Vector3d<T>(0, 1, 0));
+	const auto i3 = mesh.addPosition(Vector3d<T>(1, 1, 0));
+	mesh.addTriangle(i0, i1, i2);
+	mesh.addTriangle(i2, i1, i3);
+	EXPECT_EQ(4, mesh.getVertexCount());
+	EXPECT_EQ(2, mesh.getTriangleCount());
+	EXPECT_EQ(Vector3d<T>(1, 0, 0), mesh.getTriangle(1).getv1());
+	EXPECT_EQ(2, mesh.toTriangles().size());
+}
+
+TYPED_TEST(IndexedMeshTest, TestAdd)
+{
+	using T = TypeParam;
+	IndexedMesh<T> lhs({ Vector3d<T>(0, 0, 0), Vector3d<T>(1, 0, 0), Vector3d<T>(0, 1, 0) }, { 0, 1, 2 });
+	const IndexedMesh<T> rhs(lhs);
+	lhs.add(rhs);
+	EXPECT_EQ(6, lhs.getVertexCount());
+	const std::vector<unsigned int> expected{ 0, 1, 2, 3, 4, 5 };
+	EXPECT_EQ(expected, lhs.getIndices());
+}
+
+TYPED_TEST(IndexedMeshTest, TestAddAttributes)
+{
+	using T = TypeParam;
+	const Vector3dVector<T> positions = { Vector3d<T>(0, 0, 0), Vector3d<T>(1, 0, 0), Vector3d<T>(0, 1, 0) };
+	const Vector3dVector<T> normals(3, Vector3d<T>(0, 0, 1));
+	IndexedMesh<T> lhs(positions, normals, {}, { 0, 1, 2 });
+	lhs.add(lhs);
+	EXPECT_EQ(6, lhs.getNormals().size());
+	EXPECT_TRUE(lhs.getTexCoords().empty());
+
+	// positions only on one side drops the normals.
+	lhs.add(IndexedMesh<T>(positions, { 0, 1, 2 }));
+	EXPECT_EQ(9, lhs.getVertexCount());
+	EXPECT_TRUE(lhs.getNormals().empty());
+}
+
+TYPED_TEST(IndexedMeshTest, TestToInterleaved)
+{
+	using T = TypeParam;
+	const Vector3dVector<T> positions = { Vector3d<T>(0, 0, 0), Vector3d<T>(1, 0, 0), Vector3d<T>(0, 1, 0) };
+	const Vector3dVector<T> normals(3, Vector3d<T>(0, 0, 1));
+	const Vector3dVector<T> texCoords = { Vector3d<T>(0, 0, 0), Vector3d<T>(1, 0, 0), Vector3d<T>(0, 1, 0) };
+	const IndexedMesh<T> mesh(positions, normals, texCoords, { 0, 1, 2 });
+	EXPECT_EQ(3, mesh.getVertexCount());
+	EXPECT_EQ(1, mesh.getTriangleCount());
+
+	const std::vector<T>& values = mesh.toInterleaved();
+	ASSERT_EQ(3 * IndexedMesh<T>::getStride(), values.size());
+	const std::vector<T> second(values.begin() + 8, values.begin() + 16);
+	const std::vector<T> expected = { 1, 0, 0, 0, 0, 1, 1, 0 };
+	EXPECT_EQ(expected, second);
+
+	// missing normals and texcoords are zero.
+	const std::vector<T>& plain = IndexedMesh<T>(positions, { 0, 1, 2 }).toInterleaved();
+	EXPECT_EQ(std::vector<T>({ 1, 0, 0, 0, 0, 0, 0, 0 }), std::vector<T>(plain.begin() + 8, plain.begin() + 16));
+}
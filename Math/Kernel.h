@@ -24,17 +24,17 @@ public:
 
 	~Gaussian() = default;
 
-	T get(const T x) {
+	T get(const T x) const {
 		const auto coe = T(1) / std::sqrt(T(2) * Tolerance<T>::getPI() * distribution * distribution);
 		const auto exp_ = -std::pow((x - average), 2) / (T(2) * distribution);
 		return coe * std::exp(exp_);
 	}
 
-	T get(const T x, const T y){
+	T get(const T x, const T y) const {
 		return get(x) + get(y);
 	}
 
-	T get(const T x, const T y, const T z) {
+	T get(const T x, const T y, const T z) const {
 		return get(x) + get(y) + get(z);
 	}
 
@@ -47,4 +47,4 @@ private:
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -6,9 +6,12 @@
 #include "Vector.h"
 #include "../Util/UnCopyable.h"
 #include "MarchingCubeTable.h"
+#include "IndexedMesh.h"
+#include "../Util/Parallel.h"
 #include <vector>
 #include <array>
 #include "Volume.h"
+#include "SparseVolume.h"
 
 namespace Crystal {
 	namespace Math {
@@ -17,103 +20,229 @@ template<typename GeomType, typename ValueType>
 class MarchingCube final : UnCopyable
 {
 public:
-	MarchingCube() {
-		table.buildEdgeTable();
-		table.buildTriangleTable();
-	}
+	MarchingCube() = default;
 
 	~MarchingCube() = default;
 
 	TriangleVector<GeomType> march(const Volume3d<GeomType, ValueType>& ss, const ValueType isolevel) const
 	{
 		TriangleVector<GeomType> triangles;
-		const auto& cells = ss.toBoundaryCells(isolevel);
-		for (const auto& c : cells) {
-			const auto& ts = build(c, isolevel);
-			triangles.insert(triangles.end(), ts.begin(), ts.end());
-		}
+		ss.forEachBoundaryCell(isolevel, [&](const VolumeCell3d<GeomType, ValueType>& c) {
+			build(c, isolevel, triangles);
+		});
 		return std::move(triangles);
 	}
 
-private:
-	MarchingCubeTable table;
-
-	TriangleVector<GeomType> build(const VolumeCell3d<GeomType, ValueType>& cell, const ValueType isolevel) const
+	TriangleVector<GeomType> march(const SparseVolume3d<GeomType, ValueType>& ss, const ValueType isolevel) const
 	{
 		TriangleVector<GeomType> triangles;
-		const int cubeindex = getCubeIndex(cell.getValues(), isolevel);
-		const auto& vertices = getPositions(cubeindex, cell, isolevel);
-		return std::move(build(cubeindex, vertices));
+		ss.forEachBoundaryCell(isolevel, [&](const VolumeCell3d<GeomType, ValueType>& c) {
+			build(c, isolevel, triangles);
+		});
+		return std::move(triangles);
 	}
 
-	TriangleVector<GeomType> build(const int cubeindex, const std::array<Vector3d<GeomType>, 12>& vertices) const {
-		TriangleVector<GeomType> triangles;
-		const auto& triTable = table.getTriangleTable();
-		for (int i = 0; triTable[cubeindex][i] != -1; i += 3) {
-			const auto& v1 = vertices[triTable[cubeindex][i]];
-			const auto& v2 = vertices[triTable[cubeindex][i + 1]];
-			const auto& v3 = vertices[triTable[cubeindex][i + 2]];
-			const Triangle<GeomType> t(v1, v2, v3);
-			triangles.emplace_back(t);
+	// Walks the grid directly in z slabs of SlabSize cell layers, one slab per task. Edge vertices are cached per
+	// plane so neighbouring cells share them, and slab seams are stitched while merging, so the output does not
+	// depend on the thread count.
+	IndexedMesh<GeomType> marchIndexed(const Volume3d<GeomType, ValueType>& volume, const ValueType isolevel) const
+	{
+		const auto& res = volume.getResolutions();
+		if (res[0] < 2 || res[1] < 2 || res[2] < 2) {
+			return IndexedMesh<GeomType>();
 		}
-		return std::move(triangles);
+		return marchIndexed(volume, isolevel, { 0, 0, 0 }, { res[0] - 1, res[1] - 1, res[2] - 1 });
 	}
 
-
-	int getCubeIndex(const std::array< ValueType, 8 >& val, const ValueType isolevel) const {
-		std::bitset<8> bit;
-		if (val[0] < isolevel) { bit.set(0); }
-		if (val[1] < isolevel) { bit.set(1); }
-		if (val[2] < isolevel) { bit.set(2); }
-		if (val[3] < isolevel) { bit.set(3); }
-		if (val[4] < isolevel) { bit.set(4); }
-		if (val[5] < isolevel) { bit.set(5); }
-		if (val[6] < isolevel) { bit.set(6); }
-		if (val[7] < isolevel) { bit.set(7); }
-		return static_cast<int>( bit.to_ulong() );
+	// cells in [start, end). cell (x, y, z) spans grid points x..x+1, y..y+1, z..z+1.
+	IndexedMesh<GeomType> marchIndexed(const Volume3d<GeomType, ValueType>& volume, const ValueType isolevel, const Index3d& start, const Index3d& end) const
+	{
+		const unsigned int layers = end[2] - start[2];
+		const unsigned int slabCount = (layers + SlabSize - 1) / SlabSize;
+		std::vector< Slab > slabs(slabCount);
+		Util::parallelFor(slabCount, [&](const size_t i) {
+			const unsigned int z0 = start[2] + static_cast<unsigned int>(i) * SlabSize;
+			const unsigned int z1 = std::min<unsigned int>(z0 + SlabSize, end[2]);
+			marchSlab(volume, isolevel, start, end, z0, z1, slabs[i]);
+		});
+		return merge(volume, isolevel, start, end, slabs);
 	}
 
+	static const unsigned int SlabSize = 8;
 
+private:
+	struct Slab
+	{
+		IndexedMesh<GeomType> mesh;
+		std::vector<int> bottom;
+	};
 
-	std::array< Vector3d<GeomType>, 12 > getPositions(const int cubeindex, const VolumeCell3d<GeomType,ValueType>& cell, const ValueType isolevel) const {
-		std::array< Vector3d<GeomType>, 12 > vertices;
-		const auto& pvs = cell.toPositionValues();
-		const auto& edgeTable = table.getEdgeTable();
-		if (edgeTable[cubeindex][0]) {
-			vertices[0] = pvs[0].getInterpolatedPosition(isolevel, pvs[1]); // interpolate(isolevel, p[0], p[1], val[0], val[1]);
-		}
-		if (edgeTable[cubeindex][1]) {
-			vertices[1] = pvs[1].getInterpolatedPosition(isolevel, pvs[2]);
-		}
-		if (edgeTable[cubeindex][2]) {
-			vertices[2] = pvs[2].getInterpolatedPosition(isolevel, pvs[3]);
-		}
-		if (edgeTable[cubeindex][3]) {
-			vertices[3] = pvs[3].getInterpolatedPosition(isolevel, pvs[0]);
-		}
-		if (edgeTable[cubeindex][4]) {
-			vertices[4] = pvs[4].getInterpolatedPosition(isolevel, pvs[5]);
+	// vertex references into the next slab's bottom plane are tagged until the merge.
+	static const unsigned int SeamFlag = 0x80000000u;
+
+	void marchSlab(const Volume3d<GeomType, ValueType>& volume, const ValueType isolevel, const Index3d& start, const Index3d& end, const unsigned int z0, const unsigned int z1, Slab& slab) const
+	{
+		// grid point offset (x, y, z) and axis of each cube edge.
+		static const unsigned int edgeOffsets[12][4] = {
+			{ 0, 0, 0, 0 }, { 1, 0, 0, 1 }, { 0, 1, 0, 0 }, { 0, 0, 0, 1 },
+			{ 0, 0, 1, 0 }, { 1, 0, 1, 1 }, { 0, 1, 1, 0 }, { 0, 0, 1, 1 },
+			{ 0, 0, 0, 2 }, { 1, 0, 0, 2 }, { 1, 1, 0, 2 }, { 0, 1, 0, 2 }
+		};
+
+		const size_t nx = end[0] - start[0] + 1;
+		const size_t ny = end[1] - start[1] + 1;
+		const size_t planeSize = nx * ny;
+		// x edges at [0, planeSize), y edges at [planeSize, 2 * planeSize) of each plane table.
+		std::vector<int> low(2 * planeSize, -1);
+		std::vector<int> high(2 * planeSize, -1);
+		std::vector<int> zEdges(planeSize, -1);
+		const bool hasSeam = z1 < end[2];
+
+		for (unsigned int z = z0; z < z1; ++z) {
+			std::fill(zEdges.begin(), zEdges.end(), -1);
+			for (unsigned int y = start[1]; y < end[1]; ++y) {
+				for (unsigned int x = start[0]; x < end[0]; ++x) {
+					const std::array< ValueType, 8 > values = {
+						volume.getValue(x, y, z),
+						volume.getValue(x + 1, y, z),
+						volume.getValue(x + 1, y + 1, z),
+						volume.getValue(x, y + 1, z),
+						volume.getValue(x, y, z + 1),
+						volume.getValue(x + 1, y, z + 1),
+						volume.getValue(x + 1, y + 1, z + 1),
+						volume.getValue(x, y + 1, z + 1)
+					};
+					const int cubeindex = getCubeIndex(values, isolevel);
+					const unsigned short edges = MarchingCubeTable::getEdgeFlags(cubeindex);
+					if (edges == 0) {
+						continue;
+					}
+
+					std::array< unsigned int, 12 > vertices;
+					for (int e = 0; e < 12; ++e) {
+						if ((edges & (1 << e)) == 0) {
+							continue;
+						}
+						const unsigned int gx = x + edgeOffsets[e][0];
+						const unsigned int gy = y + edgeOffsets[e][1];
+						const unsigned int axis = edgeOffsets[e][3];
+						const bool isHigh = edgeOffsets[e][2] == 1;
+						const size_t slot = (gy - start[1]) * nx + (gx - start[0]);
+						int& cached = (axis == 2) ? zEdges[slot] : (isHigh ? high : low)[axis * planeSize + slot];
+						if (cached == -1) {
+							if (axis != 2 && isHigh && hasSeam && z + 1 == z1) {
+								vertices[e] = SeamFlag | static_cast<unsigned int>(axis * planeSize + slot);
+								continue;
+							}
+							const auto& p = getEdgePosition(volume, isolevel, gx, gy, z + edgeOffsets[e][2], axis);
+							cached = static_cast<int>(slab.mesh.addPosition(p));
+						}
+						vertices[e] = static_cast<unsigned int>(cached);
+					}
+
+					const signed char* tris = MarchingCubeTable::getTriangles(cubeindex);
+					for (int i = 0; tris[i] != -1; i += 3) {
+						slab.mesh.addTriangle(vertices[tris[i]], vertices[tris[i + 1]], vertices[tris[i + 2]]);
+					}
+				}
+			}
+			if (z == z0) {
+				slab.bottom = low;
+			}
+			low.swap(high);
+			std::fill(high.begin(), high.end(), -1);
 		}
-		if (edgeTable[cubeindex][5]) {
-			vertices[5] = pvs[5].getInterpolatedPosition(isolevel, pvs[6]);
+	}
+
+	IndexedMesh<GeomType> merge(const Volume3d<GeomType, ValueType>& volume, const ValueType isolevel, const Index3d& start, const Index3d& end, std::vector< Slab >& slabs) const
+	{
+		std::vector< unsigned int > offsets(slabs.size(), 0);
+		size_t vertexCount = 0;
+		size_t indexCount = 0;
+		for (size_t i = 0; i < slabs.size(); ++i) {
+			offsets[i] = static_cast<unsigned int>(vertexCount);
+			vertexCount += slabs[i].mesh.getVertexCount();
+			indexCount += slabs[i].mesh.getIndices().size();
 		}
-		if (edgeTable[cubeindex][6]) {
-			vertices[6] = pvs[6].getInterpolatedPosition(isolevel, pvs[7]);
+
+		IndexedMesh<GeomType> mesh;
+		auto& positions = mesh.getPositions();
+		auto& indices = mesh.getIndices();
+		positions.reserve(vertexCount);
+		indices.reserve(indexCount);
+		for (const auto& slab : slabs) {
+			positions.insert(positions.end(), slab.mesh.getPositions().begin(), slab.mesh.getPositions().end());
 		}
-		if (edgeTable[cubeindex][7]) {
-			vertices[7] = pvs[7].getInterpolatedPosition(isolevel, pvs[4]);
+
+		const size_t nx = end[0] - start[0] + 1;
+		const size_t planeSize = nx * (end[1] - start[1] + 1);
+		for (size_t s = 0; s < slabs.size(); ++s) {
+			for (const auto i : slabs[s].mesh.getIndices()) {
+				if ((i & SeamFlag) == 0) {
+					indices.push_back(i + offsets[s]);
+					continue;
+				}
+				// the next slab owns this vertex. create it here if none of its cells used the edge.
+				const size_t slot = i & ~SeamFlag;
+				auto& bottom = slabs[s + 1].bottom;
+				if (bottom[slot] == -1) {
+					const unsigned int axis = static_cast<unsigned int>(slot / planeSize);
+					const unsigned int gx = start[0] + static_cast<unsigned int>((slot % planeSize) % nx);
+					const unsigned int gy = start[1] + static_cast<unsigned int>((slot % planeSize) / nx);
+					const unsigned int gz = start[2] + static_cast<unsigned int>(s + 1) * SlabSize;
+					const auto index = mesh.addPosition(getEdgePosition(volume, isolevel, gx, gy, gz, axis));
+					bottom[slot] = static_cast<int>(index - offsets[s + 1]);
+				}
+				indices.push_back(static_cast<unsigned int>(bottom[slot]) + offsets[s + 1]);
+			}
 		}
-		if (edgeTable[cubeindex][8]) {
-			vertices[8] = pvs[0].getInterpolatedPosition(isolevel, pvs[4]);
+		return mesh;
+	}
+
+	Vector3d<GeomType> getEdgePosition(const Volume3d<GeomType, ValueType>& volume, const ValueType isolevel, const unsigned int x, const unsigned int y, const unsigned int z, const unsigned int axis) const
+	{
+		const unsigned int x1 = (axis == 0) ? x + 1 : x;
+		const unsigned int y1 = (axis == 1) ? y + 1 : y;
+		const unsigned int z1 = (axis == 2) ? z + 1 : z;
+		const PositionValue<GeomType, ValueType> pv0(volume.toCenterPosition(x, y, z), volume.getValue(x, y, z));
+		const PositionValue<GeomType, ValueType> pv1(volume.toCenterPosition(x1, y1, z1), volume.getValue(x1, y1, z1));
+		return pv0.getInterpolatedPosition(isolevel, pv1);
+	}
+
+	// appends the triangles of one cell to the output. cells without a crossing return before any work.
+	void build(const VolumeCell3d<GeomType, ValueType>& cell, const ValueType isolevel, TriangleVector<GeomType>& triangles) const
+	{
+		const int cubeindex = getCubeIndex(cell.getValues(), isolevel);
+		if (MarchingCubeTable::getEdgeFlags(cubeindex) == 0) {
+			return;
 		}
-		if (edgeTable[cubeindex][9]) {
-			vertices[9] = pvs[1].getInterpolatedPosition(isolevel, pvs[5]);
+		const auto& vertices = getPositions(cubeindex, cell, isolevel);
+		const signed char* tris = MarchingCubeTable::getTriangles(cubeindex);
+		for (int i = 0; tris[i] != -1; i += 3) {
+			triangles.emplace_back(vertices[tris[i]], vertices[tris[i + 1]], vertices[tris[i + 2]]);
 		}
-		if (edgeTable[cubeindex][10]) {
-			vertices[10] = pvs[2].getInterpolatedPosition(isolevel, pvs[6]);
+	}
+
+
+	int getCubeIndex(const std::array< ValueType, 8 >& val, const ValueType isolevel) const {
+		int cubeindex = 0;
+		for (int i = 0; i < 8; ++i) {
+			cubeindex |= (val[i] < isolevel) ? (1 << i) : 0;
 		}
-		if (edgeTable[cubeindex][11]) {
-			vertices[11] = pvs[3].getInterpolatedPosition(isolevel, pvs[7]);
+		return cubeindex;
+	}
+
+
+
+	std::array< Vector3d<GeomType>, 12 > getPositions(const int cubeindex, const VolumeCell3d<GeomType,ValueType>& cell, const ValueType isolevel) const {
+		std::array< Vector3d<GeomType>, 12 > vertices;
+		const auto& pvs = cell.toPositionValues();
+		const unsigned short edges = MarchingCubeTable::getEdgeFlags(cubeindex);
+		for (int e = 0; e < 12; ++e) {
+			if (edges & (1 << e)) {
+				const unsigned char* corners = MarchingCubeTable::getEdgeCorners(e);
+				vertices[e] = pvs[corners[0]].getInterpolatedPosition(isolevel, pvs[corners[1]]);
+			}
 		}
 		return vertices;
 	}
@@ -122,4 +251,4 @@ private:
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -4,19 +4,37 @@
 
 using namespace Crystal::Math;
 
-TEST(MarchingCubeTableTest, TestBuildEdgeTable)
+TEST(MarchingCubeTableTest, TestGetEdgeFlags)
 {
-	MarchingCubeTable table;
-	table.buildEdgeTable();
-
-	EXPECT_EQ(256,table.getEdgeTable().size());
+	EXPECT_EQ(0x0, MarchingCubeTable::getEdgeFlags(0));
+	EXPECT_EQ(0x109, MarchingCubeTable::getEdgeFlags(1));
+	EXPECT_EQ(0x0, MarchingCubeTable::getEdgeFlags(255));
 }
 
-TEST(MarchingCubeTableTest, TestBuildTriangleTable)
+TEST(MarchingCubeTableTest, TestGetTriangles)
 {
-	MarchingCubeTable table;
-	table.buildTriangleTable();
+	const signed char* tris = MarchingCubeTable::getTriangles(1);
+	EXPECT_EQ(0, tris[0]);
+	EXPECT_EQ(8, tris[1]);
+	EXPECT_EQ(3, tris[2]);
+	EXPECT_EQ(-1, tris[3]);
+	EXPECT_EQ(-1, MarchingCubeTable::getTriangles(255)[0]);
+}
 
-	EXPECT_EQ(256, table.getTriangleTable().size());
+TEST(MarchingCubeTableTest, TestEdgeFlagsMatchTriangles)
+{
+	for (int i = 0; i < 256; ++i) {
+		unsigned short flags = 0;
+		const signed char* tris = MarchingCubeTable::getTriangles(i);
+		for (int j = 0; tris[j] != -1; ++j) {
+			flags |= 1 << tris[j];
+		}
+		EXPECT_EQ(MarchingCubeTable::getEdgeFlags(i), flags);
+	}
+}
 
-}
\ No newline at end of file
+TEST(MarchingCubeTableTest, TestGetEdgeCorners)
+{
+	EXPECT_EQ(3, MarchingCubeTable::getEdgeCorners(2)[1]);
+	EXPECT_EQ(7, MarchingCubeTable::getEdgeCorners(11)[1]);
+}
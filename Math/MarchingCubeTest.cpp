@@ -29,4 +29,46 @@ TYPED_TEST(MarchingCubeTest, TestMarchScalarSpace)
 	Volume3d<GeomType, ValueType> ss(s, grid);
 
 	mc.march(ss, 1);
-}
\ No newline at end of file
+}
+
+TYPED_TEST(MarchingCubeTest, TestMarchIndexed)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	MarchingCube<GeomType, ValueType> mc;
+
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(10, 10, 10)), Grid3d<ValueType>(30, 30, 30));
+	const Vector3d<GeomType> center(5, 5, 5);
+	for (unsigned int x = 0; x < 30; ++x) {
+		for (unsigned int y = 0; y < 30; ++y) {
+			for (unsigned int z = 0; z < 30; ++z) {
+				if (volume.toCenterPosition(x, y, z).getDistance(center) < 4) {
+					volume.setValue(x, y, z, 2);
+				}
+			}
+		}
+	}
+
+	const auto& triangles = mc.march(volume, 1);
+	const auto& mesh = mc.marchIndexed(volume, 1);
+	EXPECT_EQ(triangles.size(), mesh.getTriangleCount());
+	EXPECT_LT(mesh.getVertexCount(), triangles.size());
+
+	GeomType expectedArea = 0;
+	for (const auto& t : triangles) {
+		expectedArea += t.getArea();
+	}
+	GeomType actualArea = 0;
+	for (const auto& t : mesh.toTriangles()) {
+		actualArea += t.getArea();
+	}
+	EXPECT_NEAR(expectedArea, actualArea, expectedArea * 1.0e-4);
+
+	// every vertex is shared, including those on slab seams.
+	for (size_t i = 1; i < mesh.getVertexCount(); ++i) {
+		for (size_t j = 0; j < i; ++j) {
+			ASSERT_NE(mesh.getPositions()[i], mesh.getPositions()[j]);
+		}
+	}
+}
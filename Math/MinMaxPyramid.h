@@ -0,0 +1,255 @@
+#ifndef __CRYSTAL_MATH_MIN_MAX_PYRAMID_H__
+#define __CRYSTAL_MATH_MIN_MAX_PYRAMID_H__
+
+#include "Grid.h"
+#include "GridSpaceBase.h"
+#include "Bitmap.h"
+
+#include <vector>
+#include <array>
+#include <algorithm>
+
+namespace Crystal {
+	namespace Math {
+
+// Value range of every BlockSize^3 block of cells, plus coarser levels that each merge 2x2x2 blocks of the level
+// below. A block's range includes the one-voxel apron on its upper sides, so it covers every corner of its cells.
+// Ranges are widened on single voxel writes and only shrink again on refresh() or build().
+template<typename T>
+class MinMaxPyramid final
+{
+public:
+	MinMaxPyramid() :
+		blockSize(8)
+	{}
+
+	~MinMaxPyramid() = default;
+
+	void build(const Grid3d<T>& grid, const unsigned int blockSize) {
+		this->blockSize = blockSize;
+		gridSizes = { grid.getSizeX(), grid.getSizeY(), grid.getSizeZ() };
+		mins.clear();
+		maxs.clear();
+		if (gridSizes[0] < 2 || gridSizes[1] < 2 || gridSizes[2] < 2) {
+			return;
+		}
+		std::array<size_t, 3> counts = {
+			toBlockCount(gridSizes[0]),
+			toBlockCount(gridSizes[1]),
+			toBlockCount(gridSizes[2])
+		};
+		for (;;) {
+			mins.emplace_back(counts[0], counts[1], counts[2]);
+			maxs.emplace_back(counts[0], counts[1], counts[2]);
+			if (counts[0] == 1 && counts[1] == 1 && counts[2] == 1) {
+				break;
+			}
+			for (auto& c : counts) {
+				c = (c + 1) / 2;
+			}
+		}
+		refresh(grid, { 0, 0, 0 }, { gridSizes[0], gridSizes[1], gridSizes[2] });
+	}
+
+	void clear() {
+		mins.clear();
+		maxs.clear();
+	}
+
+	bool isEmpty() const { return mins.empty(); }
+
+	unsigned int getBlockSize() const { return blockSize; }
+
+	size_t getLevelCount() const { return mins.size(); }
+
+	Index3d getBlockCounts(const size_t level) const {
+		const auto& g = mins[level];
+		return{ static_cast<unsigned int>(g.getSizeX()), static_cast<unsigned int>(g.getSizeY()), static_cast<unsigned int>(g.getSizeZ()) };
+	}
+
+	T getMin(const size_t level, const size_t x, const size_t y, const size_t z) const { return mins[level].get(x, y, z); }
+
+	T getMax(const size_t level, const size_t x, const size_t y, const size_t z) const { return maxs[level].get(x, y, z); }
+
+	// true when the block may hold a cell with corners on both sides of the threshold.
+	bool isCrossing(const size_t level, const size_t x, const size_t y, const size_t z, const T threshold) const {
+		return (mins[level].get(x, y, z) < threshold) && !(maxs[level].get(x, y, z) < threshold);
+	}
+
+	bool isCrossing(const T threshold) const {
+		return !isEmpty() && isCrossing(mins.size() - 1, 0, 0, 0, threshold);
+	}
+
+	// widens the blocks around voxel (x, y, z) to include v.
+	void widen(const size_t x, const size_t y, const size_t z, const T v) {
+		if (isEmpty()) {
+			return;
+		}
+		Index3d start;
+		Index3d end;
+		if (!toBlockRange({ x, y, z }, { x + 1, y + 1, z + 1 }, start, end)) {
+			return;
+		}
+		for (size_t level = 0; level < mins.size(); ++level) {
+			for (unsigned int bz = start[2]; bz < end[2]; ++bz) {
+				for (unsigned int by = start[1]; by < end[1]; ++by) {
+					for (unsigned int bx = start[0]; bx < end[0]; ++bx) {
+						if (v < mins[level].get(bx, by, bz)) {
+							mins[level].set(bx, by, bz, v);
+						}
+						if (maxs[level].get(bx, by, bz) < v) {
+							maxs[level].set(bx, by, bz, v);
+						}
+					}
+				}
+			}
+			toParentRange(start, end);
+		}
+	}
+
+	// recomputes the exact ranges of the blocks touching voxels [start, end) and of their parents.
+	void refresh(const Grid3d<T>& grid, const std::array<size_t, 3>& start, const std::array<size_t, 3>& end) {
+		if (isEmpty()) {
+			return;
+		}
+		Index3d bs;
+		Index3d be;
+		if (!toBlockRange(start, end, bs, be)) {
+			return;
+		}
+		for (unsigned int bz = bs[2]; bz < be[2]; ++bz) {
+			for (unsigned int by = bs[1]; by < be[1]; ++by) {
+				for (unsigned int bx = bs[0]; bx < be[0]; ++bx) {
+					refreshBlock(grid, bx, by, bz);
+				}
+			}
+		}
+		for (size_t level = 1; level < mins.size(); ++level) {
+			toParentRange(bs, be);
+			for (unsigned int bz = bs[2]; bz < be[2]; ++bz) {
+				for (unsigned int by = bs[1]; by < be[1]; ++by) {
+					for (unsigned int bx = bs[0]; bx < be[0]; ++bx) {
+						mergeChildren(level, bx, by, bz);
+					}
+				}
+			}
+		}
+	}
+
+	// level-0 blocks that may hold boundary cells, found by descending from the top level.
+	Bitmap3d getCrossingBlocks(const T threshold) const {
+		if (isEmpty()) {
+			return Bitmap3d(0u, 0u, 0u);
+		}
+		const auto& counts = getBlockCounts(0);
+		Bitmap3d blocks(counts[0], counts[1], counts[2]);
+		findCrossingBlocks(mins.size() - 1, 0, 0, 0, threshold, blocks);
+		return blocks;
+	}
+
+private:
+	unsigned int blockSize;
+	std::array<size_t, 3> gridSizes;
+	std::vector< Grid3d<T> > mins;
+	std::vector< Grid3d<T> > maxs;
+
+	size_t toBlockCount(const size_t size) const { return (size - 2) / blockSize + 1; }
+
+	// a voxel belongs to its own block and, on a block border, to the block below whose apron it is.
+	bool toBlockRange(const std::array<size_t, 3>& start, const std::array<size_t, 3>& end, Index3d& bs, Index3d& be) const {
+		const auto& counts = getBlockCounts(0);
+		for (int a = 0; a < 3; ++a) {
+			const size_t e = std::min(end[a], gridSizes[a]);
+			if (start[a] >= e) {
+				return false;
+			}
+			bs[a] = static_cast<unsigned int>((start[a] == 0) ? 0 : (start[a] - 1) / blockSize);
+			be[a] = std::min(static_cast<unsigned int>((e - 1) / blockSize + 1), counts[a]);
+		}
+		return true;
+	}
+
+	static void toParentRange(Index3d& start, Index3d& end) {
+		for (int a = 0; a < 3; ++a) {
+			start[a] /= 2;
+			end[a] = (end[a] + 1) / 2;
+		}
+	}
+
+	void refreshBlock(const Grid3d<T>& grid, const unsigned int bx, const unsigned int by, const unsigned int bz) {
+		const size_t x0 = bx * blockSize;
+		const size_t y0 = by * blockSize;
+		const size_t z0 = bz * blockSize;
+		const size_t x1 = std::min<size_t>(x0 + blockSize + 1, gridSizes[0]);
+		const size_t y1 = std::min<size_t>(y0 + blockSize + 1, gridSizes[1]);
+		const size_t z1 = std::min<size_t>(z0 + blockSize + 1, gridSizes[2]);
+		T min = grid.get(x0, y0, z0);
+		T max = min;
+		for (size_t z = z0; z < z1; ++z) {
+			for (size_t y = y0; y < y1; ++y) {
+				for (size_t x = x0; x < x1; ++x) {
+					const T v = grid.get(x, y, z);
+					if (v < min) {
+						min = v;
+					}
+					if (max < v) {
+						max = v;
+					}
+				}
+			}
+		}
+		mins[0].set(bx, by, bz, min);
+		maxs[0].set(bx, by, bz, max);
+	}
+
+	void mergeChildren(const size_t level, const unsigned int x, const unsigned int y, const unsigned int z) {
+		const auto& children = getBlockCounts(level - 1);
+		bool isFirst = true;
+		T min = T();
+		T max = T();
+		for (unsigned int i = 0; i < 8; ++i) {
+			const unsigned int cx = x * 2 + (i & 1);
+			const unsigned int cy = y * 2 + ((i >> 1) & 1);
+			const unsigned int cz = z * 2 + ((i >> 2) & 1);
+			if (cx >= children[0] || cy >= children[1] || cz >= children[2]) {
+				continue;
+			}
+			const T cmin = mins[level - 1].get(cx, cy, cz);
+			const T cmax = maxs[level - 1].get(cx, cy, cz);
+			if (isFirst || cmin < min) {
+				min = cmin;
+			}
+			if (isFirst || max < cmax) {
+				max = cmax;
+			}
+			isFirst = false;
+		}
+		mins[level].set(x, y, z, min);
+		maxs[level].set(x, y, z, max);
+	}
+
+	void findCrossingBlocks(const size_t level, const unsigned int x, const unsigned int y, const unsigned int z, const T threshold, Bitmap3d& blocks) const {
+		if (!isCrossing(level, x, y, z, threshold)) {
+			return;
+		}
+		if (level == 0) {
+			blocks.set(x, y, z);
+			return;
+		}
+		const auto& children = getBlockCounts(level - 1);
+		for (unsigned int i = 0; i < 8; ++i) {
+			const unsigned int cx = x * 2 + (i & 1);
+			const unsigned int cy = y * 2 + ((i >> 1) & 1);
+			const unsigned int cz = z * 2 + ((i >> 2) & 1);
+			if (cx < children[0] && cy < children[1] && cz < children[2]) {
+				findCrossingBlocks(level - 1, cx, cy, cz, threshold, blocks);
+			}
+		}
+	}
+
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+
+#include "../Math/MinMaxPyramid.h"
+#include "../Math/Volume.h"
+
+using namespace Crystal::Math;
+
+template<class T>
+class MinMaxPyramidTest : public testing::Test {
+};
+
+typedef ::testing::Types<float, double> TestTypes;
+
+TYPED_TEST_CASE(MinMaxPyramidTest, TestTypes);
+
+TYPED_TEST(MinMaxPyramidTest, TestBuild)
+{
+	using T = TypeParam;
+	Grid3d<T> grid(20, 20, 20, 0);
+	grid.set(8, 0, 0, 1);
+	MinMaxPyramid<T> pyramid;
+	EXPECT_TRUE(pyramid.isEmpty());
+	pyramid.build(grid, 8);
+	EXPECT_EQ(3, pyramid.getLevelCount());
+	const Index3d counts = { 3, 3, 3 };
+	EXPECT_EQ(counts, pyramid.getBlockCounts(0));
+
+	// voxel 8 is the apron of block 0 and the first voxel of block 1.
+	EXPECT_EQ(1, pyramid.getMax(0, 0, 0, 0));
+	EXPECT_EQ(1, pyramid.getMax(0, 1, 0, 0));
+	EXPECT_EQ(0, pyramid.getMax(0, 2, 0, 0));
+	EXPECT_EQ(1, pyramid.getMax(2, 0, 0, 0));
+	EXPECT_TRUE(pyramid.isCrossing(T(0.5)));
+	EXPECT_FALSE(pyramid.isCrossing(T(1.5)));
+}
+
+TYPED_TEST(MinMaxPyramidTest, TestWidenAndRefresh)
+{
+	using T = TypeParam;
+	Grid3d<T> grid(20, 20, 20, 0);
+	MinMaxPyramid<T> pyramid;
+	pyramid.build(grid, 8);
+	EXPECT_FALSE(pyramid.isCrossing(T(0.5)));
+
+	grid.set(19, 19, 19, 1);
+	pyramid.widen(19, 19, 19, 1);
+	EXPECT_TRUE(pyramid.isCrossing(T(0.5)));
+	EXPECT_EQ(1, pyramid.getCrossingBlocks(T(0.5)).getCount());
+	EXPECT_TRUE(pyramid.getCrossingBlocks(T(0.5)).get(2, 2, 2));
+
+	grid.set(19, 19, 19, 0);
+	pyramid.widen(19, 19, 19, 0);
+	EXPECT_TRUE(pyramid.isCrossing(T(0.5)));
+	pyramid.refresh(grid, { 16, 16, 16 }, { 20, 20, 20 });
+	EXPECT_FALSE(pyramid.isCrossing(T(0.5)));
+}
+
+TYPED_TEST(MinMaxPyramidTest, TestVolumeBoundaryCells)
+{
+	using T = TypeParam;
+	Volume3d<T, T> volume(Space3d<T>::Unit(), Grid3d<T>(30, 30, 30));
+	volume.setValue(12, 5, 21, 2);
+	volume.setValue(29, 29, 29, 2);
+	const auto expected = volume.toBoundaryCells(1).size();
+	volume.enableRangePyramid();
+	EXPECT_TRUE(volume.hasRangePyramid());
+	EXPECT_EQ(expected, volume.toBoundaryCells(1).size());
+	EXPECT_FALSE(volume.mayHaveBoundary(0, 0, 0, 1));
+	EXPECT_TRUE(volume.mayHaveBoundary(1, 0, 2, 1));
+
+	volume.setValue(0, 0, 0, 2);
+	EXPECT_TRUE(volume.mayHaveBoundary(0, 0, 0, 1));
+	EXPECT_EQ(expected + 1, volume.toBoundaryCells(1).size());
+}
@@ -0,0 +1,301 @@
+#ifndef __CRYSTAL_MATH_SPARSE_VOLUME_H__
+#define __CRYSTAL_MATH_SPARSE_VOLUME_H__
+
+#include "Grid.h"
+#include "Space.h"
+#include "GridSpaceBase.h"
+#include "VolumeCell.h"
+#include "Volume.h"
+
+#include <unordered_map>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cassert>
+
+namespace Crystal {
+	namespace Math {
+
+// Volume stored as 8x8x8 leaf blocks in a hash map. Voxels outside any active block read as the background value,
+// so memory follows the active (surface) region instead of the bounding box.
+template< typename GeomType, typename ValueType = float>
+class SparseVolume3d : public GridSpaceBase<GeomType> {
+public:
+	static const unsigned int BlockSize = 8;
+
+	using Block = Grid3d<ValueType>;
+
+	SparseVolume3d() :
+		SparseVolume3d(Space3d<GeomType>::Unit(), { 2, 2, 2 }, ValueType(0))
+	{}
+
+	SparseVolume3d(const Space3d<GeomType>& space, const Index3d& resolutions, const ValueType background) :
+		GridSpaceBase( space, resolutions ),
+		background( background )
+	{
+	}
+
+	// activates only the blocks that contain a voxel different from the background.
+	SparseVolume3d(const Volume3d<GeomType, ValueType>& volume, const ValueType background) :
+		GridSpaceBase( volume.getSpace(), volume.getResolutions() ),
+		background( background )
+	{
+		const auto& res = getResolutions();
+		for (unsigned int z = 0; z < res[2]; ++z) {
+			for (unsigned int y = 0; y < res[1]; ++y) {
+				for (unsigned int x = 0; x < res[0]; ++x) {
+					const auto v = volume.getValue(x, y, z);
+					if (v != background) {
+						setValue(x, y, z, v);
+					}
+				}
+			}
+		}
+	}
+
+	ValueType getBackground() const { return background; }
+
+	ValueType getValue(const size_t x, const size_t y, const size_t z) const {
+		const Block* block = findBlock(x / BlockSize, y / BlockSize, z / BlockSize);
+		if (block == nullptr) {
+			return background;
+		}
+		return block->get(x % BlockSize, y % BlockSize, z % BlockSize);
+	}
+
+	void setValue(const size_t x, const size_t y, const size_t z, const ValueType v) {
+		touchBlock(x / BlockSize, y / BlockSize, z / BlockSize).set(x % BlockSize, y % BlockSize, z % BlockSize, v);
+	}
+
+	void add(const size_t x, const size_t y, const size_t z, const ValueType v) {
+		touchBlock(x / BlockSize, y / BlockSize, z / BlockSize).add(x % BlockSize, y % BlockSize, z % BlockSize, v);
+	}
+
+	SparseVolume3d& operator+=(const SparseVolume3d& rhs) {
+		return combine(rhs, true);
+	}
+
+	SparseVolume3d& operator-=(const SparseVolume3d& rhs) {
+		return combine(rhs, false);
+	}
+
+	SparseVolume3d& add(const SparseVolume3d& rhs) { return combine(rhs, true); }
+
+	SparseVolume3d& sub(const SparseVolume3d& rhs) { return combine(rhs, false); }
+
+	size_t getBlockCount() const { return blocks.size(); }
+
+	size_t getActiveVoxelCount() const { return blocks.size() * BlockSize * BlockSize * BlockSize; }
+
+	// block indices of the active blocks, sorted z-major.
+	std::vector< Index3d > getBlockIndices() const {
+		std::vector< Index3d > indices;
+		indices.reserve(blocks.size());
+		for (const auto key : getSortedKeys()) {
+			indices.push_back(toBlockIndex(key));
+		}
+		return indices;
+	}
+
+	const Block* findBlock(const size_t bx, const size_t by, const size_t bz) const {
+		const auto iter = blocks.find(toKey(bx, by, bz));
+		return (iter == blocks.end()) ? nullptr : &(iter->second);
+	}
+
+	// calls func(blockIndex, block) for every active block in z-major order.
+	template<typename Func>
+	void forEachBlock(const Func& func) const {
+		for (const auto key : getSortedKeys()) {
+			func(toBlockIndex(key), blocks.find(key)->second);
+		}
+	}
+
+	// drops blocks whose voxels all equal the background.
+	void prune() {
+		for (auto iter = blocks.begin(); iter != blocks.end(); ) {
+			const auto& block = iter->second;
+			const bool isUniform = std::all_of(block.data(), block.data() + block.getSize(), [this](const ValueType v) { return v == background; });
+			if (isUniform) {
+				iter = blocks.erase(iter);
+			}
+			else {
+				++iter;
+			}
+		}
+	}
+
+	Volume3d<GeomType, ValueType> toVolume() const {
+		const auto& res = getResolutions();
+		Grid3d<ValueType> grid(res[0], res[1], res[2], background);
+		forEachBlock([&](const Index3d& b, const Block& block) {
+			for (unsigned int z = 0; z < BlockSize; ++z) {
+				for (unsigned int y = 0; y < BlockSize; ++y) {
+					for (unsigned int x = 0; x < BlockSize; ++x) {
+						const size_t ix = b[0] * BlockSize + x;
+						const size_t iy = b[1] * BlockSize + y;
+						const size_t iz = b[2] * BlockSize + z;
+						if (ix < res[0] && iy < res[1] && iz < res[2]) {
+							grid.set(ix, iy, iz, block.get(x, y, z));
+						}
+					}
+				}
+			}
+		});
+		return Volume3d<GeomType, ValueType>(getSpace(), grid);
+	}
+
+	std::vector< VolumeCell3d<GeomType, ValueType> > toBoundaryCells(const ValueType threshold) const {
+		std::vector< VolumeCell3d<GeomType, ValueType> > cells;
+		forEachBoundaryCell(threshold, [&](const VolumeCell3d<GeomType, ValueType>& c) {
+			cells.push_back(c);
+		});
+		return cells;
+	}
+
+	// Same cells as Volume3d::forEachBoundaryCell, visited block by block. Only the active blocks and the inactive
+	// blocks directly below them are scanned, since a cell in the middle of an inactive block is all background.
+	template<typename Func>
+	void forEachBoundaryCell(const ValueType threshold, const Func& func) const {
+		const auto& res = getResolutions();
+		if (res[0] < 2 || res[1] < 2 || res[2] < 2) {
+			return;
+		}
+		const auto& unitLengths = getUnitLengths();
+
+		for (const auto key : getCandidateKeys()) {
+			const auto& b = toBlockIndex(key);
+			const auto iter = blocks.find(key);
+			const Block* block = (iter == blocks.end()) ? nullptr : &(iter->second);
+
+			const size_t ox = b[0] * BlockSize;
+			const size_t oy = b[1] * BlockSize;
+			const size_t oz = b[2] * BlockSize;
+			const size_t ex = std::min<size_t>(ox + BlockSize, res[0] - 1);
+			const size_t ey = std::min<size_t>(oy + BlockSize, res[1] - 1);
+			const size_t ez = std::min<size_t>(oz + BlockSize, res[2] - 1);
+			for (size_t z = oz; z < ez; ++z) {
+				for (size_t y = oy; y < ey; ++y) {
+					for (size_t x = ox; x < ex; ++x) {
+						const bool isInner = (x + 1 < ox + BlockSize) && (y + 1 < oy + BlockSize) && (z + 1 < oz + BlockSize);
+						if (isInner && block == nullptr) {
+							continue;
+						}
+						const auto& values = isInner ?
+							block->toArray8(x - ox, y - oy, z - oz) :
+							toArray8(x, y, z);
+						if (isBoundary(values, threshold)) {
+							const VolumeCell3d<GeomType, ValueType> cell(Space3d<GeomType>(toCenterPosition(x, y, z), unitLengths), values);
+							func(cell);
+						}
+					}
+				}
+			}
+		}
+	}
+
+private:
+	std::unordered_map< std::uint64_t, Block > blocks;
+	ValueType background;
+
+	static std::uint64_t toKey(const size_t bx, const size_t by, const size_t bz) {
+		return static_cast<std::uint64_t>(bx) | (static_cast<std::uint64_t>(by) << 21) | (static_cast<std::uint64_t>(bz) << 42);
+	}
+
+	static Index3d toBlockIndex(const std::uint64_t key) {
+		const std::uint64_t mask = (1 << 21) - 1;
+		return{ static_cast<unsigned int>(key & mask), static_cast<unsigned int>((key >> 21) & mask), static_cast<unsigned int>(key >> 42) };
+	}
+
+	Block& touchBlock(const size_t bx, const size_t by, const size_t bz) {
+		const auto key = toKey(bx, by, bz);
+		auto iter = blocks.find(key);
+		if (iter == blocks.end()) {
+			iter = blocks.insert(std::make_pair(key, Block(BlockSize, BlockSize, BlockSize, background))).first;
+		}
+		return iter->second;
+	}
+
+	std::vector< std::uint64_t > getSortedKeys() const {
+		std::vector< std::uint64_t > keys;
+		keys.reserve(blocks.size());
+		for (const auto& b : blocks) {
+			keys.push_back(b.first);
+		}
+		std::sort(keys.begin(), keys.end());
+		return keys;
+	}
+
+	// active blocks plus their -x/-y/-z neighbours, whose last cell layer reaches into the active block.
+	std::vector< std::uint64_t > getCandidateKeys() const {
+		std::vector< std::uint64_t > keys;
+		keys.reserve(blocks.size() * 8);
+		for (const auto& b : blocks) {
+			const auto& index = toBlockIndex(b.first);
+			for (unsigned int i = 0; i < 8; ++i) {
+				const unsigned int dx = i & 1;
+				const unsigned int dy = (i >> 1) & 1;
+				const unsigned int dz = (i >> 2) & 1;
+				if (index[0] >= dx && index[1] >= dy && index[2] >= dz) {
+					keys.push_back(toKey(index[0] - dx, index[1] - dy, index[2] - dz));
+				}
+			}
+		}
+		std::sort(keys.begin(), keys.end());
+		keys.erase(std::unique(keys.begin(), keys.end()), keys.end());
+		return keys;
+	}
+
+	std::array< ValueType, 8 > toArray8(const size_t x, const size_t y, const size_t z) const {
+		return std::array < ValueType, 8 > {
+			getValue(x, y, z),
+			getValue(x + 1, y, z),
+			getValue(x + 1, y + 1, z),
+			getValue(x, y + 1, z),
+			getValue(x, y, z + 1),
+			getValue(x + 1, y, z + 1),
+			getValue(x + 1, y + 1, z + 1),
+			getValue(x, y + 1, z + 1)
+		};
+	}
+
+	static bool isBoundary(const std::array< ValueType, 8 >& values, const ValueType threshold) {
+		const bool isLower = values[0] < threshold;
+		for (size_t i = 1; i < 8; ++i) {
+			if ((values[i] < threshold) != isLower) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	SparseVolume3d& combine(const SparseVolume3d& rhs, const bool isAdd) {
+		assert(getResolutions() == rhs.getResolutions());
+		for (const auto& b : rhs.blocks) {
+			const auto& index = toBlockIndex(b.first);
+			touchBlock(index[0], index[1], index[2]);
+		}
+		for (auto& b : blocks) {
+			auto& block = b.second;
+			const auto iter = rhs.blocks.find(b.first);
+			if (iter == rhs.blocks.end()) {
+				for (size_t i = 0; i < block.getSize(); ++i) {
+					block.data()[i] = isAdd ? block.data()[i] + rhs.background : block.data()[i] - rhs.background;
+				}
+			}
+			else if (isAdd) {
+				block.add(iter->second);
+			}
+			else {
+				block.sub(iter->second);
+			}
+		}
+		background = isAdd ? background + rhs.background : background - rhs.background;
+		return (*this);
+	}
+
+};
+
+	}
+}
+
+#endif
@@ -0,0 +1,97 @@
+#include "gtest/gtest.h"
+
+#include "../Math/SparseVolume.h"
+#include "../Math/MarchingCube.h"
+
+#include <tuple>
+
+using namespace Crystal::Math;
+
+template<class T>
+class SparseVolume3dTest : public testing::Test {
+};
+
+using TestTypes = ::testing::Types <
+	std::tuple< float, float >,
+	std::tuple< float, unsigned char >
+>;
+
+TYPED_TEST_CASE(SparseVolume3dTest, TestTypes);
+
+namespace {
+	template<typename GeomType, typename ValueType>
+	Volume3d<GeomType, ValueType> createSphere(const unsigned int res)
+	{
+		Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(10, 10, 10)), Grid3d<ValueType>(res, res, res));
+		const Vector3d<GeomType> center(5, 5, 5);
+		for (unsigned int x = 0; x < res; ++x) {
+			for (unsigned int y = 0; y < res; ++y) {
+				for (unsigned int z = 0; z < res; ++z) {
+					if (volume.toCenterPosition(x, y, z).getDistance(center) < 3) {
+						volume.setValue(x, y, z, 1);
+					}
+				}
+			}
+		}
+		return volume;
+	}
+}
+
+TYPED_TEST(SparseVolume3dTest, TestGetValue)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	SparseVolume3d<GeomType, ValueType> volume(Space3d<GeomType>::Unit(), { 20, 20, 20 }, 0);
+	EXPECT_EQ(0, volume.getValue(10, 10, 10));
+	EXPECT_EQ(0, volume.getBlockCount());
+
+	volume.setValue(10, 10, 10, 1);
+	EXPECT_EQ(1, volume.getValue(10, 10, 10));
+	EXPECT_EQ(0, volume.getValue(9, 10, 10));
+	EXPECT_EQ(1, volume.getBlockCount());
+
+	volume.setValue(10, 10, 10, 0);
+	volume.prune();
+	EXPECT_EQ(0, volume.getBlockCount());
+}
+
+TYPED_TEST(SparseVolume3dTest, TestToVolume)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	const auto& dense = createSphere<GeomType, ValueType>(20);
+	const SparseVolume3d<GeomType, ValueType> sparse(dense, 0);
+	EXPECT_EQ(dense.getGrid(), sparse.toVolume().getGrid());
+}
+
+TYPED_TEST(SparseVolume3dTest, TestToBoundaryCells)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	const auto& dense = createSphere<GeomType, ValueType>(20);
+	const SparseVolume3d<GeomType, ValueType> sparse(dense, 0);
+	EXPECT_EQ(dense.toBoundaryCells(1).size(), sparse.toBoundaryCells(1).size());
+
+	MarchingCube<GeomType, ValueType> mc;
+	EXPECT_EQ(mc.march(dense, 1).size(), mc.march(sparse, 1).size());
+}
+
+TYPED_TEST(SparseVolume3dTest, TestAdd)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	SparseVolume3d<GeomType, ValueType> lhs(Space3d<GeomType>::Unit(), { 20, 20, 20 }, 0);
+	SparseVolume3d<GeomType, ValueType> rhs(Space3d<GeomType>::Unit(), { 20, 20, 20 }, 1);
+	lhs.setValue(0, 0, 0, 2);
+	rhs.setValue(19, 19, 19, 3);
+	lhs += rhs;
+	EXPECT_EQ(3, lhs.getValue(0, 0, 0));
+	EXPECT_EQ(3, lhs.getValue(19, 19, 19));
+	EXPECT_EQ(1, lhs.getValue(10, 10, 10));
+	EXPECT_EQ(2, lhs.getBlockCount());
+
+	lhs -= rhs;
+	EXPECT_EQ(2, lhs.getValue(0, 0, 0));
+	EXPECT_EQ(0, lhs.getValue(19, 19, 19));
+	EXPECT_EQ(0, lhs.getValue(10, 10, 10));
+}
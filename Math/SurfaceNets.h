@@ -0,0 +1,158 @@
+#ifndef __CRYSTAL_MATH_SURFACE_NETS_H__
+#define __CRYSTAL_MATH_SURFACE_NETS_H__
+
+#include "../Util/UnCopyable.h"
+#include "MarchingCubeTable.h"
+#include "IndexedMesh.h"
+#include "PositionValue.h"
+#include "Volume.h"
+#include "BitSpace.h"
+
+#include <vector>
+#include <array>
+
+namespace Crystal {
+	namespace Math {
+
+// Surface nets: one vertex per boundary cell, placed at the average of the cell's edge crossings, and one quad
+// (two triangles) per grid edge that crosses the surface. Triangles wind counter-clockwise seen from outside.
+template<typename GeomType, typename ValueType = float>
+class SurfaceNets final : UnCopyable
+{
+public:
+	SurfaceNets() = default;
+
+	~SurfaceNets() = default;
+
+	// grid points with value >= isolevel are inside.
+	IndexedMesh<GeomType> build(const Volume3d<GeomType, ValueType>& volume, const ValueType isolevel) const
+	{
+		const auto isInside = [&](const unsigned int x, const unsigned int y, const unsigned int z) {
+			return !(volume.getValue(x, y, z) < isolevel);
+		};
+		const auto getCrossing = [&](const Index3d& i0, const Vector3d<GeomType>& p0, const Index3d& i1, const Vector3d<GeomType>& p1) {
+			const PositionValue<GeomType, ValueType> pv0(p0, volume.getValue(i0[0], i0[1], i0[2]));
+			const PositionValue<GeomType, ValueType> pv1(p1, volume.getValue(i1[0], i1[1], i1[2]));
+			return pv0.getInterpolatedPosition(isolevel, pv1);
+		};
+		return build(volume, isInside, getCrossing);
+	}
+
+	// set bits are inside. crossings are at edge midpoints.
+	IndexedMesh<GeomType> build(const BitSpace3d<GeomType>& space) const
+	{
+		const Bitmap3d bmp = space.getBitmap();
+		const auto isInside = [&](const unsigned int x, const unsigned int y, const unsigned int z) {
+			return bmp.get(x, y, z);
+		};
+		const auto getCrossing = [](const Index3d&, const Vector3d<GeomType>& p0, const Index3d&, const Vector3d<GeomType>& p1) {
+			return p0 * GeomType(0.5) + p1 * GeomType(0.5);
+		};
+		return build(space, isInside, getCrossing);
+	}
+
+private:
+	template<typename Inside, typename Crossing>
+	IndexedMesh<GeomType> build(const GridSpaceBase<GeomType>& grid, const Inside& isInside, const Crossing& getCrossing) const
+	{
+		static const unsigned int cornerOffsets[8][3] = {
+			{ 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 },
+			{ 0, 0, 1 }, { 1, 0, 1 }, { 1, 1, 1 }, { 0, 1, 1 }
+		};
+
+		IndexedMesh<GeomType> mesh;
+		const auto& res = grid.getResolutions();
+		if (res[0] < 2 || res[1] < 2 || res[2] < 2) {
+			return mesh;
+		}
+
+		const unsigned int cx = res[0] - 1;
+		const unsigned int cy = res[1] - 1;
+		const unsigned int cz = res[2] - 1;
+		// vertex index of each cell in the previous and current cell layers.
+		std::vector<unsigned int> prev(cx * cy, 0);
+		std::vector<unsigned int> cur(cx * cy, 0);
+		const auto toCell = [cx](const unsigned int x, const unsigned int y) { return y * cx + x; };
+
+		for (unsigned int z = 0; z < cz; ++z) {
+			for (unsigned int y = 0; y < cy; ++y) {
+				for (unsigned int x = 0; x < cx; ++x) {
+					int cubeindex = 0;
+					for (int i = 0; i < 8; ++i) {
+						cubeindex |= isInside(x + cornerOffsets[i][0], y + cornerOffsets[i][1], z + cornerOffsets[i][2]) ? (1 << i) : 0;
+					}
+					const unsigned short edges = MarchingCubeTable::getEdgeFlags(cubeindex);
+					if (edges == 0) {
+						continue;
+					}
+
+					Vector3d<GeomType> sum(0, 0, 0);
+					int count = 0;
+					for (int e = 0; e < 12; ++e) {
+						if ((edges & (1 << e)) == 0) {
+							continue;
+						}
+						const unsigned char* corners = MarchingCubeTable::getEdgeCorners(e);
+						const auto* o0 = cornerOffsets[corners[0]];
+						const auto* o1 = cornerOffsets[corners[1]];
+						const Index3d i0 = { x + o0[0], y + o0[1], z + o0[2] };
+						const Index3d i1 = { x + o1[0], y + o1[1], z + o1[2] };
+						sum += getCrossing(i0, grid.toCenterPosition(i0[0], i0[1], i0[2]), i1, grid.toCenterPosition(i1[0], i1[1], i1[2]));
+						++count;
+					}
+					cur[toCell(x, y)] = mesh.addPosition(sum / static_cast<GeomType>(count));
+				}
+			}
+
+			// z edges inside this cell layer.
+			for (unsigned int y = 1; y < cy; ++y) {
+				for (unsigned int x = 1; x < cx; ++x) {
+					const bool in0 = isInside(x, y, z);
+					if (in0 != isInside(x, y, z + 1)) {
+						addQuad(mesh, cur[toCell(x - 1, y - 1)], cur[toCell(x, y - 1)], cur[toCell(x, y)], cur[toCell(x - 1, y)], in0);
+					}
+				}
+			}
+			// x and y edges on the grid plane between the previous and current layers.
+			if (z > 0) {
+				for (unsigned int y = 1; y < cy; ++y) {
+					for (unsigned int x = 0; x < cx; ++x) {
+						const bool in0 = isInside(x, y, z);
+						if (in0 != isInside(x + 1, y, z)) {
+							addQuad(mesh, prev[toCell(x, y - 1)], prev[toCell(x, y)], cur[toCell(x, y)], cur[toCell(x, y - 1)], in0);
+						}
+					}
+				}
+				for (unsigned int y = 0; y < cy; ++y) {
+					for (unsigned int x = 1; x < cx; ++x) {
+						const bool in0 = isInside(x, y, z);
+						if (in0 != isInside(x, y + 1, z)) {
+							addQuad(mesh, prev[toCell(x - 1, y)], cur[toCell(x - 1, y)], cur[toCell(x, y)], prev[toCell(x, y)], in0);
+						}
+					}
+				}
+			}
+			prev.swap(cur);
+		}
+		return mesh;
+	}
+
+	// vertices go counter-clockwise around the edge axis. the quad faces +axis when the edge leaves the inside.
+	void addQuad(IndexedMesh<GeomType>& mesh, const unsigned int v0, const unsigned int v1, const unsigned int v2, const unsigned int v3, const bool isOutward) const
+	{
+		if (isOutward) {
+			mesh.addTriangle(v0, v1, v2);
+			mesh.addTriangle(v0, v2, v3);
+		}
+		else {
+			mesh.addTriangle(v0, v2, v1);
+			mesh.addTriangle(v0, v3, v2);
+		}
+	}
+
+};
+
+	}
+}
+
+#endif
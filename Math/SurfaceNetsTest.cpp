@@ -0,0 +1,61 @@
+#include "gtest/gtest.h"
+
+#include "../Math/SurfaceNets.h"
+#include "../Math/MarchingCube.h"
+
+using namespace Crystal::Math;
+
+using TestTypes = ::testing::Types <
+	std::tuple< float, float >,
+	std::tuple< float, unsigned char >
+>;
+
+template<class T>
+class SurfaceNetsTest : public testing::Test {
+};
+
+TYPED_TEST_CASE(SurfaceNetsTest, TestTypes);
+
+TYPED_TEST(SurfaceNetsTest, TestBuildVolume)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(10, 10, 10)), Grid3d<ValueType>(20, 20, 20));
+	const Vector3d<GeomType> center(5, 5, 5);
+	for (unsigned int x = 0; x < 20; ++x) {
+		for (unsigned int y = 0; y < 20; ++y) {
+			for (unsigned int z = 0; z < 20; ++z) {
+				if (volume.toCenterPosition(x, y, z).getDistance(center) < 3) {
+					volume.setValue(x, y, z, 2);
+				}
+			}
+		}
+	}
+
+	SurfaceNets<GeomType, ValueType> nets;
+	const auto& mesh = nets.build(volume, 1);
+	MarchingCube<GeomType, ValueType> mc;
+	EXPECT_LT(mesh.getVertexCount(), mc.march(volume, 1).size());
+	ASSERT_FALSE(mesh.isEmpty());
+
+	for (const auto& t : mesh.toTriangles()) {
+		ASSERT_TRUE(t.isValid());
+		EXPECT_GT(t.getNormal().getInnerProduct(t.getCenter() - center), 0);
+	}
+}
+
+TYPED_TEST(SurfaceNetsTest, TestBuildBitSpace)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+
+	BitSpace3d<GeomType> space(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(4, 4, 4)), Bitmap3d(4, 4, 4));
+	space.setBox();
+
+	SurfaceNets<GeomType, ValueType> nets;
+	const auto& mesh = nets.build(space);
+	// 2x2x2 voxel box: every cell but the inner one is on the boundary, one quad per voxel face.
+	EXPECT_EQ(26, mesh.getVertexCount());
+	EXPECT_EQ(48, mesh.getTriangleCount());
+}
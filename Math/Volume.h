@@ -5,8 +5,12 @@
 #include "Space.h"
 #include "GridSpaceBase.h"
 #include "VolumeCell.h"
+#include "Bitmap.h"
+#include "MinMaxPyramid.h"
+#include "../Util/Parallel.h"
 
 #include <memory>
+#include <algorithm>
 #include <list>
 
 namespace Crystal {
@@ -39,32 +43,98 @@ public:
 
 	Volume3d(const Space3d<GeomType>& space_, const Grid3d<ValueType>& grid) :
 		GridSpaceBase( space_, grid.getSizes() ),
-		grid( grid )
+		grid( grid ),
+		dirtyBlocks( toBlockCount(grid.getSizeX()), toBlockCount(grid.getSizeY()), toBlockCount(grid.getSizeZ()), true )
 	{
 	}
 
+	// takes over the grid's storage, so large grids are not copied.
+	Volume3d(const Space3d<GeomType>& space_, Grid3d<ValueType>&& grid) :
+		GridSpaceBase( space_, grid.getSizes() ),
+		grid( std::move(grid) ),
+		dirtyBlocks( toBlockCount(this->grid.getSizeX()), toBlockCount(this->grid.getSizeY()), toBlockCount(this->grid.getSizeZ()), true )
+	{
+	}
+
+	Volume3d(const Volume3d& rhs) = default;
+
+	Volume3d(Volume3d&& rhs) :
+		GridSpaceBase( rhs ),
+		grid( std::move(rhs.grid) ),
+		dirtyBlocks( std::move(rhs.dirtyBlocks) ),
+		rangePyramid( std::move(rhs.rangePyramid) )
+	{
+	}
+
+	Volume3d& operator=(const Volume3d& rhs) = default;
+
+	Volume3d& operator=(Volume3d&& rhs) {
+		GridSpaceBase<GeomType>::operator=(rhs);
+		grid = std::move(rhs.grid);
+		dirtyBlocks = std::move(rhs.dirtyBlocks);
+		rangePyramid = std::move(rhs.rangePyramid);
+		return (*this);
+	}
+
 	Volume3d(const Attribute& attr) :
 		Volume3d(attr.space, Grid3d<ValueType>(attr.resx, attr.resy, attr.resz))
 	{}
 
 	void setValue(const ValueType v) {
-		for (size_t x = 0; x < grid.getSizeX(); ++x) {
-			for (size_t y = 0; y < grid.getSizeY(); ++y) {
-				for (size_t z = 0; z < grid.getSizeZ(); ++z) {
-					grid.set(x, y, z, v);
-				}
-			}
-		}
+		grid.setAll(v);
+		markAllDirty();
+		refreshRangePyramid();
 	}
 
 	void setValue(const int x, const int y, const int z, const ValueType v) {
 		grid.set(x, y, z, v);
+		markDirty(x, y, z);
+		rangePyramid.widen(x, y, z, v);
 	}
 
-	ValueType getValue(const int x, const int y, const int z) {
+	ValueType getValue(const int x, const int y, const int z) const {
 		return grid.get(x, y, z);
 	}
 
+	// Continuous reads. Voxel values sit at voxel centers and points outside are clamped to the outermost centers.
+	// Gradients are in value per unit length.
+	GeomType sample(const Vector3d<GeomType>& p) const { return interpolate<2>(p, nullptr); }
+
+	GeomType sampleCubic(const Vector3d<GeomType>& p) const { return interpolate<4>(p, nullptr); }
+
+	Vector3d<GeomType> gradient(const Vector3d<GeomType>& p) const {
+		Vector3d<GeomType> g;
+		interpolate<2>(p, &g);
+		return g;
+	}
+
+	Vector3d<GeomType> gradientCubic(const Vector3d<GeomType>& p) const {
+		Vector3d<GeomType> g;
+		interpolate<4>(p, &g);
+		return g;
+	}
+
+	// batched trilinear reads. large batches are split over worker threads.
+	void sample(const Vector3d<GeomType>* points, const size_t count, GeomType* results) const {
+		forEachBatch(count, [&](const size_t i) { results[i] = sample(points[i]); });
+	}
+
+	void gradient(const Vector3d<GeomType>* points, const size_t count, Vector3d<GeomType>* results) const {
+		forEachBatch(count, [&](const size_t i) { results[i] = gradient(points[i]); });
+	}
+
+	std::vector<GeomType> sample(const Vector3dVector<GeomType>& points) const {
+		std::vector<GeomType> results(points.size());
+		sample(points.data(), points.size(), results.data());
+		return results;
+	}
+
+	Vector3dVector<GeomType> gradient(const Vector3dVector<GeomType>& points) const {
+		Vector3dVector<GeomType> results(points.size());
+		gradient(points.data(), points.size(), results.data());
+		return results;
+	}
+
 	std::vector<ValueType> getValues() const {
 		std::vector<ValueType> values;
 		for (size_t x = 0; x < grid.getSizeX(); ++x) {
@@ -77,7 +147,7 @@ public:
 		return values;
 	}
 
-	Grid3d<ValueType> getGrid() const { return grid; }
+	const Grid3d<ValueType>& getGrid() const { return grid; }
 
 	std::vector< VolumeCell3d<GeomType, ValueType> > toCells() const {
 		std::vector< VolumeCell3d<GeomType, ValueType> > cells;
@@ -108,34 +178,40 @@ public:
 
 	std::vector< VolumeCell3d<GeomType, ValueType> > toBoundaryCells(const ValueType threshold) const {
 		std::vector< VolumeCell3d<GeomType, ValueType> > cells;
+		forEachBoundaryCell(threshold, [&](const VolumeCell3d<GeomType, ValueType>& c) {
+			cells.push_back(c);
+		});
+		return cells;
+	}
 
-		const auto& lengths = getUnitLengths();
-		const auto& innerSpace = getSpace().offset(lengths);
-		const auto& ss = innerSpace.getDivided(grid.getSizeX() - 1, grid.getSizeY() - 1, grid.getSizeZ() - 1);
-
-		int i = 0;
-		std::vector< Space3d<GeomType> > spaces;
-		std::vector< std::array<ValueType, 8 > > values;
-		for (size_t x = 0; x < grid.getSizeX() - 1; ++x) {
+	// Calls func(cell) for every boundary cell, z-major. Cell bounds and corner values are computed from the
+	// indices on the fly, so nothing is allocated. With the range pyramid enabled, runs of cells in blocks whose
+	// range excludes the threshold are skipped without reading the grid.
+	template<typename Func>
+	void forEachBoundaryCell(const ValueType threshold, const Func& func) const {
+		if (grid.getSizeX() < 2 || grid.getSizeY() < 2 || grid.getSizeZ() < 2) {
+			return;
+		}
+		if (hasRangePyramid() && !rangePyramid.isCrossing(threshold)) {
+			return;
+		}
+		const bool isSkipping = hasRangePyramid();
+		const Bitmap3d& blocks = isSkipping ? rangePyramid.getCrossingBlocks(threshold) : Bitmap3d(0u, 0u, 0u);
+		const auto& unitLengths = getUnitLengths();
+		for (size_t z = 0; z < grid.getSizeZ() - 1; ++z) {
 			for (size_t y = 0; y < grid.getSizeY() - 1; ++y) {
-				for (size_t z = 0; z < grid.getSizeZ() - 1; ++z) {
-					if (grid.isBoundary(x, y, z,threshold)) {
-						values.emplace_back(grid.toArray8(x, y, z));
-						spaces.emplace_back(ss[i]);
+				for (size_t x = 0; x < grid.getSizeX() - 1; ++x) {
+					if (isSkipping && !blocks.get(x / BlockSize, y / BlockSize, z / BlockSize)) {
+						x += BlockSize - 1 - x % BlockSize;
+						continue;
+					}
+					if (grid.isBoundary(x, y, z, threshold)) {
+						const VolumeCell3d<GeomType, ValueType> cell(Space3d<GeomType>(toCenterPosition(x, y, z), unitLengths), grid.toArray8(x, y, z));
+						func(cell);
 					}
-					++i;
 				}
 			}
 		}
-
-		assert(spaces.size() == values.size());
-
-		cells.reserve(values.size());
-		for (size_t i = 0; i < values.size(); ++i) {
-			VolumeCell3d<GeomType, ValueType> c(spaces[i], values[i]);
-			cells.emplace_back(c);
-		}
-		return std::move(cells);
 	}
 
 
@@ -143,36 +219,233 @@ public:
 		return Volume3d(getOverlappedSpace(rhs), getOverlappedGrid(rhs));
 	}
 
-	Volume3d add(const Volume3d& rhs) const {
-		const Volume3d& ss = getOverlapped(rhs.getSpace());
-		ss.getGrid().add(rhs.getGrid());
-		return ss;
+	// Element-wise operations over the region where the two spaces overlap, written in place. Voxels are matched
+	// by position, so both volumes are expected to share unit lengths. Rows run in parallel for large regions.
+	Volume3d& add(const Volume3d& rhs) {
+		return combine(rhs, [](ValueType* dest, const ValueType* src, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				dest[i] += src[i];
+			}
+		});
+	}
+
+	Volume3d& sub(const Volume3d& rhs) {
+		return combine(rhs, [](ValueType* dest, const ValueType* src, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				dest[i] -= src[i];
+			}
+		});
 	}
 
-	Volume3d sub(const Volume3d& rhs) const {
-		const Volume3d& ss = getOverlapped(rhs.getSpace());
-		ss.getGrid().sub(rhs.getGrid());
-		return ss;
+	// per-voxel max. CSG union when higher values are inside.
+	Volume3d& unite(const Volume3d& rhs) {
+		return combine(rhs, [](ValueType* dest, const ValueType* src, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				dest[i] = (dest[i] < src[i]) ? src[i] : dest[i];
+			}
+		});
+	}
+
+	// per-voxel min. CSG intersection when higher values are inside.
+	Volume3d& intersect(const Volume3d& rhs) {
+		return combine(rhs, [](ValueType* dest, const ValueType* src, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				dest[i] = (src[i] < dest[i]) ? src[i] : dest[i];
+			}
+		});
 	}
 
+	// moves values towards rhs by t: 0 keeps this, 1 copies rhs.
+	Volume3d& lerp(const Volume3d& rhs, const GeomType t) {
+		return combine(rhs, [t](ValueType* dest, const ValueType* src, const size_t count) {
+			for (size_t i = 0; i < count; ++i) {
+				dest[i] = static_cast<ValueType>(dest[i] + (src[i] - dest[i]) * t);
+			}
+		});
+	}
+
+	using GridSpaceBase<GeomType>::scale;
+
+	// multiplies every value by factor. the space is left as it is.
+	Volume3d& scale(const ValueType factor) {
+		const Index3d start = { 0, 0, 0 };
+		forEachRow(start, grid.getSizes(), [&](const unsigned int, const unsigned int, ValueType* values) {
+			for (size_t i = 0; i < grid.getSizeX(); ++i) {
+				values[i] *= factor;
+			}
+		});
+		return (*this);
+	}
+
+	// adds rhs voxel by voxel, matched by index rather than by position.
 	Volume3d& operator+=(const Volume3d& rhs) {
-		for (size_t x = 0; x < getSizeX(); ++x) {
-			for (size_t y = 0; y < getSizeY(); ++y) {
-				for (size_t z = 0; z < getSizeZ(); ++z) {
-					const auto v = rhs.grid.get(x, y, z);
-					grid.add( x,y,z,v);
-				}
+		const Index3d start = { 0, 0, 0 };
+		const Index3d end = {
+			std::min(grid.getSizes()[0], rhs.grid.getSizes()[0]),
+			std::min(grid.getSizes()[1], rhs.grid.getSizes()[1]),
+			std::min(grid.getSizes()[2], rhs.grid.getSizes()[2])
+		};
+		const size_t count = end[0];
+		forEachRow(start, end, [&](const unsigned int y, const unsigned int z, ValueType* values) {
+			const ValueType* src = rhs.grid.getRow(y, z);
+			for (size_t i = 0; i < count; ++i) {
+				values[i] += src[i];
 			}
-		}
+		});
 		return (*this);
 	}
 
 	void add(const size_t x, const size_t y, const size_t z, const ValueType v) {
-		const auto vv = grid.get(x, y, z) + v;
-		grid.set(x, y, z, vv);
-//		this->set(x, y, z, vv);
+		grid.add(x, y, z, v);
+		markDirty(x, y, z);
+		rangePyramid.widen(x, y, z, grid.get(x, y, z));
+	}
+
+	// adds v to the voxel holding each point (1 per point gives a point count grid) and returns how many points
+	// landed inside; the rest are ignored. Only the blocks holding added points are marked dirty.
+	size_t addPoints(const Vector3d<GeomType>* points, const size_t count, const ValueType v) {
+		size_t added = 0;
+		Index3d i;
+		for (size_t n = 0; n < count; ++n) {
+			if (!toVoxel(points[n], i)) {
+				continue;
+			}
+			add(i[0], i[1], i[2], v);
+			++added;
+		}
+		return added;
 	}
 
+	size_t addPoints(const Vector3dVector<GeomType>& points, const ValueType v) {
+		return addPoints(points.data(), points.size(), v);
+	}
+
+	// Writes mark the BlockSize^3 voxel block they land in, so meshers can re-extract only what changed.
+	static const unsigned int BlockSize = 8;
+
+	void markDirty(const size_t x, const size_t y, const size_t z) {
+		dirtyBlocks.set(x / BlockSize, y / BlockSize, z / BlockSize);
+	}
+
+	// marks the blocks covering voxels [start, end).
+	void markDirty(const Index3d& start, const Index3d& end) {
+		if (start[0] >= end[0] || start[1] >= end[1] || start[2] >= end[2]) {
+			return;
+		}
+		for (unsigned int z = start[2] / BlockSize; z <= (end[2] - 1) / BlockSize; ++z) {
+			for (unsigned int y = start[1] / BlockSize; y <= (end[1] - 1) / BlockSize; ++y) {
+				for (unsigned int x = start[0] / BlockSize; x <= (end[0] - 1) / BlockSize; ++x) {
+					dirtyBlocks.set(x, y, z);
+				}
+			}
+		}
+	}
+
+	void markAllDirty() {
+		dirtyBlocks.setAll();
+	}
+
+	void clearDirty() {
+		dirtyBlocks.setAll(false);
+	}
+
+	bool isDirty() const { return dirtyBlocks.isAny(); }
+
+	const Bitmap3d& getDirtyBlocks() const { return dirtyBlocks; }
+
+
+	// Optional min/max range of every BlockSize^3 block of cells. Single voxel writes widen the ranges, bulk writes
+	// recompute them; refreshRangePyramid() tightens them again after many point edits.
+	void enableRangePyramid() { rangePyramid.build(grid, BlockSize); }
+
+	void disableRangePyramid() { rangePyramid.clear(); }
+
+	bool hasRangePyramid() const { return !rangePyramid.isEmpty(); }
+
+	void refreshRangePyramid() {
+		if (hasRangePyramid()) {
+			rangePyramid.build(grid, BlockSize);
+		}
+	}
+
+	const MinMaxPyramid<ValueType>& getRangePyramid() const { return rangePyramid; }
+
+	// false only when the pyramid proves that no cell of block (bx, by, bz) crosses the threshold.
+	bool mayHaveBoundary(const unsigned int bx, const unsigned int by, const unsigned int bz, const ValueType threshold) const {
+		return !hasRangePyramid() || rangePyramid.isCrossing(0, bx, by, bz, threshold);
+	}
+
+
+	// Calls func(y, z, values) for every row of voxels [start, end), where values points at voxel (start[0], y, z).
+	// z slices run in parallel when the region is large, so func must only touch its own row. The region is
+	// marked dirty afterwards.
+	template<typename Func>
+	void forEachRow(const Index3d& start, const Index3d& end, const Func& func) {
+		if (start[0] >= end[0] || start[1] >= end[1] || start[2] >= end[2]) {
+			return;
+		}
+		const auto slice = [&](const size_t i) {
+			const unsigned int z = start[2] + static_cast<unsigned int>(i);
+			for (unsigned int y = start[1]; y < end[1]; ++y) {
+				func(y, z, grid.data() + grid.getIndex(start[0], y, z));
+			}
+		};
+		const size_t sliceCount = end[2] - start[2];
+		forEachSlice(sliceCount, static_cast<size_t>(end[0] - start[0]) * (end[1] - start[1]) * sliceCount, slice);
+		markChanged(start, end);
+	}
+
+	// Calls func(i, y, z, values) for every row of every box [starts[i], ends[i]), where values points at voxel
+	// (starts[i][0], y, z). Boxes may overlap; within a row they are visited in index order, so every voxel sees the
+	// same sequence of writes as one forEachRow() per box. Only rows inside some box are visited and only the boxes
+	// are marked dirty, not the space between them.
+	template<typename Func>
+	void forEachBoxRow(const std::vector<Index3d>& starts, const std::vector<Index3d>& ends, const Func& func) {
+		const auto isEmpty = [&](const size_t i) {
+			return starts[i][0] >= ends[i][0] || starts[i][1] >= ends[i][1] || starts[i][2] >= ends[i][2];
+		};
+		unsigned int startz = grid.getSizeZ();
+		unsigned int endz = 0;
+		size_t voxelCount = 0;
+		for (size_t i = 0; i < starts.size(); ++i) {
+			if (isEmpty(i)) {
+				continue;
+			}
+			startz = std::min(startz, starts[i][2]);
+			endz = std::max(endz, ends[i][2]);
+			voxelCount += static_cast<size_t>(ends[i][0] - starts[i][0]) * (ends[i][1] - starts[i][1]) * (ends[i][2] - starts[i][2]);
+		}
+		if (startz >= endz) {
+			return;
+		}
+		const auto slice = [&](const size_t n) {
+			const unsigned int z = startz + static_cast<unsigned int>(n);
+			std::vector<size_t> active;
+			unsigned int starty = grid.getSizeY();
+			unsigned int endy = 0;
+			for (size_t i = 0; i < starts.size(); ++i) {
+				if (!isEmpty(i) && starts[i][2] <= z && z < ends[i][2]) {
+					active.push_back(i);
+					starty = std::min(starty, starts[i][1]);
+					endy = std::max(endy, ends[i][1]);
+				}
+			}
+			for (unsigned int y = starty; y < endy; ++y) {
+				ValueType* row = grid.getRow(y, z);
+				for (const auto i : active) {
+					if (starts[i][1] <= y && y < ends[i][1]) {
+						func(i, y, z, row + starts[i][0]);
+					}
+				}
+			}
+		};
+		forEachSlice(endz - startz, voxelCount, slice);
+		for (size_t i = 0; i < starts.size(); ++i) {
+			if (!isEmpty(i)) {
+				markChanged(starts[i], ends[i]);
+			}
+		}
+	}
 
 	/*
 	Volume3d createAdd(const Volume3d<T>& rhs) const {
@@ -191,6 +464,169 @@ public:
 
 private:
 	Grid3d<ValueType> grid;
+	Bitmap3d dirtyBlocks;
+	MinMaxPyramid<ValueType> rangePyramid;
+
+	static const size_t ParallelThreshold = 32 * 32 * 32;
+
+	static size_t toBlockCount(const size_t size) { return (size + BlockSize - 1) / BlockSize; }
+
+	// z slices run in parallel once the work reaches ParallelThreshold voxels.
+	template<typename Func>
+	static void forEachSlice(const size_t sliceCount, const size_t voxelCount, const Func& slice) {
+		if (voxelCount >= ParallelThreshold) {
+			Util::parallelFor(sliceCount, slice);
+		}
+		else {
+			for (size_t i = 0; i < sliceCount; ++i) {
+				slice(i);
+			}
+		}
+	}
+
+	// after a bulk write of voxels [start, end).
+	void markChanged(const Index3d& start, const Index3d& end) {
+		markDirty(start, end);
+		rangePyramid.refresh(grid, { start[0], start[1], start[2] }, { end[0], end[1], end[2] });
+	}
+
+	// voxel range [start, end) of this volume inside rhs, and the index of its first voxel in rhs.
+	bool getOverlappedRange(const Volume3d& rhs, Index3d& start, Index3d& end, Index3d& rhsStart) const {
+		if (!getSpace().hasIntersection(rhs.getSpace())) {
+			return false;
+		}
+		const auto& s = getOverlappedSpace(rhs.getSpace());
+		const auto& unitLengths = getUnitLengths();
+		const auto& rhsUnitLengths = rhs.getUnitLengths();
+		const auto& res = getResolutions();
+		const auto& rhsRes = rhs.getResolutions();
+		const std::array<GeomType, 3> overlapStart = { s.getStart().getX(), s.getStart().getY(), s.getStart().getZ() };
+		const std::array<GeomType, 3> overlapLength = { s.getLengths().getX(), s.getLengths().getY(), s.getLengths().getZ() };
+		const std::array<GeomType, 3> origin = { getStart().getX(), getStart().getY(), getStart().getZ() };
+		const std::array<GeomType, 3> rhsOrigin = { rhs.getStart().getX(), rhs.getStart().getY(), rhs.getStart().getZ() };
+		const std::array<GeomType, 3> unit = { unitLengths.getX(), unitLengths.getY(), unitLengths.getZ() };
+		const std::array<GeomType, 3> rhsUnit = { rhsUnitLengths.getX(), rhsUnitLengths.getY(), rhsUnitLengths.getZ() };
+		for (int a = 0; a < 3; ++a) {
+			start[a] = std::min(toRounded((overlapStart[a] - origin[a]) / unit[a]), res[a]);
+			rhsStart[a] = std::min(toRounded((overlapStart[a] - rhsOrigin[a]) / rhsUnit[a]), rhsRes[a]);
+			const unsigned int count = std::min({ toRounded(overlapLength[a] / unit[a]), res[a] - start[a], rhsRes[a] - rhsStart[a] });
+			if (count == 0) {
+				return false;
+			}
+			end[a] = start[a] + count;
+		}
+		return true;
+	}
+
+	static const size_t SampleBatchSize = 4096;
+
+	template<typename Func>
+	static void forEachBatch(const size_t count, const Func& func) {
+		const size_t batchCount = (count + SampleBatchSize - 1) / SampleBatchSize;
+		Util::parallelFor(batchCount, [&](const size_t b) {
+			const size_t end = std::min(count, (b + 1) * SampleBatchSize);
+			for (size_t i = b * SampleBatchSize; i < end; ++i) {
+				func(i);
+			}
+		});
+	}
+
+	// cell origin i0 and fraction t of the continuous index u, clamped to [0, size - 1]. derivatives are zero outside.
+	static bool toCell(const GeomType u, const size_t size, size_t& i0, GeomType& t) {
+		const GeomType last = static_cast<GeomType>(size - 1);
+		const GeomType c = std::max(GeomType(0), std::min(u, last));
+		i0 = std::min(static_cast<size_t>(c), (size < 2) ? 0 : size - 2);
+		t = c - static_cast<GeomType>(i0);
+		return (u > 0) && (u < last);
+	}
+
+	// linear taps, weights and weight derivatives.
+	static void getTaps(const GeomType u, const size_t size, size_t (&taps)[2], GeomType (&weights)[2], GeomType (&derivatives)[2]) {
+		size_t i0;
+		GeomType t;
+		const GeomType d = toCell(u, size, i0, t) ? GeomType(1) : GeomType(0);
+		taps[0] = i0;
+		taps[1] = std::min(i0 + 1, size - 1);
+		weights[0] = 1 - t;
+		weights[1] = t;
+		derivatives[0] = -d;
+		derivatives[1] = d;
+	}
+
+	// Catmull-Rom taps, weights and weight derivatives.
+	static void getTaps(const GeomType u, const size_t size, size_t (&taps)[4], GeomType (&weights)[4], GeomType (&derivatives)[4]) {
+		size_t i0;
+		GeomType t;
+		const GeomType d = toCell(u, size, i0, t) ? GeomType(0.5) : GeomType(0);
+		taps[0] = (i0 == 0) ? 0 : i0 - 1;
+		taps[1] = i0;
+		taps[2] = std::min(i0 + 1, size - 1);
+		taps[3] = std::min(i0 + 2, size - 1);
+		const GeomType t2 = t * t;
+		const GeomType t3 = t2 * t;
+		weights[0] = GeomType(0.5) * (-t3 + 2 * t2 - t);
+		weights[1] = GeomType(0.5) * (3 * t3 - 5 * t2 + 2);
+		weights[2] = GeomType(0.5) * (-3 * t3 + 4 * t2 + t);
+		weights[3] = GeomType(0.5) * (t3 - t2);
+		derivatives[0] = d * (-3 * t2 + 4 * t - 1);
+		derivatives[1] = d * (9 * t2 - 10 * t);
+		derivatives[2] = d * (-9 * t2 + 8 * t + 1);
+		derivatives[3] = d * (3 * t2 - 2 * t);
+	}
+
+	template<int N>
+	GeomType interpolate(const Vector3d<GeomType>& p, Vector3d<GeomType>* gradient) const {
+		const auto& unitLengths = getUnitLengths();
+		const auto& start = getStart();
+		size_t tx[N], ty[N], tz[N];
+		GeomType wx[N], wy[N], wz[N];
+		GeomType dx[N], dy[N], dz[N];
+		getTaps((p.getX() - start.getX()) / unitLengths.getX() - GeomType(0.5), grid.getSizeX(), tx, wx, dx);
+		getTaps((p.getY() - start.getY()) / unitLengths.getY() - GeomType(0.5), grid.getSizeY(), ty, wy, dy);
+		getTaps((p.getZ() - start.getZ()) / unitLengths.getZ() - GeomType(0.5), grid.getSizeZ(), tz, wz, dz);
+
+		GeomType value = 0;
+		GeomType gx = 0;
+		GeomType gy = 0;
+		GeomType gz = 0;
+		for (int k = 0; k < N; ++k) {
+			for (int j = 0; j < N; ++j) {
+				const ValueType* row = grid.getRow(ty[j], tz[k]);
+				GeomType v = 0;
+				GeomType vdx = 0;
+				for (int i = 0; i < N; ++i) {
+					const GeomType r = static_cast<GeomType>(row[tx[i]]);
+					v += r * wx[i];
+					vdx += r * dx[i];
+				}
+				value += v * wy[j] * wz[k];
+				gx += vdx * wy[j] * wz[k];
+				gy += v * dy[j] * wz[k];
+				gz += v * wy[j] * dz[k];
+			}
+		}
+		if (gradient != nullptr) {
+			*gradient = Vector3d<GeomType>(gx / unitLengths.getX(), gy / unitLengths.getY(), gz / unitLengths.getZ());
+		}
+		return value;
+	}
+
+	static unsigned int toRounded(const GeomType v) { return (v < 0) ? 0 : static_cast<unsigned int>(v + GeomType(0.5)); }
+
+	template<typename Op>
+	Volume3d& combine(const Volume3d& rhs, const Op& op) {
+		Index3d start;
+		Index3d end;
+		Index3d rhsStart;
+		if (!getOverlappedRange(rhs, start, end, rhsStart)) {
+			return (*this);
+		}
+		const size_t count = end[0] - start[0];
+		forEachRow(start, end, [&](const unsigned int y, const unsigned int z, ValueType* values) {
+			op(values, rhs.grid.getRow(y - start[1] + rhsStart[1], z - start[2] + rhsStart[2]) + rhsStart[0], count);
+		});
+		return (*this);
+	}
 
 	Grid3d<ValueType> getOverlappedGrid(const Space3d<GeomType>& rhs) const {
 		const auto s = getSpace().getOverlapped(rhs);
@@ -209,4 +645,4 @@ using Volume3dSPtrList = std::list < Volume3dSPtr<GeomType, ValueType> >;
 	}
 }
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "../Math/Volume.h"
 
 #include <tuple>
+#include <algorithm>
 
 using namespace Crystal::Math;
 
@@ -52,7 +53,158 @@ TYPED_TEST(Volume3dTest, TestAdd)
 	using ValueType = std::tuple_element<1, TypeParam>::type;
 	Volume3d<GeomType, ValueType> lhs(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(2, 2, 2)), Grid3d<ValueType>(2, 2, 2));
 	Volume3d<GeomType, ValueType> rhs(Space3d<GeomType>(Vector3d<GeomType>(1, 1, 1), Vector3d<GeomType>(2, 2, 2)), Grid3d<ValueType>(2, 2, 2));
+	lhs.setValue(1);
+	rhs.setValue(2);
 	lhs.add(rhs);
+	EXPECT_EQ(3, lhs.getValue(1, 1, 1));
+	EXPECT_EQ(1, lhs.getValue(0, 1, 1));
+	EXPECT_EQ(1, lhs.getValue(1, 0, 1));
+	EXPECT_EQ(1, lhs.getValue(1, 1, 0));
+
+	lhs.sub(rhs);
+	EXPECT_EQ(1, lhs.getValue(1, 1, 1));
+}
+
+TYPED_TEST(Volume3dTest, TestCSG)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> lhs(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(4, 4, 4)), Grid3d<ValueType>(4, 4, 4));
+	Volume3d<GeomType, ValueType> rhs(Space3d<GeomType>(Vector3d<GeomType>(2, 0, 0), Vector3d<GeomType>(4, 4, 4)), Grid3d<ValueType>(4, 4, 4));
+	lhs.setValue(1);
+	rhs.setValue(3);
+	rhs.setValue(0, 0, 0, 0);
+	lhs.clearDirty();
+
+	lhs.unite(rhs);
+	EXPECT_EQ(1, lhs.getValue(1, 0, 0));
+	EXPECT_EQ(1, lhs.getValue(2, 0, 0));
+	EXPECT_EQ(3, lhs.getValue(3, 0, 0));
+	EXPECT_EQ(3, lhs.getValue(2, 3, 3));
+	EXPECT_TRUE(lhs.isDirty());
+
+	lhs.intersect(rhs);
+	EXPECT_EQ(0, lhs.getValue(2, 0, 0));
+	EXPECT_EQ(3, lhs.getValue(3, 0, 0));
+	EXPECT_EQ(1, lhs.getValue(1, 0, 0));
 }
 
-//TYPED_TEST(Volume3dTest, )
\ No newline at end of file
+TYPED_TEST(Volume3dTest, TestLerp)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> lhs(Space3d<GeomType>::Unit(), Grid3d<ValueType>(2, 2, 2));
+	Volume3d<GeomType, ValueType> rhs(Space3d<GeomType>::Unit(), Grid3d<ValueType>(2, 2, 2));
+	lhs.setValue(2);
+	rhs.setValue(4);
+	lhs.lerp(rhs, GeomType(0.5));
+	EXPECT_EQ(3, lhs.getValue(0, 0, 0));
+	EXPECT_EQ(3, lhs.getValue(1, 1, 1));
+}
+
+TYPED_TEST(Volume3dTest, TestScale)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>::Unit(), Grid3d<ValueType>(40, 40, 40));
+	volume.setValue(2);
+	volume.setValue(39, 39, 39, 3);
+	volume.scale(ValueType(2));
+	EXPECT_EQ(4, volume.getValue(0, 0, 0));
+	EXPECT_EQ(6, volume.getValue(39, 39, 39));
+
+	volume += volume;
+	EXPECT_EQ(8, volume.getValue(0, 0, 0));
+	EXPECT_EQ(12, volume.getValue(39, 39, 39));
+}
+
+//TYPED_TEST(Volume3dTest, )
+
+TYPED_TEST(Volume3dTest, TestDirtyBlocks)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>::Unit(), Grid3d<ValueType>(20, 20, 20));
+	EXPECT_EQ(27, volume.getDirtyBlocks().getCount());
+	volume.clearDirty();
+	EXPECT_FALSE(volume.isDirty());
+	volume.add(9, 0, 17, 1);
+	EXPECT_EQ(1, volume.getDirtyBlocks().getCount());
+	EXPECT_TRUE(volume.getDirtyBlocks().get(1, 0, 2));
+}
+
+TYPED_TEST(Volume3dTest, TestForEachBoundaryCell)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>::Unit(), Grid3d<ValueType>(4, 4, 4));
+	volume.setValue(1, 1, 1, 2);
+	size_t count = 0;
+	volume.forEachBoundaryCell(1, [&](const VolumeCell3d<GeomType, ValueType>& c) {
+		++count;
+		const auto& values = c.getValues();
+		EXPECT_EQ(1, std::count(values.begin(), values.end(), ValueType(2)));
+	});
+	EXPECT_EQ(8, count);
+	EXPECT_EQ(count, volume.toBoundaryCells(1).size());
+}
+
+TYPED_TEST(Volume3dTest, TestSample)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(8, 4, 4)), Grid3d<ValueType>(8, 4, 4));
+	for (unsigned int z = 0; z < 4; ++z) {
+		for (unsigned int y = 0; y < 4; ++y) {
+			for (unsigned int x = 0; x < 8; ++x) {
+				volume.setValue(x, y, z, static_cast<ValueType>(x * 2));
+			}
+		}
+	}
+	// voxel x sits at x + 0.5.
+	EXPECT_FLOAT_EQ(4, volume.sample(Vector3d<GeomType>(2.5, 2, 2)));
+	EXPECT_FLOAT_EQ(5, volume.sample(Vector3d<GeomType>(3, 2, 2)));
+	EXPECT_FLOAT_EQ(5, volume.sampleCubic(Vector3d<GeomType>(3, 2, 2)));
+	EXPECT_FLOAT_EQ(0, volume.sample(Vector3d<GeomType>(-1, 2, 2)));
+	EXPECT_FLOAT_EQ(14, volume.sample(Vector3d<GeomType>(10, 2, 2)));
+
+	const auto& g = volume.gradient(Vector3d<GeomType>(3, 2, 2));
+	EXPECT_FLOAT_EQ(2, g.getX());
+	EXPECT_FLOAT_EQ(0, g.getY());
+	EXPECT_FLOAT_EQ(0, g.getZ());
+	EXPECT_FLOAT_EQ(2, volume.gradientCubic(Vector3d<GeomType>(3.25, 2, 2)).getX());
+	EXPECT_FLOAT_EQ(0, volume.gradient(Vector3d<GeomType>(-1, 2, 2)).getX());
+}
+
+TYPED_TEST(Volume3dTest, TestSampleBatch)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(8, 4, 4)), Grid3d<ValueType>(8, 4, 4));
+	volume.setValue(3, 2, 2, 10);
+	Vector3dVector<GeomType> points;
+	for (int i = 0; i < 10000; ++i) {
+		points.push_back(Vector3d<GeomType>(GeomType(i % 80) * GeomType(0.1), 2.5, 2.5));
+	}
+	const auto& values = volume.sample(points);
+	const auto& gradients = volume.gradient(points);
+	ASSERT_EQ(points.size(), values.size());
+	ASSERT_EQ(points.size(), gradients.size());
+	for (size_t i = 0; i < points.size(); ++i) {
+		EXPECT_EQ(volume.sample(points[i]), values[i]);
+		EXPECT_EQ(volume.gradient(points[i]), gradients[i]);
+	}
+}
+
+TYPED_TEST(Volume3dTest, TestAddPoints)
+{
+	using GeomType = std::tuple_element<0, TypeParam>::type;
+	using ValueType = std::tuple_element<1, TypeParam>::type;
+	Volume3d<GeomType, ValueType> volume(Space3d<GeomType>(Vector3d<GeomType>(0, 0, 0), Vector3d<GeomType>(20, 20, 20)), Grid3d<ValueType>(20, 20, 20));
+	volume.clearDirty();
+	const Vector3dVector<GeomType> points = { Vector3d<GeomType>(0.5, 0.5, 0.5), Vector3d<GeomType>(0.2f, 0.7f, 0.1f), Vector3d<GeomType>(9.5, 0.5, 17.5), Vector3d<GeomType>(-1, 0, 0) };
+	EXPECT_EQ(3, volume.addPoints(points, 1));
+	EXPECT_EQ(2, volume.getValue(0, 0, 0));
+	EXPECT_EQ(1, volume.getValue(9, 0, 17));
+	EXPECT_EQ(2, volume.getDirtyBlocks().getCount());
+}
@@ -0,0 +1,60 @@
+#ifndef __CRYSTAL_UTIL_PARALLEL_H__
+#define __CRYSTAL_UTIL_PARALLEL_H__
+
+#include <thread>
+#include <atomic>
+#include <vector>
+#include <algorithm>
+
+namespace Crystal {
+	namespace Util {
+
+inline unsigned int getThreadCount() {
+	const unsigned int count = std::thread::hardware_concurrency();
+	return (count == 0) ? 1 : count;
+}
+
+// Calls func(i) for every i in [0, count) on a pool of worker threads. Work items are handed out one at a time,
+// so callers that write their results into slot i get the same output regardless of the thread count.
+// maxThreadCount caps the pool (0: one thread per core), e.g. to bound the memory held by in-flight items.
+template<typename Func>
+void parallelFor(const size_t count, const Func& func, const size_t maxThreadCount = 0) {
+	const size_t threadCount = std::min<size_t>((maxThreadCount == 0) ? getThreadCount() : maxThreadCount, count);
+	if (threadCount <= 1) {
+		for (size_t i = 0; i < count; ++i) {
+			func(i);
+		}
+		return;
+	}
+
+	std::atomic<size_t> next(0);
+	const auto worker = [&]() {
+		for (size_t i = next++; i < count; i = next++) {
+			func(i);
+		}
+	};
+
+	std::vector< std::thread > threads;
+	threads.reserve(threadCount - 1);
+	for (size_t i = 0; i + 1 < threadCount; ++i) {
+		threads.emplace_back(worker);
+	}
+	worker();
+	for (auto& t : threads) {
+		t.join();
+	}
+}
+
+// Calls func(first, last) for consecutive ranges of at most blockSize items covering [0, count), so cheap items are
+// handed out in blocks instead of one at a time.
+template<typename Func>
+void parallelForBlocks(const size_t count, const size_t blockSize, const Func& func, const size_t maxThreadCount = 0) {
+	parallelFor((count + blockSize - 1) / blockSize, [&](const size_t b) {
+		func(b * blockSize, std::min(count, (b + 1) * blockSize));
+	}, maxThreadCount);
+}
+
+	}
+}
+
+#endif